@@ -0,0 +1,160 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "API/ModelRoutingPolicy.h"
+
+#include "HAL/PlatformTime.h"
+
+namespace ModelRoutingPolicy
+{
+    // Number of recent latencies kept per endpoint
+    static constexpr int32 LatencyWindowSize = 64;
+
+    // Weight of the newest request in the error rate
+    static constexpr double ErrorRateSmoothing = 0.2;
+
+    // Latency routing only kicks in once an endpoint has a few samples
+    static constexpr int32 MinSamplesForRouting = 3;
+
+    // Statistics older than this are stale, so a downgraded model gets tried again eventually
+    static constexpr double StatsExpirySeconds = 300.0;
+}
+
+void FModelRoutingPolicy::RecordSuccess(EImageGenerationModel Model, double LatencySeconds)
+{
+    RecordLatency(Model, LatencySeconds);
+
+    FEndpointHistory& History = Histories.FindChecked(Model);
+    History.ErrorRate *= 1.0 - ModelRoutingPolicy::ErrorRateSmoothing;
+}
+
+void FModelRoutingPolicy::RecordFailure(EImageGenerationModel Model)
+{
+    FEndpointHistory& History = Histories.FindOrAdd(Model);
+    History.ErrorRate = History.ErrorRate * (1.0 - ModelRoutingPolicy::ErrorRateSmoothing) + ModelRoutingPolicy::ErrorRateSmoothing;
+    History.LastSampleTime = FPlatformTime::Seconds();
+}
+
+void FModelRoutingPolicy::RecordLatency(EImageGenerationModel Model, double LatencySeconds)
+{
+    FEndpointHistory& History = Histories.FindOrAdd(Model);
+
+    if (History.Latencies.Num() < ModelRoutingPolicy::LatencyWindowSize)
+    {
+        History.Latencies.Add(LatencySeconds);
+    }
+    else
+    {
+        History.Latencies[History.NextLatencyIndex] = LatencySeconds;
+        History.NextLatencyIndex = (History.NextLatencyIndex + 1) % ModelRoutingPolicy::LatencyWindowSize;
+    }
+
+    History.LastSampleTime = FPlatformTime::Seconds();
+}
+
+EImageGenerationModel FModelRoutingPolicy::SelectModel(EImageGenerationModel PreferredModel, double LatencyBudgetSeconds, double MaxErrorRate) const
+{
+    EImageGenerationModel Model = PreferredModel;
+    while (!IsExpectedToMeetTargets(Model, LatencyBudgetSeconds, MaxErrorRate))
+    {
+        const EImageGenerationModel FasterModel = GetFasterModel(Model);
+        if (FasterModel == Model)
+        {
+            // Nothing faster left, the fastest model is the best we can do
+            break;
+        }
+        Model = FasterModel;
+    }
+    return Model;
+}
+
+double FModelRoutingPolicy::GetLatencyPercentile(EImageGenerationModel Model, double Percentile) const
+{
+    const FEndpointHistory* History = Histories.Find(Model);
+    if (!History || History->Latencies.IsEmpty())
+    {
+        return 0.0;
+    }
+
+    TArray<double> Sorted = History->Latencies;
+    Sorted.Sort();
+
+    const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+    return Sorted[Index];
+}
+
+FModelEndpointStats FModelRoutingPolicy::GetStats(EImageGenerationModel Model) const
+{
+    FModelEndpointStats Stats;
+
+    if (const FEndpointHistory* History = Histories.Find(Model))
+    {
+        Stats.NumSamples = History->Latencies.Num();
+        Stats.ErrorRate = History->ErrorRate;
+
+        if (Stats.NumSamples > 0)
+        {
+            double TotalLatency = 0.0;
+            for (double Latency : History->Latencies)
+            {
+                TotalLatency += Latency;
+            }
+            Stats.AverageLatencySeconds = TotalLatency / Stats.NumSamples;
+            Stats.P90LatencySeconds = GetLatencyPercentile(Model, 0.9);
+        }
+    }
+
+    return Stats;
+}
+
+EImageGenerationModel FModelRoutingPolicy::GetFasterModel(EImageGenerationModel Model)
+{
+    switch (Model)
+    {
+    case EImageGenerationModel::StableImageUltra:
+    case EImageGenerationModel::StableDiffusion:
+        return EImageGenerationModel::StableImageCore;
+    default:
+        return Model;
+    }
+}
+
+EImageGenerationModel FModelRoutingPolicy::GetFastestModel(EImageGenerationModel Model)
+{
+    for (EImageGenerationModel FasterModel = GetFasterModel(Model); FasterModel != Model; FasterModel = GetFasterModel(Model))
+    {
+        Model = FasterModel;
+    }
+    return Model;
+}
+
+bool FModelRoutingPolicy::IsExpectedToMeetTargets(EImageGenerationModel Model, double LatencyBudgetSeconds, double MaxErrorRate) const
+{
+    const FEndpointHistory* History = FindFreshHistory(Model);
+    if (!History)
+    {
+        // Unknown endpoints get the benefit of the doubt, that is also how their statistics get refreshed
+        return true;
+    }
+
+    if (History->ErrorRate > MaxErrorRate)
+    {
+        return false;
+    }
+
+    if (LatencyBudgetSeconds > 0.0 && History->Latencies.Num() >= ModelRoutingPolicy::MinSamplesForRouting)
+    {
+        return GetLatencyPercentile(Model, 0.9) <= LatencyBudgetSeconds;
+    }
+
+    return true;
+}
+
+const FModelRoutingPolicy::FEndpointHistory* FModelRoutingPolicy::FindFreshHistory(EImageGenerationModel Model) const
+{
+    const FEndpointHistory* History = Histories.Find(Model);
+    if (History && FPlatformTime::Seconds() - History->LastSampleTime <= ModelRoutingPolicy::StatsExpirySeconds)
+    {
+        return History;
+    }
+    return nullptr;
+}
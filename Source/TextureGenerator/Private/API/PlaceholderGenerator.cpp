@@ -0,0 +1,395 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "API/PlaceholderGenerator.h"
+#include "Utils/PixelKernels.h"
+
+#include "Async/ParallelFor.h"
+#include "ImageUtils.h"
+
+namespace PlaceholderGenerator
+{
+    enum class EPattern : uint8
+    {
+        Noise,
+        Cells,
+        Bricks,
+        Tiles
+    };
+
+    struct FPatternKeywords
+    {
+        EPattern Pattern;
+        const TCHAR* Words[8];
+    };
+
+    // Prompts mentioning none of these get fractal noise
+    static const FPatternKeywords PatternKeywords[] =
+    {
+        { EPattern::Bricks, { TEXT("brick"), TEXT("brickwork"), TEXT("masonry") } },
+        { EPattern::Tiles, { TEXT("tile"), TEXT("tiled"), TEXT("checker"), TEXT("checkered"), TEXT("checkerboard"), TEXT("pavement"), TEXT("parquet") } },
+        { EPattern::Cells, { TEXT("stone"), TEXT("cobble"), TEXT("cobblestone"), TEXT("rock"), TEXT("rocky"), TEXT("gravel"), TEXT("pebble"), TEXT("scales") } }
+    };
+
+    struct FColorKeywords
+    {
+        FColor Color;
+        const TCHAR* Words[8];
+    };
+
+    // sRGB colors of common material words
+    static const FColorKeywords ColorKeywords[] =
+    {
+        { FColor(88, 110, 52), { TEXT("moss"), TEXT("mossy"), TEXT("grass"), TEXT("grassy"), TEXT("leaf"), TEXT("leaves"), TEXT("green") } },
+        { FColor(128, 126, 120), { TEXT("stone"), TEXT("stony"), TEXT("concrete"), TEXT("rock"), TEXT("rocky"), TEXT("gray"), TEXT("grey") } },
+        { FColor(120, 82, 50), { TEXT("wood"), TEXT("wooden"), TEXT("oak"), TEXT("plank"), TEXT("bark") } },
+        { FColor(150, 70, 50), { TEXT("brick"), TEXT("red"), TEXT("clay"), TEXT("terracotta") } },
+        { FColor(194, 170, 120), { TEXT("sand"), TEXT("sandy"), TEXT("desert"), TEXT("beige") } },
+        { FColor(95, 75, 55), { TEXT("dirt"), TEXT("mud"), TEXT("muddy"), TEXT("soil"), TEXT("earth") } },
+        { FColor(60, 100, 150), { TEXT("water"), TEXT("ice"), TEXT("icy"), TEXT("blue"), TEXT("ocean") } },
+        { FColor(160, 85, 40), { TEXT("rust"), TEXT("rusty"), TEXT("rusted"), TEXT("orange"), TEXT("copper") } },
+        { FColor(140, 145, 150), { TEXT("metal"), TEXT("metallic"), TEXT("steel"), TEXT("iron"), TEXT("chrome") } },
+        { FColor(225, 225, 220), { TEXT("snow"), TEXT("snowy"), TEXT("white"), TEXT("marble"), TEXT("plaster") } },
+        { FColor(40, 40, 42), { TEXT("dark"), TEXT("black"), TEXT("charcoal"), TEXT("asphalt") } },
+        { FColor(200, 160, 60), { TEXT("gold"), TEXT("golden"), TEXT("yellow") } }
+    };
+
+    // Lowercase words of a prompt, "Red-brick walls" gives red, brick and walls
+    static TArray<FString> SplitWords(const FString& Prompt)
+    {
+        TArray<FString> Words;
+        FString Word;
+        for (const TCHAR Character : Prompt)
+        {
+            if (FChar::IsAlnum(Character))
+            {
+                Word.AppendChar(FChar::ToLower(Character));
+            }
+            else if (!Word.IsEmpty())
+            {
+                Words.Add(MoveTemp(Word));
+                Word.Reset();
+            }
+        }
+        if (!Word.IsEmpty())
+        {
+            Words.Add(MoveTemp(Word));
+        }
+        return Words;
+    }
+
+    // Whole words only, so "tileable" is not a tile and "weathered" not red, plurals of the keyword match as well
+    static bool MatchesKeyword(const FString& Word, const TCHAR* Keyword)
+    {
+        if (!Word.StartsWith(Keyword, ESearchCase::CaseSensitive))
+        {
+            return false;
+        }
+
+        const FStringView Suffix = FStringView(Word).RightChop(FCString::Strlen(Keyword));
+        return Suffix.IsEmpty() || Suffix == TEXT("s") || Suffix == TEXT("es");
+    }
+
+    // Index of the first word matching one of the keywords, INDEX_NONE when none does
+    template <int32 NumKeywords>
+    static int32 FindKeyword(const TArray<FString>& Words, const TCHAR* const (&Keywords)[NumKeywords])
+    {
+        for (int32 WordIndex = 0; WordIndex < Words.Num(); ++WordIndex)
+        {
+            for (const TCHAR* Keyword : Keywords)
+            {
+                if (Keyword && MatchesKeyword(Words[WordIndex], Keyword))
+                {
+                    return WordIndex;
+                }
+            }
+        }
+        return INDEX_NONE;
+    }
+
+    static EPattern FindPattern(const TArray<FString>& Words)
+    {
+        for (const FPatternKeywords& Keywords : PatternKeywords)
+        {
+            if (FindKeyword(Words, Keywords.Words) != INDEX_NONE)
+            {
+                return Keywords.Pattern;
+            }
+        }
+        return EPattern::Noise;
+    }
+
+    // Adjectives come before the noun they describe, so the last color word gives the base and the one before it the accent
+    static void FindColors(const TArray<FString>& Words, FLinearColor& OutBase, FLinearColor& OutAccent)
+    {
+        TArray<TPair<int32, FColor>> Matches;
+        for (const FColorKeywords& Keywords : ColorKeywords)
+        {
+            const int32 WordIndex = FindKeyword(Words, Keywords.Words);
+            if (WordIndex != INDEX_NONE)
+            {
+                Matches.Emplace(WordIndex, Keywords.Color);
+            }
+        }
+        Matches.Sort([](const TPair<int32, FColor>& A, const TPair<int32, FColor>& B) { return A.Key < B.Key; });
+
+        OutBase = FLinearColor::FromSRGBColor(Matches.Num() > 0 ? Matches.Last().Value : FColor(128, 126, 120));
+        OutAccent = Matches.Num() > 1 ? FLinearColor::FromSRGBColor(Matches.Last(1).Value) : OutBase * 0.45f;
+    }
+
+    FORCEINLINE uint32 Hash(uint32 X, uint32 Y, uint32 Seed)
+    {
+        uint32 Value = (X * 0x8da6b343u) ^ (Y * 0xd8163841u) ^ (Seed * 0xcb1ab31fu);
+        Value ^= Value >> 16;
+        Value *= 0x7feb352du;
+        Value ^= Value >> 15;
+        Value *= 0x846ca68bu;
+        Value ^= Value >> 16;
+        return Value;
+    }
+
+    FORCEINLINE float HashToUnit(uint32 Value)
+    {
+        return (Value >> 8) * (1.0f / 16777216.0f);
+    }
+
+    FORCEINLINE int32 Wrap(int32 Value, int32 Period)
+    {
+        const int32 Remainder = Value % Period;
+        return Remainder < 0 ? Remainder + Period : Remainder;
+    }
+
+    // Feature point of every cell of a Worley grid repeating every Period cells, looked up rather than hashed for each pixel
+    struct FCellGrid
+    {
+        struct FFeature
+        {
+            float OffsetX;
+            float OffsetY;
+            uint32 Hash;
+        };
+
+        int32 Period = 0;
+        TArray<FFeature> Features;
+
+        void Init(int32 InPeriod, uint32 Seed)
+        {
+            Period = InPeriod;
+            Features.SetNumUninitialized(Period * Period);
+            for (int32 Y = 0; Y < Period; ++Y)
+            {
+                for (int32 X = 0; X < Period; ++X)
+                {
+                    FFeature& Feature = Features[Y * Period + X];
+                    Feature.Hash = PlaceholderGenerator::Hash(X, Y, Seed);
+                    Feature.OffsetX = 0.1f + 0.8f * HashToUnit(Feature.Hash);
+                    Feature.OffsetY = 0.1f + 0.8f * HashToUnit(PlaceholderGenerator::Hash(Feature.Hash, 0x68e31da4u, Seed));
+                }
+            }
+        }
+
+        const FFeature& GetFeature(int32 X, int32 Y) const
+        {
+            return Features[Wrap(Y, Period) * Period + Wrap(X, Period)];
+        }
+    };
+
+    // Worley noise with one feature point per cell of the grid
+    static void CellDistances(float X, float Y, const FCellGrid& Grid, float& OutNearest, float& OutSecondNearest, uint32& OutCellHash)
+    {
+        const int32 CellX = FMath::FloorToInt32(X);
+        const int32 CellY = FMath::FloorToInt32(Y);
+
+        // The second nearest point may be two cells away
+        float Nearest = MAX_flt;
+        float SecondNearest = MAX_flt;
+        for (int32 OffsetY = -2; OffsetY <= 2; ++OffsetY)
+        {
+            for (int32 OffsetX = -2; OffsetX <= 2; ++OffsetX)
+            {
+                const int32 NeighbourX = CellX + OffsetX;
+                const int32 NeighbourY = CellY + OffsetY;
+                const FCellGrid::FFeature& Feature = Grid.GetFeature(NeighbourX, NeighbourY);
+
+                const float PointX = NeighbourX + Feature.OffsetX;
+                const float PointY = NeighbourY + Feature.OffsetY;
+                const float Distance = FMath::Sqrt(FMath::Square(PointX - X) + FMath::Square(PointY - Y));
+                if (Distance < Nearest)
+                {
+                    SecondNearest = Nearest;
+                    Nearest = Distance;
+                    OutCellHash = Feature.Hash;
+                }
+                else if (Distance < SecondNearest)
+                {
+                    SecondNearest = Distance;
+                }
+            }
+        }
+
+        OutNearest = Nearest;
+        OutSecondNearest = SecondNearest;
+    }
+
+    // 1 inside a cell of a grid, falling to 0 over the joint of the given half width at its borders
+    FORCEINLINE float GridMask(float X, float Y, float JointX, float JointY)
+    {
+        const float FX = X - FMath::FloorToFloat(X);
+        const float FY = Y - FMath::FloorToFloat(Y);
+        const float EdgeX = FMath::Min(FX, 1.0f - FX);
+        const float EdgeY = FMath::Min(FY, 1.0f - FY);
+        return FMath::Min(FMath::SmoothStep(JointX * 0.5f, JointX, EdgeX), FMath::SmoothStep(JointY * 0.5f, JointY, EdgeY));
+    }
+
+    struct FShader
+    {
+        EPattern Pattern = EPattern::Noise;
+        FLinearColor Base;
+        FLinearColor Accent;
+        FLinearColor Joint;
+        uint32 Seed = 0;
+        FCellGrid Cells;
+
+        // Linear color at a position of the unit square, given the fractal noise of the pixel computed a row at a time
+        FLinearColor Shade(float U, float V, float GritNoise, float PatternNoise) const
+        {
+            const float Grit = 0.8f + 0.4f * GritNoise;
+
+            switch (Pattern)
+            {
+            case EPattern::Cells:
+            {
+                float Nearest = 0.0f;
+                float SecondNearest = 0.0f;
+                uint32 CellHash = 0;
+                CellDistances(U * Cells.Period, V * Cells.Period, Cells, Nearest, SecondNearest, CellHash);
+
+                const FLinearColor Stone = FLinearColor::LerpUsingHSV(Base, Accent, 0.6f * HashToUnit(CellHash)) * Grit;
+                return FMath::Lerp(Joint * Grit, Stone, FMath::SmoothStep(0.03f, 0.1f, SecondNearest - Nearest));
+            }
+            case EPattern::Bricks:
+            {
+                // Running bond of 2:1 bricks, every other row shifted by half a brick
+                static constexpr int32 NumRows = 16;
+                static constexpr int32 NumColumns = 8;
+                const int32 Row = FMath::Min(FMath::FloorToInt32(V * NumRows), NumRows - 1);
+                const float X = U * NumColumns + ((Row & 1) ? 0.5f : 0.0f);
+                const int32 Column = Wrap(FMath::FloorToInt32(X), NumColumns);
+
+                const FLinearColor Brick = FLinearColor::LerpUsingHSV(Base, Accent, 0.5f * HashToUnit(Hash(Column, Row, Seed))) * Grit;
+                return FMath::Lerp(Joint * Grit, Brick, GridMask(X, V * NumRows, 0.04f, 0.08f));
+            }
+            case EPattern::Tiles:
+            {
+                static constexpr int32 NumTiles = 8;
+                const int32 Column = FMath::Min(FMath::FloorToInt32(U * NumTiles), NumTiles - 1);
+                const int32 Row = FMath::Min(FMath::FloorToInt32(V * NumTiles), NumTiles - 1);
+
+                const FLinearColor Tile = FLinearColor::LerpUsingHSV(Base, Accent, 0.3f * HashToUnit(Hash(Column, Row, Seed))) * (0.9f + 0.1f * Grit);
+                return FMath::Lerp(Joint, Tile, GridMask(U * NumTiles, V * NumTiles, 0.03f, 0.03f));
+            }
+            default:
+            {
+                return FMath::Lerp(Accent, Base, FMath::SmoothStep(0.3f, 0.7f, PatternNoise)) * Grit;
+            }
+            }
+        }
+    };
+
+    static bool EncodeImage(const FImage& Image, TArray<uint8>& OutImageData)
+    {
+        TArray64<uint8> ImageData;
+        if (!FImageUtils::CompressImage(ImageData, TEXT("png"), Image))
+        {
+            return false;
+        }
+
+        OutImageData = TArray<uint8>(ImageData);
+        return true;
+    }
+}
+
+void FPlaceholderGenerator::Generate(const FString& Prompt, int32 Seed, int32 Size, FImage& OutImage)
+{
+    using namespace PlaceholderGenerator;
+
+    const FString Keywords = Prompt.ToLower();
+
+    FShader Shader;
+    const TArray<FString> Words = SplitWords(Keywords);
+    Shader.Pattern = FindPattern(Words);
+    Shader.Seed = Seed != 0 ? static_cast<uint32>(Seed) : GetTypeHash(Keywords);
+    FindColors(Words, Shader.Base, Shader.Accent);
+    Shader.Joint = FLinearColor::FromSRGBColor(FColor(110, 108, 102)) * (Shader.Pattern == EPattern::Tiles ? 0.6f : 1.0f);
+    if (Shader.Pattern == EPattern::Cells)
+    {
+        Shader.Cells.Init(8, Shader.Seed);
+    }
+
+    Size = FMath::Max(1, Size);
+    OutImage.Init(Size, Size, ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+
+    // The fractal noise of a row, most of the shading work, comes from the vector kernels. The rows are then shaded
+    // as linear floats, and encoded and swizzled to BGRA8 with the vector kernels as well.
+    ParallelFor(Size, [&Shader, &OutImage, Size](int32 Y)
+    {
+        TArray<float> GritNoise;
+        GritNoise.SetNumUninitialized(Size);
+        FPixelKernels::FractalNoiseRow(Y, Size, 32, 3, Shader.Seed + 101, GritNoise.GetData());
+
+        TArray<float> PatternNoise;
+        PatternNoise.SetNumZeroed(Size);
+        if (Shader.Pattern == EPattern::Noise)
+        {
+            FPixelKernels::FractalNoiseRow(Y, Size, 4, 6, Shader.Seed, PatternNoise.GetData());
+        }
+
+        TArray<FLinearColor> Row;
+        Row.SetNumUninitialized(Size);
+
+        const float InvSize = 1.0f / Size;
+        const float V = (Y + 0.5f) * InvSize;
+        for (int32 X = 0; X < Size; ++X)
+        {
+            Row[X] = Shader.Shade((X + 0.5f) * InvSize, V, GritNoise[X], PatternNoise[X]);
+            Row[X].A = 1.0f;
+        }
+
+        uint8* Pixels = OutImage.RawData.GetData() + static_cast<int64>(Y) * Size * 4;
+        FPixelKernels::LinearToSRGB(reinterpret_cast<const float*>(Row.GetData()), Pixels, Size);
+        FPixelKernels::SwizzleRedBlue(Pixels, Pixels, Size);
+    });
+}
+
+bool FPlaceholderGenerator::GenerateImageData(const FString& Prompt, int32 Seed, TArray<uint8>& OutImageData)
+{
+    FImage Image;
+    Generate(Prompt, Seed, DefaultSize, Image);
+    return PlaceholderGenerator::EncodeImage(Image, OutImageData);
+}
+
+bool FPlaceholderGenerator::GenerateImageData(const FString& Prompt, int32 Seed, const TArray<uint8>& ReferenceImageData, float Strength, TArray<uint8>& OutImageData)
+{
+    FImage Reference;
+    if (!FImageUtils::DecompressImage(ReferenceImageData.GetData(), ReferenceImageData.Num(), Reference))
+    {
+        return false;
+    }
+    Reference.ChangeFormat(ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+
+    FImage Image;
+    Generate(Prompt, Seed, FMath::Max(Reference.SizeX, Reference.SizeY), Image);
+
+    // Fixed point blend of the encoded values, the placeholder covers the reference by the strength
+    const uint32 Weight = static_cast<uint32>(FMath::RoundToInt32(FMath::Clamp(Strength, 0.0f, 1.0f) * 256.0f));
+    ParallelFor(Reference.SizeY, [&Reference, &Image, Weight](int32 Y)
+    {
+        uint8* Dst = Reference.RawData.GetData() + static_cast<int64>(Y) * Reference.SizeX * 4;
+        const uint8* Src = Image.RawData.GetData() + static_cast<int64>(Y) * Image.SizeX * 4;
+        for (int32 Index = 0; Index < Reference.SizeX * 4; ++Index)
+        {
+            Dst[Index] = static_cast<uint8>((Dst[Index] * (256 - Weight) + Src[Index] * Weight + 128) >> 8);
+        }
+    });
+
+    return PlaceholderGenerator::EncodeImage(Reference, OutImageData);
+}
@@ -0,0 +1,116 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "API/ReferenceImageFile.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+
+namespace ReferenceImageFile
+{
+    static const TCHAR* PngMimeType = TEXT("image/png");
+    static const TCHAR* JpegMimeType = TEXT("image/jpeg");
+    static const TCHAR* WebpMimeType = TEXT("image/webp");
+
+    // Enough for every signature checked below
+    static constexpr int32 HeaderSize = 16;
+}
+
+FReferenceImageFile::~FReferenceImageFile()
+{
+    // The region has to be unmapped before its file is closed
+    Region.Reset();
+    Handle.Reset();
+}
+
+TSharedPtr<const FReferenceImageFile> FReferenceImageFile::Open(const FString& Filename, FString& OutError)
+{
+    using namespace ReferenceImageFile;
+
+    const FString FullPath = GetFullPath(Filename);
+
+    TUniquePtr<IMappedFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FullPath));
+    if (!Handle.IsValid())
+    {
+        OutError = FString::Printf(TEXT("Failed to open the reference image %s."), *FullPath);
+        return nullptr;
+    }
+
+    if (Handle->GetFileSize() < HeaderSize)
+    {
+        OutError = FString::Printf(TEXT("The reference image %s is too small to be an image."), *FullPath);
+        return nullptr;
+    }
+    if (Handle->GetFileSize() > MAX_int32)
+    {
+        OutError = FString::Printf(TEXT("The reference image %s is too large to upload."), *FullPath);
+        return nullptr;
+    }
+
+    TUniquePtr<IMappedFileRegion> Region(Handle->MapRegion(0, Handle->GetFileSize()));
+    if (!Region.IsValid())
+    {
+        OutError = FString::Printf(TEXT("Failed to map the reference image %s."), *FullPath);
+        return nullptr;
+    }
+
+    // Only the header pages are touched here, the rest is read while the request body is built
+    const TCHAR* MimeType = DetectMimeType(TArrayView<const uint8>(Region->GetMappedPtr(), HeaderSize));
+    if (!MimeType)
+    {
+        OutError = FString::Printf(TEXT("The reference image %s is not a PNG, JPEG or WebP file."), *FullPath);
+        return nullptr;
+    }
+
+    TSharedPtr<FReferenceImageFile> File = MakeShareable(new FReferenceImageFile());
+    File->Handle = MoveTemp(Handle);
+    File->Region = MoveTemp(Region);
+    File->MimeType = MimeType;
+    return File;
+}
+
+const TCHAR* FReferenceImageFile::DetectMimeType(TArrayView<const uint8> Header)
+{
+    using namespace ReferenceImageFile;
+
+    static const uint8 PngSignature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (Header.Num() >= 16 && FMemory::Memcmp(Header.GetData(), PngSignature, sizeof(PngSignature)) == 0
+        && FMemory::Memcmp(Header.GetData() + 12, "IHDR", 4) == 0)
+    {
+        return PngMimeType;
+    }
+
+    // Start of image followed by the first marker
+    if (Header.Num() >= 3 && Header[0] == 0xFF && Header[1] == 0xD8 && Header[2] == 0xFF)
+    {
+        return JpegMimeType;
+    }
+
+    if (Header.Num() >= 12 && FMemory::Memcmp(Header.GetData(), "RIFF", 4) == 0 && FMemory::Memcmp(Header.GetData() + 8, "WEBP", 4) == 0)
+    {
+        return WebpMimeType;
+    }
+
+    return nullptr;
+}
+
+FString FReferenceImageFile::GetFullPath(const FString& Filename)
+{
+    return FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), Filename);
+}
+
+TArrayView<const uint8> FReferenceImageFile::GetData() const
+{
+    return TArrayView<const uint8>(Region->GetMappedPtr(), static_cast<int32>(Region->GetMappedSize()));
+}
+
+const TCHAR* FReferenceImageFile::GetExtension() const
+{
+    using namespace ReferenceImageFile;
+
+    if (MimeType == JpegMimeType)
+    {
+        return TEXT("jpg");
+    }
+    return MimeType == WebpMimeType ? TEXT("webp") : TEXT("png");
+}
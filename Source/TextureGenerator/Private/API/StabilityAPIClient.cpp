@@ -1,17 +1,57 @@
 // Copyright Mateusz Wojt. All Rights Reserved.
 
 #include "API/StabilityAPIClient.h"
+#include "API/ReferenceImageFile.h"
+#include "HAL/PlatformTime.h"
 #include "Misc/Base64.h"
+#include "Misc/EngineVersionComparison.h"
 #include "Misc/FileHelper.h"
+#include "Misc/SecureHash.h"
 #include "Engine/Texture2D.h"
 #include "Utils/TextureUtils.h"
 #include "TextureGeneratorModule.h"
 
+TMap<FString, TSharedPtr<FStabilityAPIClient::FSharedRequest>> FStabilityAPIClient::CoalescableRequests;
+int32 FStabilityAPIClient::NumActiveHttpRequests = 0;
+
+FString FStabilityGenerationParams::GetCoalescingKey() const
+{
+    // Without an explicit seed, identical requests are expected to produce different images
+    if (!bAllowCoalescing || Seed <= 0)
+    {
+        return FString();
+    }
+
+    FSHA1 Hash;
+    auto UpdateString = [&Hash](const FString& Str)
+    {
+        FTCHARToUTF8 UTF8String(*Str);
+        Hash.Update(reinterpret_cast<const uint8*>(UTF8String.Get()), UTF8String.Length());
+        // Separator, so that adjacent fields cannot blend into each other
+        const uint8 Separator = 0;
+        Hash.Update(&Separator, 1);
+    };
+
+    const TArrayView<const uint8> Reference = GetReferenceImage();
+    UpdateString(FString::Printf(TEXT("%d|%d|%.1f"), static_cast<int32>(Model), Seed, Reference.IsEmpty() ? 0.0f : FMath::Clamp(Strength, 0.0f, 1.0f)));
+    UpdateString(Prompt);
+    UpdateString(NegativePrompt);
+    UpdateString(StylePreset);
+    Hash.Update(Reference.GetData(), Reference.Num());
+    Hash.Update(MaskImage.GetData(), MaskImage.Num());
+    Hash.Final();
+
+    uint8 Digest[FSHA1::DigestSize];
+    Hash.GetHash(Digest);
+    return BytesToHex(Digest, FSHA1::DigestSize);
+}
+
+TArrayView<const uint8> FStabilityGenerationParams::GetReferenceImage() const
+{
+    return ReferenceImageFile.IsValid() ? ReferenceImageFile->GetData() : TArrayView<const uint8>(ReferenceImage);
+}
+
 FStabilityAPIClient::FStabilityAPIClient()
-    : CurrentModel(EImageGenerationModel::StableImageCore)
-    , ReferenceTexture(nullptr)
-    , CurrentSeed(-1)
-    , CurrentStrength(0)
 {
 }
 
@@ -33,82 +73,204 @@ void FStabilityAPIClient::GenerateImage(
     EImageGenerationModel InModel,
     int32 InSeed,
     const FString& InStylePreset)
+{
+    FStabilityGenerationParams Params;
+    Params.Prompt = InPrompt;
+    Params.NegativePrompt = InNegativePrompt;
+    Params.Strength = InStrength;
+    Params.Model = InModel;
+    Params.Seed = InSeed;
+    Params.StylePreset = InStylePreset;
+
+    // Convert texture to raw image data
+    if (IsValid(InReferenceTexture))
+    {
+        Params.ReferenceImage = FTextureUtils::GetTextureImageData(InReferenceTexture);
+    }
+
+    GenerateImage(Params);
+}
+
+void FStabilityAPIClient::GenerateImage(const FStabilityGenerationParams& Params)
 {
     // Cancel any existing request
     CancelRequest();
 
     // Store parameters
-    CurrentPrompt = InPrompt;
-    CurrentNegativePrompt = InNegativePrompt;
-    ReferenceTexture = InReferenceTexture;
-    CurrentStrength = InStrength;
-    CurrentModel = InModel;
-    CurrentSeed = InSeed;
-    CurrentStylePreset = InStylePreset;
+    CurrentParams = Params;
 
-    // Convert texture to raw image data
-    if (IsValid(ReferenceTexture))
+    // Join an identical request which is already in flight, instead of paying for the same image twice
+    const FString CoalescingKey = CurrentParams.GetCoalescingKey();
+    if (TSharedPtr<FSharedRequest>* ExistingRequest = CoalescableRequests.Find(CoalescingKey))
     {
-        CurrentReferenceImage = FTextureUtils::GetTextureImageData(ReferenceTexture);
-    }
-    else
-    {
-        // Clean-up any existing handle to the image, so no leftovers are used when sending API queries
-        CurrentReferenceImage.Empty();
+        UE_LOG(LogTextureGenerator, Verbose, TEXT("Joining identical generation request already in flight."));
+        CurrentRequest = *ExistingRequest;
+        CurrentRequest->Subscribers.Add(this);
+        return;
     }
 
     // Create the HTTP request
-    CurrentRequest = FHttpModule::Get().CreateRequest();
-    if (!CurrentRequest.IsValid())
+    FHttpRequestPtr HttpRequest = FHttpModule::Get().CreateRequest();
+    if (!HttpRequest.IsValid())
     {
         OnError.ExecuteIfBound(TEXT("Failed to create HTTP request"));
         return;
     }
 
-    // Set up the request URL with API key
-    FString Url = GetModelEndpoint(CurrentModel);
-    CurrentRequest->SetURL(Url);
-    CurrentRequest->SetVerb(TEXT("POST"));
+    // Set up the request URL with API key, masked edits go to the inpaint endpoint whatever the model
+    FString Url = CurrentParams.MaskImage.IsEmpty() ? GetModelEndpoint(CurrentParams.Model) : GetInpaintEndpoint();
+    HttpRequest->SetURL(Url);
+    HttpRequest->SetVerb(TEXT("POST"));
 
     // Set authorization header with Bearer token
-    CurrentRequest->SetHeader(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *APIKey));
+    HttpRequest->SetHeader(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *APIKey));
 
     // IMPORTANT: Request binary image response, NOT JSON
-    CurrentRequest->SetHeader(TEXT("Accept"), TEXT("image/*"));
+    HttpRequest->SetHeader(TEXT("Accept"), TEXT("image/*"));
 
     // Build multipart form data
     const FString Boundary = FString::Printf(TEXT("----formdata-unreal-%d"), FMath::Rand());
-    CurrentRequest->SetHeader(TEXT("Content-Type"), FString::Printf(TEXT("multipart/form-data; boundary=%s"), *Boundary));
+    HttpRequest->SetHeader(TEXT("Content-Type"), FString::Printf(TEXT("multipart/form-data; boundary=%s"), *Boundary));
 
     // Build the multipart body
-    TArray<uint8> RequestBody = BuildMultipartFormData(Boundary);
-    CurrentRequest->SetContent(RequestBody);
+    HttpRequest->SetContent(BuildMultipartFormData(CurrentParams, Boundary));
+
+    TSharedPtr<FSharedRequest> SharedRequest = MakeShared<FSharedRequest>();
+    SharedRequest->HttpRequest = HttpRequest;
+    SharedRequest->RequestId = FGuid::NewGuid();
+    SharedRequest->CoalescingKey = CoalescingKey;
+    SharedRequest->Subscribers.Add(this);
+    SharedRequest->Timings.BytesSent = HttpRequest->GetContentLength();
+    CurrentRequest = SharedRequest;
+
+    if (!CoalescingKey.IsEmpty())
+    {
+        CoalescableRequests.Add(CoalescingKey, SharedRequest);
+    }
         
-    // Bind the response callback
-    CurrentRequest->OnProcessRequestComplete().BindRaw(this, &FStabilityAPIClient::OnResponseReceived);
+    // Bind the response callback, the shared request is kept alive by its subscribers only
+    HttpRequest->OnProcessRequestComplete().BindStatic(&FStabilityAPIClient::OnSharedRequestComplete, TWeakPtr<FSharedRequest>(SharedRequest));
+
+    TWeakPtr<FSharedRequest> WeakSharedRequest(SharedRequest);
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+    HttpRequest->OnRequestProgress().BindLambda([WeakSharedRequest](FHttpRequestPtr, int32 BytesSent, int32 BytesReceived)
+#else
+    HttpRequest->OnRequestProgress64().BindLambda([WeakSharedRequest](FHttpRequestPtr, uint64 BytesSent, uint64 BytesReceived)
+#endif
+    {
+        OnSharedRequestProgress(WeakSharedRequest, BytesSent, BytesReceived);
+    });
         
     // Send the request
-    if (!CurrentRequest->ProcessRequest())
+    ++NumActiveHttpRequests;
+    SharedRequest->Timings.SendTime = FPlatformTime::Seconds();
+    if (!HttpRequest->ProcessRequest() && !SharedRequest->bCompleted)
     {
-        OnError.ExecuteIfBound(TEXT("Failed to process HTTP request"));
+        --NumActiveHttpRequests;
+        CoalescableRequests.Remove(CoalescingKey);
+        HttpRequest->OnProcessRequestComplete().Unbind();
         CurrentRequest.Reset();
+        OnError.ExecuteIfBound(TEXT("Failed to process HTTP request"));
     }
 }
 
 void FStabilityAPIClient::CancelRequest()
 {
-    if (CurrentRequest.IsValid() && CurrentRequest->GetStatus() == EHttpRequestStatus::Processing)
+    if (!CurrentRequest.IsValid())
     {
-        CurrentRequest->CancelRequest();
+        return;
+    }
+
+    TSharedPtr<FSharedRequest> SharedRequest = MoveTemp(CurrentRequest);
+    SharedRequest->Subscribers.Remove(this);
+
+    // Only abort the HTTP request once nobody is waiting for its result anymore
+    if (SharedRequest->Subscribers.IsEmpty())
+    {
+        if (!SharedRequest->CoalescingKey.IsEmpty())
+        {
+            CoalescableRequests.Remove(SharedRequest->CoalescingKey);
+        }
+
+        if (SharedRequest->HttpRequest->GetStatus() == EHttpRequestStatus::Processing)
+        {
+            SharedRequest->HttpRequest->CancelRequest();
+        }
     }
-    CurrentRequest.Reset();
 }
 
-void FStabilityAPIClient::OnResponseReceived(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+int32 FStabilityAPIClient::GetNumActiveHttpRequests()
+{
+    return NumActiveHttpRequests;
+}
+
+void FStabilityAPIClient::OnSharedRequestComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, TWeakPtr<FSharedRequest> WeakSharedRequest)
+{
+    --NumActiveHttpRequests;
+
+    TSharedPtr<FSharedRequest> SharedRequest = WeakSharedRequest.Pin();
+    if (!SharedRequest.IsValid())
+    {
+        // Every subscriber cancelled
+        return;
+    }
+    SharedRequest->bCompleted = true;
+
+    // Without progress reports the phases cannot be told apart, the whole request counts as server time
+    FStabilityRequestTimings& Timings = SharedRequest->Timings;
+    Timings.CompletedTime = FPlatformTime::Seconds();
+    Timings.UploadedTime = Timings.UploadedTime > 0.0 ? Timings.UploadedTime : Timings.SendTime;
+    Timings.FirstByteTime = Timings.FirstByteTime > 0.0 ? Timings.FirstByteTime : Timings.CompletedTime;
+    Timings.BytesReceived = Response.IsValid() ? Response->GetContent().Num() : 0;
+
+    // No later request may join once the response arrived
+    if (!SharedRequest->CoalescingKey.IsEmpty())
+    {
+        const TSharedPtr<FSharedRequest>* RegisteredRequest = CoalescableRequests.Find(SharedRequest->CoalescingKey);
+        if (RegisteredRequest && *RegisteredRequest == SharedRequest)
+        {
+            CoalescableRequests.Remove(SharedRequest->CoalescingKey);
+        }
+    }
+
+    // Detach every subscriber first, callbacks are free to start new requests on their client
+    const TArray<FStabilityAPIClient*> Subscribers = MoveTemp(SharedRequest->Subscribers);
+    for (FStabilityAPIClient* Subscriber : Subscribers)
+    {
+        Subscriber->CurrentRequest.Reset();
+        Subscriber->RequestTimings = Timings;
+        Subscriber->ResponseId = SharedRequest->RequestId;
+    }
+
+    // All subscribers receive the very same response buffer
+    for (FStabilityAPIClient* Subscriber : Subscribers)
+    {
+        Subscriber->OnResponseReceived(Response, bWasSuccessful);
+    }
+}
+
+void FStabilityAPIClient::OnSharedRequestProgress(TWeakPtr<FSharedRequest> WeakSharedRequest, uint64 BytesSent, uint64 BytesReceived)
+{
+    TSharedPtr<FSharedRequest> SharedRequest = WeakSharedRequest.Pin();
+    if (!SharedRequest.IsValid())
+    {
+        return;
+    }
+
+    FStabilityRequestTimings& Timings = SharedRequest->Timings;
+    const double Now = FPlatformTime::Seconds();
+    if (Timings.UploadedTime == 0.0 && (BytesSent >= static_cast<uint64>(Timings.BytesSent) || BytesReceived > 0))
+    {
+        Timings.UploadedTime = Now;
+    }
+    if (Timings.FirstByteTime == 0.0 && BytesReceived > 0)
+    {
+        Timings.FirstByteTime = Now;
+    }
+}
+
+void FStabilityAPIClient::OnResponseReceived(FHttpResponsePtr Response, bool bWasSuccessful)
 {
-    // Clear the current request
-    CurrentRequest.Reset();
-        
     // Check if the request was successful
     if (!bWasSuccessful || !Response.IsValid())
     {
@@ -151,11 +313,60 @@ void FStabilityAPIClient::ProcessStabilityResponse(const FHttpResponsePtr& Respo
         return;
     }
     
+    // Requests without a seed are only reproducible with the one the service picked, it is sent as a header
+    ResponseSeed = 0;
+    LexFromString(ResponseSeed, *Response->GetHeader(TEXT("seed")));
+
     // The response data is already the binary image data - pass it directly
     OnImageGenerated.ExecuteIfBound(ResponseData);
 }
 
-FString FStabilityAPIClient::GetModelEndpoint(EImageGenerationModel Model) const
+FString FStabilityAPIClient::GetStylePresetString(EStylePreset Style)
+{
+    switch (Style)
+    {
+    case EStylePreset::None:
+        return FString();
+    case EStylePreset::Model3D:
+        return TEXT("3d-model");
+    case EStylePreset::AnalogFilm:
+        return TEXT("analog-film");
+    case EStylePreset::Anime:
+        return TEXT("anime");
+    case EStylePreset::Cinematic:
+        return TEXT("cinematic");
+    case EStylePreset::ComicBook:
+        return TEXT("comic-book");
+    case EStylePreset::DigitalArt:
+        return TEXT("digital-art");
+    case EStylePreset::Enhance:
+        return TEXT("enhance");
+    case EStylePreset::FantasyArt:
+        return TEXT("fantasy-art");
+    case EStylePreset::Isometric:
+        return TEXT("isometric");
+    case EStylePreset::LineArt:
+        return TEXT("line-art");
+    case EStylePreset::LowPoly:
+        return TEXT("low-poly");
+    case EStylePreset::ModelingCompound:
+        return TEXT("modeling-compound");
+    case EStylePreset::NeonPunk:
+        return TEXT("neon-punk");
+    case EStylePreset::Origami:
+        return TEXT("origami");
+    case EStylePreset::Photographic:
+        return TEXT("photographic");
+    case EStylePreset::PixelArt:
+        return TEXT("pixel-art");
+    case EStylePreset::TileTexture:
+        return TEXT("tile-texture");
+    default:
+        return FString();
+    }
+}
+
+FString FStabilityAPIClient::GetModelEndpoint(EImageGenerationModel Model)
 {
     switch (Model)
     {
@@ -170,9 +381,18 @@ FString FStabilityAPIClient::GetModelEndpoint(EImageGenerationModel Model) const
     }
 }
 
-TArray<uint8> FStabilityAPIClient::BuildMultipartFormData(const FString& Boundary) const
+FString FStabilityAPIClient::GetInpaintEndpoint()
 {
+    return TEXT("https://api.stability.ai/v2beta/stable-image/edit/inpaint");
+}
+
+TArray<uint8> FStabilityAPIClient::BuildMultipartFormData(const FStabilityGenerationParams& Params, const FString& Boundary)
+{
+    const TArrayView<const uint8> ReferenceImage = Params.GetReferenceImage();
+
+    // The images make up nearly all of the body, reserving for them up front avoids growing it while they are copied
     TArray<uint8> FormData;
+    FormData.Reserve(ReferenceImage.Num() + Params.MaskImage.Num() + 4096);
     const FString LineEnding = TEXT("\r\n");
 
     // Helper lambda to append string data as UTF-8 bytes
@@ -182,14 +402,14 @@ TArray<uint8> FStabilityAPIClient::BuildMultipartFormData(const FString& Boundar
     };
     
     // Helper lambda to append binary data directly
-    auto AppendBinary = [&](const TArray<uint8>& Data) {
+    auto AppendBinary = [&](TArrayView<const uint8> Data) {
         FormData.Append(Data);
     };
 
     // Add prompt field
     AppendString(FString::Printf(TEXT("--%s%s"), *Boundary, *LineEnding));
     AppendString(FString::Printf(TEXT("Content-Disposition: form-data; name=\"prompt\"%s%s"), *LineEnding, *LineEnding));
-    AppendString(FString::Printf(TEXT("%s%s"), *CurrentPrompt, *LineEnding));
+    AppendString(FString::Printf(TEXT("%s%s"), *Params.Prompt, *LineEnding));
 
     // Add output format
     AppendString(FString::Printf(TEXT("--%s%s"), *Boundary, *LineEnding));
@@ -197,46 +417,60 @@ TArray<uint8> FStabilityAPIClient::BuildMultipartFormData(const FString& Boundar
     AppendString(FString::Printf(TEXT("png%s"), *LineEnding));
 
     // Add negative prompt if set
-    if (!CurrentNegativePrompt.IsEmpty())
+    if (!Params.NegativePrompt.IsEmpty())
     {
         AppendString(FString::Printf(TEXT("--%s%s"), *Boundary, *LineEnding));
         AppendString(FString::Printf(TEXT("Content-Disposition: form-data; name=\"negative_prompt\"%s%s"), *LineEnding, *LineEnding));
-        AppendString(FString::Printf(TEXT("%s%s"), *CurrentNegativePrompt, *LineEnding));
+        AppendString(FString::Printf(TEXT("%s%s"), *Params.NegativePrompt, *LineEnding));
     }
 
     // Add seed if specified (> 0)
-    if (CurrentSeed > 0)
+    if (Params.Seed > 0)
     {
         AppendString(FString::Printf(TEXT("--%s%s"), *Boundary, *LineEnding));
         AppendString(FString::Printf(TEXT("Content-Disposition: form-data; name=\"seed\"%s%s"), *LineEnding, *LineEnding));
-        AppendString(FString::Printf(TEXT("%d%s"), CurrentSeed, *LineEnding));
+        AppendString(FString::Printf(TEXT("%d%s"), Params.Seed, *LineEnding));
     }
 
     // Add image style guidance preset
-    if (!CurrentStylePreset.IsEmpty())
+    if (!Params.StylePreset.IsEmpty())
     {
         AppendString(FString::Printf(TEXT("--%s%s"), *Boundary, *LineEnding));
         AppendString(FString::Printf(TEXT("Content-Disposition: form-data; name=\"style_preset\"%s%s"), *LineEnding, *LineEnding));
-        AppendString(FString::Printf(TEXT("%s%s"), *CurrentStylePreset, *LineEnding));
+        AppendString(FString::Printf(TEXT("%s%s"), *Params.StylePreset, *LineEnding));
     }
 
-    // Add reference image (for img2img workflows)
-    if (!CurrentReferenceImage.IsEmpty())
+    // Add reference image (for img2img workflows), files are copied straight from their mapping in their own format
+    if (!ReferenceImage.IsEmpty())
     {
         AppendString(FString::Printf(TEXT("--%s%s"), *Boundary, *LineEnding));
-        AppendString(FString::Printf(TEXT("Content-Disposition: form-data; name=\"image\"; filename=\"%s\"%s"), 
-            TEXT("reference.png"), *LineEnding));
-        AppendString(FString::Printf(TEXT("Content-Type: image/png%s%s"), *LineEnding, *LineEnding));
+        AppendString(FString::Printf(TEXT("Content-Disposition: form-data; name=\"image\"; filename=\"reference.%s\"%s"), 
+            Params.ReferenceImageFile.IsValid() ? Params.ReferenceImageFile->GetExtension() : TEXT("png"), *LineEnding));
+        AppendString(FString::Printf(TEXT("Content-Type: %s%s%s"),
+            Params.ReferenceImageFile.IsValid() ? Params.ReferenceImageFile->GetMimeType() : TEXT("image/png"), *LineEnding, *LineEnding));
         
         // Convert binary data to string representation
-        AppendBinary(CurrentReferenceImage);
+        AppendBinary(ReferenceImage);
         AppendString(LineEnding);
+    }
 
+    // Add the mask of an inpainting edit, which replaces the strength of image-to-image requests
+    if (!ReferenceImage.IsEmpty() && !Params.MaskImage.IsEmpty())
+    {
+        AppendString(FString::Printf(TEXT("--%s%s"), *Boundary, *LineEnding));
+        AppendString(FString::Printf(TEXT("Content-Disposition: form-data; name=\"mask\"; filename=\"%s\"%s"),
+            TEXT("mask.png"), *LineEnding));
+        AppendString(FString::Printf(TEXT("Content-Type: image/png%s%s"), *LineEnding, *LineEnding));
+        AppendBinary(Params.MaskImage);
+        AppendString(LineEnding);
+    }
+    else if (!ReferenceImage.IsEmpty())
+    {
         // Strength param is required when passing a reference image.
         // A value of 0 would yield an image that is identical to the input. A value of 1 would be as if you passed in no image at all.
         AppendString(FString::Printf(TEXT("--%s%s"), *Boundary, *LineEnding));
         AppendString(FString::Printf(TEXT("Content-Disposition: form-data; name=\"strength\"%s%s"), *LineEnding, *LineEnding));
-        AppendString(FString::Printf(TEXT("%.1f%s"), FMath::Clamp(CurrentStrength, 0.0f, 1.0f), *LineEnding));
+        AppendString(FString::Printf(TEXT("%.1f%s"), FMath::Clamp(Params.Strength, 0.0f, 1.0f), *LineEnding));
     }
 
     // End boundary
@@ -0,0 +1,494 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Commandlets/TextureGeneratorBenchmarkCommandlet.h"
+#include "API/PlaceholderGenerator.h"
+#include "API/StabilityAPIClient.h"
+#include "TextureGeneratorModule.h"
+#include "Utils/PixelKernels.h"
+#include "Utils/TextureUtils.h"
+
+#include "Dom/JsonObject.h"
+#include "Engine/Texture2D.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/DateTime.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/Package.h"
+
+#include <limits>
+
+namespace TextureGeneratorBenchmark
+{
+    /** Inputs shared by the kernels for one image size */
+    struct FInputs
+    {
+        int32 Size = 0;
+        FImage Image;
+        TArray<uint8> PngData;
+        UTexture2D* Texture = nullptr;
+
+        // Destination buffers of the pixel kernels, only allocated when one of them runs
+        TArray64<uint8> BytePixels;
+        TArray64<uint16> WidePixels;
+        TArray64<float> FloatPixels;
+
+        void AllocatePixelBuffers()
+        {
+            const int64 NumPixels = Image.GetNumPixels();
+            BytePixels = Image.RawData;
+            WidePixels.SetNumUninitialized(NumPixels * 4);
+            FloatPixels.SetNumUninitialized(NumPixels * 4);
+            FPixelKernels::SRGBToLinear(Image.RawData.GetData(), FloatPixels.GetData(), NumPixels);
+        }
+    };
+
+    struct FKernel
+    {
+        const TCHAR* Name;
+
+        // Runs the kernel once and returns the number of bytes it processed
+        TFunction<int64(FInputs&)> Run;
+
+        bool bUsesPixelBuffers = false;
+    };
+
+    // Smooth gradients with some noise on top, so the PNG encoder sees something closer to a generated texture than pure noise
+    static void MakeTestImage(int32 Size, FImage& OutImage)
+    {
+        OutImage.Init(Size, Size, ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+
+        FRandomStream Random(Size);
+        FColor* Pixels = reinterpret_cast<FColor*>(OutImage.RawData.GetData());
+        for (int32 Y = 0; Y < Size; ++Y)
+        {
+            for (int32 X = 0; X < Size; ++X)
+            {
+                const uint8 Noise = static_cast<uint8>(Random.RandHelper(32));
+                Pixels[static_cast<int64>(Y) * Size + X] = FColor(
+                    static_cast<uint8>(X * 255 / Size) ^ Noise,
+                    static_cast<uint8>(Y * 255 / Size),
+                    static_cast<uint8>((X + Y) * 127 / Size) + Noise,
+                    255);
+            }
+        }
+    }
+
+    template <typename T>
+    static bool MatchesReference(const TCHAR* Name, const TArray64<T>& Vector, const TArray64<T>& Scalar)
+    {
+        // Compare the bits, so NaN and negative zero count as mismatches too
+        for (int64 Index = 0; Index < Scalar.Num(); ++Index)
+        {
+            if (FMemory::Memcmp(&Vector[Index], &Scalar[Index], sizeof(T)) != 0)
+            {
+                UE_LOG(LogTextureGenerator, Error, TEXT("%s %s path differs from the scalar reference at value %lld."),
+                    Name, FPixelKernels::GetVectorPathName(), Index);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Runs every pixel kernel on edge cases and random data and compares it with the scalar reference bit for bit
+    static bool VerifyPixelKernels()
+    {
+        using FScalar = FPixelKernels::FScalar;
+
+        // Every color and alpha combination, plus a few pixels so the vector paths leave a scalar tail
+        const int64 NumPixels = 256 * 256 + 3;
+        FRandomStream Random(0x7E57);
+
+        TArray64<uint8> Bytes;
+        Bytes.SetNumUninitialized(NumPixels * 4);
+        for (int64 Index = 0; Index < NumPixels; ++Index)
+        {
+            const uint8 Color = static_cast<uint8>(Index >> 8);
+            const uint8 Alpha = static_cast<uint8>(Index);
+            Bytes[Index * 4 + 0] = Color;
+            Bytes[Index * 4 + 1] = static_cast<uint8>(Random.RandHelper(256));
+            Bytes[Index * 4 + 2] = static_cast<uint8>(Color ^ Alpha);
+            Bytes[Index * 4 + 3] = Alpha;
+        }
+
+        // Out of range values, infinities and NaN on top of the regular range
+        const float EdgeValues[] = { 0.0f, -0.0f, 1.0f, -1.0f, 2.0f, 1.0e-9f, 0.99999f, 0.5f / 4095.0f,
+            TNumericLimits<float>::Max(), -TNumericLimits<float>::Max(), std::numeric_limits<float>::quiet_NaN(),
+            std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity() };
+        TArray64<float> Floats;
+        Floats.SetNumUninitialized(NumPixels * 4);
+        for (int64 Index = 0; Index < Floats.Num(); ++Index)
+        {
+            Floats[Index] = Index < static_cast<int64>(UE_ARRAY_COUNT(EdgeValues)) ? EdgeValues[Index] : Random.FRandRange(-0.25f, 1.25f);
+        }
+
+        bool bMatches = true;
+        TArray64<uint8> VectorBytes, ScalarBytes;
+        TArray64<uint16> VectorWide, ScalarWide;
+        TArray64<float> VectorFloats, ScalarFloats;
+
+        VectorBytes.SetNumZeroed(NumPixels * 4);
+        ScalarBytes.SetNumZeroed(NumPixels * 4);
+        FPixelKernels::SwizzleRedBlue(Bytes.GetData(), VectorBytes.GetData(), NumPixels);
+        FScalar::SwizzleRedBlue(Bytes.GetData(), ScalarBytes.GetData(), NumPixels);
+        bMatches &= MatchesReference(TEXT("SwizzleRedBlue"), VectorBytes, ScalarBytes);
+
+        FPixelKernels::LinearToSRGB(Floats.GetData(), VectorBytes.GetData(), NumPixels);
+        FScalar::LinearToSRGB(Floats.GetData(), ScalarBytes.GetData(), NumPixels);
+        bMatches &= MatchesReference(TEXT("LinearToSRGB"), VectorBytes, ScalarBytes);
+
+        VectorBytes = Bytes;
+        ScalarBytes = Bytes;
+        FPixelKernels::PremultiplyAlpha(VectorBytes.GetData(), NumPixels);
+        FScalar::PremultiplyAlpha(ScalarBytes.GetData(), NumPixels);
+        bMatches &= MatchesReference(TEXT("PremultiplyAlpha"), VectorBytes, ScalarBytes);
+
+        VectorBytes = Bytes;
+        ScalarBytes = Bytes;
+        FPixelKernels::UnpremultiplyAlpha(VectorBytes.GetData(), NumPixels);
+        FScalar::UnpremultiplyAlpha(ScalarBytes.GetData(), NumPixels);
+        bMatches &= MatchesReference(TEXT("UnpremultiplyAlpha"), VectorBytes, ScalarBytes);
+
+        VectorWide.SetNumZeroed(NumPixels * 4);
+        ScalarWide.SetNumZeroed(NumPixels * 4);
+        FPixelKernels::Expand8To16(Bytes.GetData(), VectorWide.GetData(), NumPixels * 4);
+        FScalar::Expand8To16(Bytes.GetData(), ScalarWide.GetData(), NumPixels * 4);
+        bMatches &= MatchesReference(TEXT("Expand8To16"), VectorWide, ScalarWide);
+
+        VectorFloats.SetNumZeroed(NumPixels * 4);
+        ScalarFloats.SetNumZeroed(NumPixels * 4);
+        FPixelKernels::SRGBToLinear(Bytes.GetData(), VectorFloats.GetData(), NumPixels);
+        FScalar::SRGBToLinear(Bytes.GetData(), ScalarFloats.GetData(), NumPixels);
+        bMatches &= MatchesReference(TEXT("SRGBToLinear"), VectorFloats, ScalarFloats);
+
+        FPixelKernels::ConvertToFloat(Bytes.GetData(), VectorFloats.GetData(), NumPixels * 4);
+        FScalar::ConvertToFloat(Bytes.GetData(), ScalarFloats.GetData(), NumPixels * 4);
+        bMatches &= MatchesReference(TEXT("ConvertToFloat"), VectorFloats, ScalarFloats);
+
+        // Rows of a size leaving a scalar tail, with the periods of the placeholders and one which is not a power of two
+        const int32 NoiseSize = 259;
+        const int32 NoisePeriods[][2] = { { 32, 3 }, { 4, 6 }, { 3, 5 } };
+        VectorFloats.SetNumZeroed(static_cast<int64>(NoiseSize) * NoiseSize);
+        ScalarFloats.SetNumZeroed(static_cast<int64>(NoiseSize) * NoiseSize);
+        for (const int32* Periods : NoisePeriods)
+        {
+            for (int32 Row = 0; Row < NoiseSize; ++Row)
+            {
+                const int64 Offset = static_cast<int64>(Row) * NoiseSize;
+                FPixelKernels::FractalNoiseRow(Row, NoiseSize, Periods[0], Periods[1], 0x7E57u + Row, VectorFloats.GetData() + Offset);
+                FScalar::FractalNoiseRow(Row, NoiseSize, Periods[0], Periods[1], 0x7E57u + Row, ScalarFloats.GetData() + Offset);
+            }
+            bMatches &= MatchesReference(TEXT("FractalNoiseRow"), VectorFloats, ScalarFloats);
+        }
+
+        if (bMatches)
+        {
+            UE_LOG(LogTextureGenerator, Display, TEXT("Pixel kernels (%s) match the scalar reference."), FPixelKernels::GetVectorPathName());
+        }
+
+        return bMatches;
+    }
+
+    static TArray<FKernel> GetKernels()
+    {
+        TArray<FKernel> Kernels;
+
+        // Every pixel kernel runs twice, the scalar reference giving the baseline for the vector path
+        auto AddPixelKernel = [&Kernels](const TCHAR* Name, const TCHAR* ScalarName, TFunction<int64(FInputs&, bool)> Run)
+        {
+            Kernels.Add({ Name, [Run](FInputs& Inputs) { return Run(Inputs, false); }, true });
+            Kernels.Add({ ScalarName, [Run](FInputs& Inputs) { return Run(Inputs, true); }, true });
+        };
+
+        Kernels.Add({ TEXT("MultipartFormData"), [](FInputs& Inputs) -> int64
+        {
+            FStabilityGenerationParams Params;
+            Params.Prompt = TEXT("Weathered brick wall with moss, seamless, top-down, photographic");
+            Params.NegativePrompt = TEXT("blurry, text, watermark");
+            Params.StylePreset = TEXT("photographic");
+            Params.Seed = 1234;
+            Params.Strength = 0.5f;
+            Params.ReferenceImage = Inputs.PngData;
+            const TArray<uint8> FormData = FStabilityAPIClient::BuildMultipartFormData(Params, TEXT("----TextureGeneratorBenchmark"));
+            return FormData.Num();
+        } });
+
+        Kernels.Add({ TEXT("PngEncode"), [](FInputs& Inputs) -> int64
+        {
+            const TArray64<uint8> PngData = FTextureUtils::GetTextureImageData(Inputs.Texture);
+            return PngData.Num() > 0 ? Inputs.Image.RawData.Num() : 0;
+        } });
+
+        Kernels.Add({ TEXT("PngDecode"), [](FInputs& Inputs) -> int64
+        {
+            FImage Image;
+            return FTextureUtils::DecodeImageData(Inputs.PngData, Image) ? Image.RawData.Num() : 0;
+        } });
+
+        Kernels.Add({ TEXT("PlaceholderSynthesis"), [](FInputs& Inputs) -> int64
+        {
+            FImage Image;
+            FPlaceholderGenerator::Generate(TEXT("Weathered brick wall with moss"), 1234, Inputs.Size, Image);
+            return Image.RawData.Num();
+        } });
+
+        Kernels.Add({ TEXT("TextureSourceInit"), [](FInputs& Inputs) -> int64
+        {
+            Inputs.Texture->Source.Init(Inputs.Size, Inputs.Size, 1, 1, TSF_BGRA8, Inputs.Image.RawData.GetData());
+            return Inputs.Image.RawData.Num();
+        } });
+
+        AddPixelKernel(TEXT("SwizzleRedBlue"), TEXT("SwizzleRedBlueScalar"), [](FInputs& Inputs, bool bScalar) -> int64
+        {
+            const int64 NumPixels = Inputs.Image.GetNumPixels();
+            (bScalar ? FPixelKernels::FScalar::SwizzleRedBlue : FPixelKernels::SwizzleRedBlue)(Inputs.Image.RawData.GetData(), Inputs.BytePixels.GetData(), NumPixels);
+            return NumPixels * 4;
+        });
+
+        AddPixelKernel(TEXT("SRGBToLinear"), TEXT("SRGBToLinearScalar"), [](FInputs& Inputs, bool bScalar) -> int64
+        {
+            const int64 NumPixels = Inputs.Image.GetNumPixels();
+            (bScalar ? FPixelKernels::FScalar::SRGBToLinear : FPixelKernels::SRGBToLinear)(Inputs.Image.RawData.GetData(), Inputs.FloatPixels.GetData(), NumPixels);
+            return NumPixels * 4;
+        });
+
+        AddPixelKernel(TEXT("LinearToSRGB"), TEXT("LinearToSRGBScalar"), [](FInputs& Inputs, bool bScalar) -> int64
+        {
+            const int64 NumPixels = Inputs.Image.GetNumPixels();
+            (bScalar ? FPixelKernels::FScalar::LinearToSRGB : FPixelKernels::LinearToSRGB)(Inputs.FloatPixels.GetData(), Inputs.BytePixels.GetData(), NumPixels);
+            return NumPixels * 4 * sizeof(float);
+        });
+
+        AddPixelKernel(TEXT("Expand8To16"), TEXT("Expand8To16Scalar"), [](FInputs& Inputs, bool bScalar) -> int64
+        {
+            const int64 NumValues = Inputs.Image.RawData.Num();
+            (bScalar ? FPixelKernels::FScalar::Expand8To16 : FPixelKernels::Expand8To16)(Inputs.Image.RawData.GetData(), Inputs.WidePixels.GetData(), NumValues);
+            return NumValues;
+        });
+
+        AddPixelKernel(TEXT("ConvertToFloat"), TEXT("ConvertToFloatScalar"), [](FInputs& Inputs, bool bScalar) -> int64
+        {
+            const int64 NumValues = Inputs.Image.RawData.Num();
+            (bScalar ? FPixelKernels::FScalar::ConvertToFloat : FPixelKernels::ConvertToFloat)(Inputs.Image.RawData.GetData(), Inputs.FloatPixels.GetData(), NumValues);
+            return NumValues;
+        });
+
+        AddPixelKernel(TEXT("PremultiplyAlpha"), TEXT("PremultiplyAlphaScalar"), [](FInputs& Inputs, bool bScalar) -> int64
+        {
+            const int64 NumPixels = Inputs.Image.GetNumPixels();
+            (bScalar ? FPixelKernels::FScalar::PremultiplyAlpha : FPixelKernels::PremultiplyAlpha)(Inputs.BytePixels.GetData(), NumPixels);
+            return NumPixels * 4;
+        });
+
+        AddPixelKernel(TEXT("UnpremultiplyAlpha"), TEXT("UnpremultiplyAlphaScalar"), [](FInputs& Inputs, bool bScalar) -> int64
+        {
+            const int64 NumPixels = Inputs.Image.GetNumPixels();
+            (bScalar ? FPixelKernels::FScalar::UnpremultiplyAlpha : FPixelKernels::UnpremultiplyAlpha)(Inputs.BytePixels.GetData(), NumPixels);
+            return NumPixels * 4;
+        });
+
+        // The fractal noise of the placeholder shading, at the grit periods
+        AddPixelKernel(TEXT("FractalNoiseRow"), TEXT("FractalNoiseRowScalar"), [](FInputs& Inputs, bool bScalar) -> int64
+        {
+            for (int32 Row = 0; Row < Inputs.Size; ++Row)
+            {
+                float* Dst = Inputs.FloatPixels.GetData() + static_cast<int64>(Row) * Inputs.Size;
+                (bScalar ? FPixelKernels::FScalar::FractalNoiseRow : FPixelKernels::FractalNoiseRow)(Row, Inputs.Size, 32, 3, 101, Dst);
+            }
+            return static_cast<int64>(Inputs.Size) * Inputs.Size * sizeof(float);
+        });
+
+        return Kernels;
+    }
+
+    // Whether the low level memory tracker runs, it needs -LLM on the command line
+    static bool IsTrackingMemory()
+    {
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+        return FLowLevelMemTracker::IsEnabled();
+#else
+        return false;
+#endif
+    }
+
+    static TSharedRef<FJsonObject> RunKernel(const FKernel& Kernel, FInputs& Inputs, int32 Warmup, int32 Iterations)
+    {
+        // Every kernel and size allocates under a tag of its own, so the tracker reports the peak of exactly these runs.
+        // The tag applies to the benchmark thread, allocations of worker threads are counted under their own tags
+        const FString MemoryTag = FString::Printf(TEXT("TextureGeneratorBenchmark/%s/%d"), Kernel.Name, Inputs.Size);
+        TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(*MemoryTag);
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+        FLLMScope MemoryScope(FName(*MemoryTag), false, ELLMTagSet::None, ELLMTracker::Default);
+#endif
+
+        for (int32 Index = 0; Index < Warmup; ++Index)
+        {
+            Kernel.Run(Inputs);
+        }
+
+        TArray<double> Timings;
+        int64 ProcessedBytes = 0;
+
+        for (int32 Index = 0; Index < Iterations; ++Index)
+        {
+            const double StartTime = FPlatformTime::Seconds();
+            ProcessedBytes = Kernel.Run(Inputs);
+            Timings.Add(FPlatformTime::Seconds() - StartTime);
+        }
+
+        // Without the tracker there is no per kernel measure, the process wide one would include memory cached by the allocator
+        int64 PeakBytes = -1;
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+        if (IsTrackingMemory())
+        {
+            FLowLevelMemTracker::Get().UpdateStatsPerFrame();
+            PeakBytes = FLowLevelMemTracker::Get().GetTagAmountForTracker(ELLMTracker::Default, FName(*MemoryTag), ELLMTagSet::None, UE::LLM::ESizeParams::ReportPeak);
+        }
+#endif
+
+        Timings.Sort();
+        double TotalTime = 0.0;
+        for (double Timing : Timings)
+        {
+            TotalTime += Timing;
+        }
+
+        const double MedianSeconds = Timings[Timings.Num() / 2];
+
+        TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+        Result->SetStringField(TEXT("kernel"), Kernel.Name);
+        Result->SetNumberField(TEXT("size"), Inputs.Size);
+        Result->SetNumberField(TEXT("iterations"), Iterations);
+        Result->SetNumberField(TEXT("bytes"), static_cast<double>(ProcessedBytes));
+        Result->SetNumberField(TEXT("minMs"), Timings[0] * 1000.0);
+        Result->SetNumberField(TEXT("medianMs"), MedianSeconds * 1000.0);
+        Result->SetNumberField(TEXT("meanMs"), TotalTime / Timings.Num() * 1000.0);
+        Result->SetNumberField(TEXT("maxMs"), Timings.Last() * 1000.0);
+        Result->SetNumberField(TEXT("mbPerSecond"), MedianSeconds > 0.0 ? ProcessedBytes / MedianSeconds / (1024.0 * 1024.0) : 0.0);
+        if (PeakBytes >= 0)
+        {
+            Result->SetNumberField(TEXT("peakBytes"), static_cast<double>(PeakBytes));
+        }
+        else
+        {
+            Result->SetField(TEXT("peakBytes"), MakeShared<FJsonValueNull>());
+        }
+
+        UE_LOG(LogTextureGenerator, Display, TEXT("%-20s %5d: median %9.3f ms, %9.1f MB/s, peak memory %s"),
+            Kernel.Name, Inputs.Size, MedianSeconds * 1000.0, Result->GetNumberField(TEXT("mbPerSecond")),
+            PeakBytes >= 0 ? *FString::Printf(TEXT("%.1f MB"), PeakBytes / (1024.0 * 1024.0)) : TEXT("unavailable"));
+
+        return Result;
+    }
+}
+
+UTextureGeneratorBenchmarkCommandlet::UTextureGeneratorBenchmarkCommandlet()
+{
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 UTextureGeneratorBenchmarkCommandlet::Main(const FString& Params)
+{
+    using namespace TextureGeneratorBenchmark;
+
+    FString OutputFilename = FPaths::ProjectSavedDir() / TEXT("TextureGenerator") / TEXT("Benchmark.json");
+    FParse::Value(*Params, TEXT("Output="), OutputFilename);
+
+    FString SizesParam = TEXT("512,1024,2048,4096,8192");
+    FParse::Value(*Params, TEXT("Sizes="), SizesParam);
+
+    FString KernelsParam;
+    FParse::Value(*Params, TEXT("Kernels="), KernelsParam);
+
+    FString Label;
+    FParse::Value(*Params, TEXT("Label="), Label);
+
+    int32 Iterations = 5;
+    int32 Warmup = 1;
+    FParse::Value(*Params, TEXT("Iterations="), Iterations);
+    FParse::Value(*Params, TEXT("Warmup="), Warmup);
+    Iterations = FMath::Max(1, Iterations);
+    Warmup = FMath::Max(0, Warmup);
+
+    TArray<FString> SizeStrings;
+    SizesParam.ParseIntoArray(SizeStrings, TEXT(","));
+
+    TArray<FString> SelectedKernels;
+    KernelsParam.ParseIntoArray(SelectedKernels, TEXT(","));
+
+    TArray<FKernel> Kernels = GetKernels();
+    Kernels.RemoveAll([&SelectedKernels](const FKernel& Kernel)
+    {
+        return SelectedKernels.Num() > 0 && !SelectedKernels.Contains(Kernel.Name);
+    });
+
+    const bool bPixelKernelsVerified = VerifyPixelKernels();
+    const bool bUsesPixelBuffers = Kernels.ContainsByPredicate([](const FKernel& Kernel) { return Kernel.bUsesPixelBuffers; });
+
+    TArray<TSharedPtr<FJsonValue>> Results;
+    for (const FString& SizeString : SizeStrings)
+    {
+        FInputs Inputs;
+        Inputs.Size = FCString::Atoi(*SizeString);
+        if (Inputs.Size <= 0)
+        {
+            UE_LOG(LogTextureGenerator, Warning, TEXT("Skipping invalid benchmark size '%s'."), *SizeString);
+            continue;
+        }
+
+        MakeTestImage(Inputs.Size, Inputs.Image);
+
+        Inputs.Texture = NewObject<UTexture2D>(GetTransientPackage(), NAME_None, RF_Transient);
+        Inputs.Texture->AddToRoot();
+        Inputs.Texture->Source.Init(Inputs.Size, Inputs.Size, 1, 1, TSF_BGRA8, Inputs.Image.RawData.GetData());
+        Inputs.PngData = TArray<uint8>(FTextureUtils::GetTextureImageData(Inputs.Texture));
+
+        if (bUsesPixelBuffers)
+        {
+            Inputs.AllocatePixelBuffers();
+        }
+
+        for (const FKernel& Kernel : Kernels)
+        {
+            Results.Add(MakeShared<FJsonValueObject>(RunKernel(Kernel, Inputs, Warmup, Iterations)));
+        }
+
+        Inputs.Texture->RemoveFromRoot();
+    }
+
+    TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+    Report->SetStringField(TEXT("label"), Label);
+    Report->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+    Report->SetStringField(TEXT("engineVersion"), FEngineVersion::Current().ToString());
+    Report->SetStringField(TEXT("cpu"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+    Report->SetNumberField(TEXT("logicalCores"), FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+    Report->SetNumberField(TEXT("warmup"), Warmup);
+    Report->SetStringField(TEXT("vectorPath"), FPixelKernels::GetVectorPathName());
+    Report->SetBoolField(TEXT("pixelKernelsVerified"), bPixelKernelsVerified);
+    Report->SetNumberField(TEXT("peakUsedPhysicalBytes"), static_cast<double>(FPlatformMemory::GetStats().PeakUsedPhysical));
+    Report->SetStringField(TEXT("kernelMemory"), IsTrackingMemory() ? TEXT("llm") : TEXT("unavailable"));
+    Report->SetArrayField(TEXT("results"), Results);
+
+    FString Json;
+    TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+    FJsonSerializer::Serialize(Report, Writer);
+
+    if (!FFileHelper::SaveStringToFile(Json, *OutputFilename))
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Failed to write benchmark results to %s."), *OutputFilename);
+        return 1;
+    }
+
+    UE_LOG(LogTextureGenerator, Display, TEXT("Benchmark results written to %s."), *OutputFilename);
+    return bPixelKernelsVerified ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Commandlets/TextureGeneratorDDCCheckCommandlet.h"
+#include "TextureGeneratorModule.h"
+#include "TextureGeneratorSettings.h"
+#include "Utils/TextureDDCPublisher.h"
+#include "Utils/TextureUtils.h"
+
+#include "AssetCompilingManager.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "DerivedDataCacheInterface.h"
+#include "DerivedDataCacheUsageStats.h"
+#include "Engine/Texture.h"
+#include "HAL/PlatformProcess.h"
+#include "Interfaces/ITargetPlatform.h"
+
+namespace TextureGeneratorDDCCheckCommandlet
+{
+    // Successful gets and puts of the cache layers, split into layers on this machine and shared ones
+    struct FCacheCounters
+    {
+        int64 LocalHits = 0;
+        int64 SharedHits = 0;
+        int64 SharedPuts = 0;
+    };
+
+    static FCacheCounters GatherCacheCounters()
+    {
+        FCacheCounters Counters;
+#if ENABLE_COOK_STATS
+        GetDerivedDataCacheRef().GatherUsageStats()->ForEachDescendant([&Counters](TSharedRef<const FDerivedDataCacheStatsNode> Node)
+        {
+            // Hierarchies and other wrappers forward to their children, only the leaves store data
+            if (Node->Children.Num() > 0)
+            {
+                return;
+            }
+
+            for (const TPair<FString, FDerivedDataCacheUsageStats>& Stats : Node->UsageStats)
+            {
+                const int64 Hits = Stats.Value.GetStats.GetAccumulatedValueAnyThread(FCookStats::CallStats::EHitOrMiss::Hit, FCookStats::CallStats::EStatType::Counter);
+                const int64 Puts = Stats.Value.PutStats.GetAccumulatedValueAnyThread(FCookStats::CallStats::EHitOrMiss::Hit, FCookStats::CallStats::EStatType::Counter);
+                if (Node->IsLocal())
+                {
+                    Counters.LocalHits += Hits;
+                }
+                else
+                {
+                    Counters.SharedHits += Hits;
+                    Counters.SharedPuts += Puts;
+                }
+            }
+        });
+#endif
+        return Counters;
+    }
+
+    static void WaitForCookedPlatformData(UTexture* Texture, const ITargetPlatform* Platform)
+    {
+        while (!Texture->IsCachedCookedPlatformDataLoaded(Platform))
+        {
+            FAssetCompilingManager::Get().ProcessAsyncTasks(true);
+            FPlatformProcess::Sleep(0.005f);
+        }
+    }
+}
+
+UTextureGeneratorDDCCheckCommandlet::UTextureGeneratorDDCCheckCommandlet()
+{
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 UTextureGeneratorDDCCheckCommandlet::Main(const FString& Params)
+{
+    using namespace TextureGeneratorDDCCheckCommandlet;
+
+    if constexpr (!ENABLE_COOK_STATS)
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Checking the derived data cache needs cook stats, which this build was compiled without."));
+        return 1;
+    }
+
+    FString Path = GetDefault<UTextureGeneratorSettings>()->DefaultAssetPath;
+    FParse::Value(*Params, TEXT("Path="), Path);
+    Path.RemoveFromEnd(TEXT("/"));
+
+    const bool bRequireSharedHits = FParse::Param(*Params, TEXT("RequireSharedHits"));
+
+    const TArray<const ITargetPlatform*> Platforms = FTextureDDCPublisher::GetTargetPlatforms();
+    if (Platforms.Num() == 0)
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("No target platform to cache the textures for."));
+        return 1;
+    }
+
+    // Generated assets are found by their provenance tag, without loading anything else
+    IAssetRegistry::GetChecked().SearchAllAssets(true);
+
+    FARFilter Filter;
+    Filter.PackagePaths.Add(FName(*Path));
+    Filter.bRecursivePaths = true;
+    Filter.TagsAndValues.Add(FName(TextureGeneratorMetaData::Prompt));
+
+    TArray<FAssetData> Assets;
+    IAssetRegistry::GetChecked().GetAssets(Filter, Assets);
+
+    int32 NumQueries = 0;
+    int32 NumSharedHits = 0;
+    int32 NumLocalHits = 0;
+    int32 NumMisses = 0;
+
+    for (const FAssetData& Asset : Assets)
+    {
+        UTexture* Texture = Cast<UTexture>(Asset.GetAsset());
+        if (!Texture)
+        {
+            continue;
+        }
+
+        for (const ITargetPlatform* Platform : Platforms)
+        {
+            // Start from nothing, so the query goes through the cache layers rather than memory
+            Texture->ClearCachedCookedPlatformData(Platform);
+
+            const FCacheCounters Before = GatherCacheCounters();
+            Texture->BeginCacheForCookedPlatformData(Platform);
+            WaitForCookedPlatformData(Texture, Platform);
+            const FCacheCounters After = GatherCacheCounters();
+
+            Texture->ClearCachedCookedPlatformData(Platform);
+            ++NumQueries;
+
+            const TCHAR* Outcome = nullptr;
+            if (After.SharedHits > Before.SharedHits)
+            {
+                ++NumSharedHits;
+                Outcome = TEXT("hit in the shared cache");
+            }
+            else if (After.LocalHits > Before.LocalHits)
+            {
+                ++NumLocalHits;
+                Outcome = TEXT("hit in the local cache only");
+            }
+            else
+            {
+                ++NumMisses;
+                Outcome = After.SharedPuts > Before.SharedPuts ? TEXT("miss, built and written to the shared cache") : TEXT("miss, built without reaching a shared cache");
+            }
+
+            UE_LOG(LogTextureGenerator, Display, TEXT("%s (%s): %s"), *Asset.PackageName.ToString(), *Platform->PlatformName(), Outcome);
+        }
+    }
+
+    UE_LOG(LogTextureGenerator, Display, TEXT("Queried %d generated textures for %d platforms: %d shared hits, %d local hits, %d misses."),
+        Assets.Num(), Platforms.Num(), NumSharedHits, NumLocalHits, NumMisses);
+
+    if (NumLocalHits > 0 && NumSharedHits == 0)
+    {
+        UE_LOG(LogTextureGenerator, Display, TEXT("The local cache answered first. Run again with a cold local cache to check the shared one."));
+    }
+
+    return bRequireSharedHits && NumSharedHits < NumQueries ? 1 : 0;
+}
@@ -0,0 +1,60 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Commandlets/TextureGeneratorMemoryReportCommandlet.h"
+#include "TextureGeneratorModule.h"
+#include "Utils/TextureMemoryReport.h"
+
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UTextureGeneratorMemoryReportCommandlet::UTextureGeneratorMemoryReportCommandlet()
+{
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 UTextureGeneratorMemoryReportCommandlet::Main(const FString& Params)
+{
+    FString OutputFilename = FPaths::ProjectSavedDir() / TEXT("TextureGenerator") / TEXT("MemoryReport.csv");
+    FParse::Value(*Params, TEXT("Output="), OutputFilename);
+
+    int32 OversizeThreshold = FTextureMemoryReport::DefaultOversizeThreshold;
+    FParse::Value(*Params, TEXT("OversizeThreshold="), OversizeThreshold);
+
+    const bool bFailOnFlags = FParse::Param(*Params, TEXT("FailOnFlags"));
+
+    // Referencers are only complete once the whole project was scanned
+    IAssetRegistry::GetChecked().SearchAllAssets(true);
+
+    const TArray<FTextureMemoryReportEntry> Entries = FTextureMemoryReport::Collect(FMath::Max(1, OversizeThreshold));
+
+    const bool bJson = FPaths::GetExtension(OutputFilename).Equals(TEXT("json"), ESearchCase::IgnoreCase);
+    const FString Report = bJson ? FTextureMemoryReport::ToJson(Entries) : FTextureMemoryReport::ToCsv(Entries);
+    if (!FFileHelper::SaveStringToFile(Report, *OutputFilename))
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Failed to write the memory report to %s."), *OutputFilename);
+        return 1;
+    }
+
+    int64 TotalFullBytes = 0;
+    int64 TotalResidentBytes = 0;
+    int32 NumFlagged = 0;
+    for (const FTextureMemoryReportEntry& Entry : Entries)
+    {
+        TotalFullBytes += Entry.FullBytes;
+        TotalResidentBytes += Entry.ResidentBytes;
+        if (Entry.Flags != ETextureMemoryFlags::None)
+        {
+            ++NumFlagged;
+            UE_LOG(LogTextureGenerator, Display, TEXT("%s: %s"), *Entry.PackageName, *FTextureMemoryReport::GetFlagNames(Entry.Flags));
+        }
+    }
+
+    UE_LOG(LogTextureGenerator, Display, TEXT("Memory report of %d textures written to %s: %.1f MB in total, %.1f MB always resident, %d flagged."),
+        Entries.Num(), *OutputFilename, TotalFullBytes / (1024.0 * 1024.0), TotalResidentBytes / (1024.0 * 1024.0), NumFlagged);
+
+    return bFailOnFlags && NumFlagged > 0 ? 1 : 0;
+}
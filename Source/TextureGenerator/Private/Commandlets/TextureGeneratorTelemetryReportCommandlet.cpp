@@ -0,0 +1,54 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Commandlets/TextureGeneratorTelemetryReportCommandlet.h"
+#include "Subsystems/GenerationTelemetry.h"
+#include "TextureGeneratorModule.h"
+
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UTextureGeneratorTelemetryReportCommandlet::UTextureGeneratorTelemetryReportCommandlet()
+{
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 UTextureGeneratorTelemetryReportCommandlet::Main(const FString& Params)
+{
+    int32 Days = 30;
+    FParse::Value(*Params, TEXT("Days="), Days);
+
+    FString OutputFilename;
+    FParse::Value(*Params, TEXT("Output="), OutputFilename);
+
+    const bool bPerDay = FParse::Param(*Params, TEXT("PerDay"));
+
+    const FDateTime Since = FDateTime::UtcNow() - FTimespan::FromDays(FMath::Max(1, Days));
+    const TArray<FGenerationTelemetry::FRecord> Records = FGenerationTelemetry::Load(FGenerationTelemetry::GetDefaultDirectory(), Since);
+    if (Records.Num() == 0)
+    {
+        UE_LOG(LogTextureGenerator, Display, TEXT("No generation telemetry recorded in the last %d days."), Days);
+        return 0;
+    }
+
+    TArray<FString> Lines;
+    FGenerationTelemetry::FormatReport(Records, bPerDay).ParseIntoArrayLines(Lines);
+    for (const FString& Line : Lines)
+    {
+        UE_LOG(LogTextureGenerator, Display, TEXT("%s"), *Line);
+    }
+
+    if (!OutputFilename.IsEmpty())
+    {
+        if (!FFileHelper::SaveStringToFile(FGenerationTelemetry::ToCsv(Records, bPerDay), *OutputFilename))
+        {
+            UE_LOG(LogTextureGenerator, Error, TEXT("Failed to write the telemetry report to %s."), *OutputFilename);
+            return 1;
+        }
+        UE_LOG(LogTextureGenerator, Display, TEXT("Telemetry report of %d jobs written to %s."), Records.Num(), *OutputFilename);
+    }
+
+    return 0;
+}
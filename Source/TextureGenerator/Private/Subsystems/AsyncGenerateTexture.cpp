@@ -0,0 +1,120 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Subsystems/AsyncGenerateTexture.h"
+#include "Subsystems/TextureGeneratorSubsystem.h"
+
+#include "Editor.h"
+
+UAsyncGenerateTexture* UAsyncGenerateTexture::GenerateTextureAsync(const FTextureGenerationRequest& Request)
+{
+    UAsyncGenerateTexture* Action = NewObject<UAsyncGenerateTexture>();
+    Action->Request = Request;
+    return Action;
+}
+
+void UAsyncGenerateTexture::Activate()
+{
+    UTextureGeneratorSubsystem* Subsystem = GEditor ? GEditor->GetEditorSubsystem<UTextureGeneratorSubsystem>() : nullptr;
+    if (!Subsystem)
+    {
+        FTextureGenerationJobInfo JobInfo;
+        JobInfo.Request = Request;
+        JobInfo.State = ETextureGenerationJobState::Failed;
+        JobInfo.ErrorMessage = TEXT("Texture generator subsystem is not available.");
+        OnFailed.Broadcast(JobInfo);
+        SetReadyToDestroy();
+        return;
+    }
+
+    // There is no game instance in the editor to keep the action alive until the job finishes
+    AddToRoot();
+
+    JobFinishedHandle = Subsystem->OnJobFinishedNative().AddUObject(this, &UAsyncGenerateTexture::HandleJobFinished);
+    JobId = Subsystem->GenerateTexture(Request);
+}
+
+void UAsyncGenerateTexture::HandleJobFinished(const FTextureGenerationJobInfo& JobInfo)
+{
+    if (JobInfo.JobId != JobId)
+    {
+        return;
+    }
+
+    if (UTextureGeneratorSubsystem* Subsystem = GEditor->GetEditorSubsystem<UTextureGeneratorSubsystem>())
+    {
+        Subsystem->OnJobFinishedNative().Remove(JobFinishedHandle);
+    }
+
+    if (JobInfo.State == ETextureGenerationJobState::Completed)
+    {
+        OnCompleted.Broadcast(JobInfo);
+    }
+    else
+    {
+        OnFailed.Broadcast(JobInfo);
+    }
+
+    RemoveFromRoot();
+    SetReadyToDestroy();
+}
+
+UAsyncGenerateTextureBatch* UAsyncGenerateTextureBatch::GenerateTextureBatchAsync(const TArray<FTextureGenerationRequest>& Requests)
+{
+    UAsyncGenerateTextureBatch* Action = NewObject<UAsyncGenerateTextureBatch>();
+    Action->Requests = Requests;
+    return Action;
+}
+
+void UAsyncGenerateTextureBatch::Activate()
+{
+    UTextureGeneratorSubsystem* Subsystem = GEditor ? GEditor->GetEditorSubsystem<UTextureGeneratorSubsystem>() : nullptr;
+    if (!Subsystem || Requests.IsEmpty())
+    {
+        Finish();
+        return;
+    }
+
+    AddToRoot();
+
+    JobFinishedHandle = Subsystem->OnJobFinishedNative().AddUObject(this, &UAsyncGenerateTextureBatch::HandleJobFinished);
+
+    const TArray<FGuid> JobIds = Subsystem->GenerateTextureBatch(Requests);
+    Results.SetNum(JobIds.Num());
+    for (int32 Index = 0; Index < JobIds.Num(); ++Index)
+    {
+        JobIndices.Add(JobIds[Index], Index);
+        Results[Index].JobId = JobIds[Index];
+        Results[Index].Request = Requests[Index];
+    }
+}
+
+void UAsyncGenerateTextureBatch::HandleJobFinished(const FTextureGenerationJobInfo& JobInfo)
+{
+    const int32* Index = JobIndices.Find(JobInfo.JobId);
+    if (!Index)
+    {
+        return;
+    }
+
+    Results[*Index] = JobInfo;
+    ++NumFinishedJobs;
+
+    OnJobFinished.Broadcast(JobInfo);
+
+    if (NumFinishedJobs == Results.Num())
+    {
+        if (UTextureGeneratorSubsystem* Subsystem = GEditor->GetEditorSubsystem<UTextureGeneratorSubsystem>())
+        {
+            Subsystem->OnJobFinishedNative().Remove(JobFinishedHandle);
+        }
+
+        RemoveFromRoot();
+        Finish();
+    }
+}
+
+void UAsyncGenerateTextureBatch::Finish()
+{
+    OnCompleted.Broadcast(Results);
+    SetReadyToDestroy();
+}
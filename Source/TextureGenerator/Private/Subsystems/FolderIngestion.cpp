@@ -0,0 +1,227 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Subsystems/FolderIngestion.h"
+#include "TextureGeneratorModule.h"
+#include "TextureGeneratorSettings.h"
+#include "Utils/TextureUtils.h"
+
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "IImageWrapperModule.h"
+#include "ImageUtils.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+#include "ObjectTools.h"
+
+namespace FolderIngestion
+{
+    // Asset names from file names, textures exported from an earlier run keep their name instead of becoming T_T_
+    static TArray<FString> MakeAssetNames(const TArray<FString>& Filenames)
+    {
+        TArray<FString> AssetNames;
+        AssetNames.Reserve(Filenames.Num());
+
+        TSet<FString> UsedNames;
+        for (const FString& Filename : Filenames)
+        {
+            FString BaseName = ObjectTools::SanitizeObjectName(FPaths::GetBaseFilename(Filename));
+            BaseName.RemoveFromStart(TEXT("T_"));
+            if (BaseName.IsEmpty())
+            {
+                BaseName = TEXT("Image");
+            }
+
+            // Files of the same name in different subfolders get a numbered suffix
+            FString AssetName = BaseName;
+            for (int32 Suffix = 2; UsedNames.Contains(AssetName); ++Suffix)
+            {
+                AssetName = FString::Printf(TEXT("%s_%d"), *BaseName, Suffix);
+            }
+            UsedNames.Add(AssetName);
+            AssetNames.Add(MoveTemp(AssetName));
+        }
+
+        return AssetNames;
+    }
+
+    // Decoded size assumed for files before any was decoded, a 4K BGRA8 image
+    static constexpr int64 InitialBytesPerFile = 4096LL * 4096 * 4;
+}
+
+FFolderIngestion::FFolderIngestion(TArray<FString> InFilenames, bool bInCreateMaterials)
+    : Filenames(MoveTemp(InFilenames))
+    , bCreateMaterials(bInCreateMaterials)
+{
+    AssetNames = FolderIngestion::MakeAssetNames(Filenames);
+
+    // Files named like existing assets, e.g. generated T_<Name> textures or an earlier ingestion, are left alone
+    TArray<FString> NewFilenames;
+    TArray<FString> NewAssetNames;
+    for (int32 Index = 0; Index < Filenames.Num(); ++Index)
+    {
+        const FString& AssetName = AssetNames[Index];
+        if (FTextureUtils::DoesGeneratedAssetExist(TEXT("T_") + AssetName) || (bCreateMaterials && FTextureUtils::DoesGeneratedAssetExist(TEXT("M_") + AssetName)))
+        {
+            UE_LOG(LogTextureGenerator, Warning, TEXT("Skipping %s, an asset named %s already exists."), *Filenames[Index], *AssetName);
+            ++NumSkipped;
+            continue;
+        }
+        NewFilenames.Add(MoveTemp(Filenames[Index]));
+        NewAssetNames.Add(AssetName);
+    }
+    Filenames = MoveTemp(NewFilenames);
+    AssetNames = MoveTemp(NewAssetNames);
+
+    // Enough files to keep every worker busy, the memory budget caps how many of them are decoded at once
+    MaxBatchSize = FMath::Max(4, FTaskGraphInterface::Get().GetNumWorkerThreads() * 2);
+    MemoryBudget = static_cast<int64>(GetDefault<UTextureGeneratorSettings>()->ResultMemoryBudgetMB) * 1024 * 1024;
+    BytesPerFile = FolderIngestion::InitialBytesPerFile;
+    StartTime = FPlatformTime::Seconds();
+
+    // Decoders are looked up from the worker threads, where modules cannot be loaded
+    FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+}
+
+FFolderIngestion::~FFolderIngestion()
+{
+    // The workers write into the batch they own, but let them finish before the module may go away
+    if (DecodingBatch.IsValid())
+    {
+        DecodingBatch.Wait();
+    }
+}
+
+TArray<FString> FFolderIngestion::FindImageFiles(const FString& Directory, bool bRecursive)
+{
+    TArray<FString> Files;
+    if (bRecursive)
+    {
+        IFileManager::Get().FindFilesRecursive(Files, *Directory, TEXT("*.*"), true, false);
+    }
+    else
+    {
+        IFileManager::Get().FindFiles(Files, *(Directory / TEXT("*.*")), true, false);
+        for (FString& File : Files)
+        {
+            File = Directory / File;
+        }
+    }
+
+    IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+    Files.RemoveAll([&ImageWrapperModule](const FString& File)
+    {
+        return ImageWrapperModule.GetImageFormatFromExtension(*FPaths::GetExtension(File)) == EImageFormat::Invalid;
+    });
+
+    Files.Sort();
+    return Files;
+}
+
+void FFolderIngestion::Tick()
+{
+    if (DecodingBatch.IsValid() && DecodingBatch.IsReady())
+    {
+        TArray<FFile> Batch = DecodingBatch.Consume();
+        for (const FFile& File : Batch)
+        {
+            DecodedBytes += File.Image.RawData.Num();
+            BytesPerFile = FMath::Max(BytesPerFile, File.Image.RawData.Num());
+        }
+
+        if (FirstDecoded == Decoded.Num())
+        {
+            Decoded = MoveTemp(Batch);
+            FirstDecoded = 0;
+        }
+        else
+        {
+            Decoded.Append(MoveTemp(Batch));
+        }
+    }
+
+    // Decode the next batch while the importer works through the current one, but never more than one ahead,
+    // and only as many files as fit into the memory budget next to the decoded files still waiting
+    if (DecodingBatch.IsValid() || NextFile >= Filenames.Num() || Decoded.Num() - FirstDecoded >= MaxBatchSize
+        || (DecodedBytes > 0 && DecodedBytes >= MemoryBudget))
+    {
+        return;
+    }
+
+    // The largest file so far sizes the batch, a single file larger than the budget is still decoded on its own
+    const int64 NumAffordableFiles = FMath::Max<int64>(1, (MemoryBudget - DecodedBytes) / BytesPerFile);
+    const int32 NumBatchFiles = static_cast<int32>(FMath::Min<int64>(FMath::Min<int64>(MaxBatchSize, NumAffordableFiles), Filenames.Num() - NextFile));
+    TArray<FFile> Batch;
+    Batch.SetNum(NumBatchFiles);
+    for (int32 Index = 0; Index < NumBatchFiles; ++Index)
+    {
+        Batch[Index].Filename = Filenames[NextFile + Index];
+        Batch[Index].AssetName = AssetNames[NextFile + Index];
+    }
+    NextFile += NumBatchFiles;
+
+    DecodingBatch = Async(EAsyncExecution::ThreadPool, [Batch = MoveTemp(Batch)]() mutable
+    {
+        ParallelFor(Batch.Num(), [&Batch](int32 Index)
+        {
+            DecodeFile(Batch[Index]);
+        });
+        return MoveTemp(Batch);
+    });
+}
+
+bool FFolderIngestion::Pop(FFile& OutFile)
+{
+    if (FirstDecoded >= Decoded.Num())
+    {
+        return false;
+    }
+
+    OutFile = MoveTemp(Decoded[FirstDecoded]);
+    ++FirstDecoded;
+    DecodedBytes -= OutFile.Image.RawData.Num();
+    return true;
+}
+
+bool FFolderIngestion::IsDone() const
+{
+    return NextFile >= Filenames.Num() && !DecodingBatch.IsValid() && FirstDecoded >= Decoded.Num();
+}
+
+void FFolderIngestion::RecordResult(bool bImported)
+{
+    ++(bImported ? NumImported : NumFailed);
+}
+
+double FFolderIngestion::GetElapsedSeconds() const
+{
+    return FPlatformTime::Seconds() - StartTime;
+}
+
+void FFolderIngestion::DecodeFile(FFile& File)
+{
+    TArray<uint8> FileData;
+    if (!FFileHelper::LoadFileToArray(FileData, *File.Filename))
+    {
+        return;
+    }
+
+    // PNG takes the same fast path as generation results, other formats go through the generic decoder
+    IImageWrapperModule& ImageWrapperModule = FModuleManager::GetModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+    if (ImageWrapperModule.DetectImageFormat(FileData.GetData(), FileData.Num()) == EImageFormat::PNG)
+    {
+        File.bDecoded = FTextureUtils::DecodeImageData(FileData, File.Image);
+        return;
+    }
+
+    if (!FImageUtils::DecompressImage(FileData.GetData(), FileData.Num(), File.Image))
+    {
+        return;
+    }
+
+    // Textures are created from 8 bit color, high dynamic range files are clamped by the conversion
+    File.Image.ChangeFormat(ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+    File.bDecoded = true;
+}
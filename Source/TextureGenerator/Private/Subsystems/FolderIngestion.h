@@ -0,0 +1,87 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "ImageCore.h"
+
+/**
+ * Bulk import of a folder of images produced outside the editor.
+ * Files are read and decoded on worker threads one batch at a time, while the game thread imports the previous batch.
+ * At most one batch waits decoded ahead of the importer, and the decoded files stay within the result memory budget,
+ * so memory stays bounded however large the folder is. Files named like existing assets are skipped, nothing is overwritten.
+ */
+class FFolderIngestion
+{
+public:
+    /** A decoded file, ready for import. */
+    struct FFile
+    {
+        FString Filename;
+
+        // Asset name derived from the file name, unique within the ingestion
+        FString AssetName;
+
+        // BGRA8 sRGB, like decoded generation results
+        FImage Image;
+        bool bDecoded = false;
+    };
+
+    /**
+     * @param InFilenames Image files to ingest
+     * @param bInCreateMaterials Whether a basic material is created for every texture
+     */
+    FFolderIngestion(TArray<FString> InFilenames, bool bInCreateMaterials);
+    ~FFolderIngestion();
+
+    /** Finds the image files in a directory which the engine can decode, sorted by name. */
+    static TArray<FString> FindImageFiles(const FString& Directory, bool bRecursive);
+
+    /** Collects the batch decoded on the worker threads and starts decoding the next one once the importer caught up. Game thread only. */
+    void Tick();
+
+    /** Pops the next decoded file. Returns false while the next batch is still decoding. */
+    bool Pop(FFile& OutFile);
+
+    /** Whether every file was decoded and popped. */
+    bool IsDone() const;
+
+    /** Counts a popped file as imported or failed. */
+    void RecordResult(bool bImported);
+
+    bool ShouldCreateMaterials() const { return bCreateMaterials; }
+    int32 GetNumFiles() const { return Filenames.Num(); }
+    int32 GetNumSkipped() const { return NumSkipped; }
+    int32 GetNumImported() const { return NumImported; }
+    int32 GetNumFailed() const { return NumFailed; }
+    double GetElapsedSeconds() const;
+
+private:
+    static void DecodeFile(FFile& File);
+
+    TArray<FString> Filenames;
+    TArray<FString> AssetNames;
+    bool bCreateMaterials = false;
+
+    // Files are handed to the workers in batches of at most this size
+    int32 MaxBatchSize = 0;
+    int32 NextFile = 0;
+
+    // Bytes the decoded files waiting for import may take, and the largest decoded file so far
+    int64 MemoryBudget = 0;
+    int64 BytesPerFile = 0;
+    int64 DecodedBytes = 0;
+
+    // Batch being decoded on the worker threads
+    TFuture<TArray<FFile>> DecodingBatch;
+
+    // Decoded files waiting for import, entries before FirstDecoded were already popped
+    TArray<FFile> Decoded;
+    int32 FirstDecoded = 0;
+
+    int32 NumSkipped = 0;
+    int32 NumImported = 0;
+    int32 NumFailed = 0;
+    double StartTime = 0.0;
+};
@@ -0,0 +1,132 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Subsystems/GenerationResultPipeline.h"
+#include "TextureGeneratorModule.h"
+#include "TextureGeneratorSettings.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/EngineVersionComparison.h"
+#include "Misc/FileHelper.h"
+
+FGenerationResultPipeline::FGenerationResultPipeline(const FString& InSpillDirectory)
+    : SpillDirectory(InSpillDirectory)
+{
+    // Spilled results never outlive the editor session, anything left over is from a crash
+    IFileManager::Get().DeleteDirectory(*SpillDirectory, false, true);
+    IFileManager::Get().MakeDirectory(*SpillDirectory, true);
+}
+
+FGenerationResultPipeline::~FGenerationResultPipeline()
+{
+    for (int32 Index = FirstResult; Index < Results.Num(); ++Index)
+    {
+        if (Results[Index].bOwnsFile)
+        {
+            IFileManager::Get().Delete(*Results[Index].Filename, false, false, true);
+        }
+    }
+}
+
+void FGenerationResultPipeline::Add(const FGuid& JobId, const TArray<uint8>& ImageData, const FString& StoredFilename)
+{
+    FResult& Result = Results.AddDefaulted_GetRef();
+    Result.JobId = JobId;
+
+    if (MemoryBytes + HeldBytes + ImageData.Num() <= GetMemoryBudget())
+    {
+        Result.ImageData = ImageData;
+        MemoryBytes += ImageData.Num();
+        return;
+    }
+
+    if (!StoredFilename.IsEmpty())
+    {
+        Result.Filename = StoredFilename;
+    }
+    else
+    {
+        Result.Filename = SpillDirectory / JobId.ToString() + TEXT(".png");
+        Result.bOwnsFile = true;
+
+        if (!FFileHelper::SaveArrayToFile(ImageData, *Result.Filename))
+        {
+            // Keep the result rather than losing an image which was paid for
+            UE_LOG(LogTextureGenerator, Warning, TEXT("Failed to spill generation result to %s, keeping it in memory."), *Result.Filename);
+            Result.Filename.Reset();
+            Result.bOwnsFile = false;
+            Result.ImageData = ImageData;
+            MemoryBytes += ImageData.Num();
+            return;
+        }
+    }
+
+    Result.FileSize = ImageData.Num();
+    SpilledBytes += Result.FileSize;
+}
+
+void FGenerationResultPipeline::AddStored(const FGuid& JobId, const FString& StoredFilename)
+{
+    FResult& Result = Results.AddDefaulted_GetRef();
+    Result.JobId = JobId;
+    Result.Filename = StoredFilename;
+    Result.FileSize = FMath::Max<int64>(IFileManager::Get().FileSize(*StoredFilename), 0);
+    SpilledBytes += Result.FileSize;
+}
+
+bool FGenerationResultPipeline::Pop(FGuid& OutJobId, TArray<uint8>& OutImageData)
+{
+    if (IsEmpty())
+    {
+        return false;
+    }
+
+    FResult Result = MoveTemp(Results[FirstResult++]);
+
+    // Compact once the consumed part dominates, so popping stays cheap for long batches
+    if (FirstResult == Results.Num())
+    {
+        Results.Reset();
+        FirstResult = 0;
+    }
+    else if (FirstResult > 64 && FirstResult * 2 > Results.Num())
+    {
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+        Results.RemoveAt(0, FirstResult, false);
+#else
+        Results.RemoveAt(0, FirstResult, EAllowShrinking::No);
+#endif
+        FirstResult = 0;
+    }
+
+    OutJobId = Result.JobId;
+
+    if (Result.Filename.IsEmpty())
+    {
+        MemoryBytes -= Result.ImageData.Num();
+        OutImageData = MoveTemp(Result.ImageData);
+        return true;
+    }
+
+    SpilledBytes -= Result.FileSize;
+    const bool bLoaded = FFileHelper::LoadFileToArray(OutImageData, *Result.Filename);
+    if (Result.bOwnsFile)
+    {
+        IFileManager::Get().Delete(*Result.Filename, false, false, true);
+    }
+    return bLoaded;
+}
+
+bool FGenerationResultPipeline::HasCapacity() const
+{
+    return MemoryBytes + HeldBytes < GetMemoryBudget() || SpilledBytes < GetSpillBudget();
+}
+
+int64 FGenerationResultPipeline::GetMemoryBudget() const
+{
+    return static_cast<int64>(GetDefault<UTextureGeneratorSettings>()->ResultMemoryBudgetMB) * 1024 * 1024;
+}
+
+int64 FGenerationResultPipeline::GetSpillBudget() const
+{
+    return static_cast<int64>(GetDefault<UTextureGeneratorSettings>()->ResultSpillBudgetMB) * 1024 * 1024;
+}
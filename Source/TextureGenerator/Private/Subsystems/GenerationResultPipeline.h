@@ -0,0 +1,74 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FIFO of received images waiting to be imported, bounded by a memory budget.
+ * Results past the memory budget are spilled to disk in their compressed form,
+ * and once the spill budget is used up as well the pipeline reports it cannot take more results,
+ * so the producer stops issuing requests until the importer catches up.
+ */
+class FGenerationResultPipeline
+{
+public:
+    explicit FGenerationResultPipeline(const FString& InSpillDirectory);
+    ~FGenerationResultPipeline();
+
+    /**
+     * Adds a received image.
+     * @param JobId Job the image belongs to
+     * @param ImageData Compressed image data
+     * @param StoredFilename File already holding the same data, used instead of spilling a copy when over budget
+     */
+    void Add(const FGuid& JobId, const TArray<uint8>& ImageData, const FString& StoredFilename = FString());
+
+    /** Adds an image which only exists on disk. The file is left in place once consumed. */
+    void AddStored(const FGuid& JobId, const FString& StoredFilename);
+
+    /** Pops the oldest result. Returns false when empty, or when a spilled result could not be read back. */
+    bool Pop(FGuid& OutJobId, TArray<uint8>& OutImageData);
+
+    /** Whether results can still be added without exceeding the memory and spill budgets. */
+    bool HasCapacity() const;
+
+    /**
+     * Sets the memory of results held outside the pipeline, e.g. decoded images or sets waiting for the rest of their jobs.
+     * It counts against the memory budget, so new results are spilled and requests held back while it is large.
+     */
+    void SetHeldBytes(int64 Bytes) { HeldBytes = Bytes; }
+
+    bool IsEmpty() const { return Num() == 0; }
+    int32 Num() const { return Results.Num() - FirstResult; }
+
+    int64 GetMemoryBytes() const { return MemoryBytes; }
+    int64 GetSpilledBytes() const { return SpilledBytes; }
+
+private:
+    struct FResult
+    {
+        FGuid JobId;
+        TArray<uint8> ImageData;
+
+        // Set when the data lives on disk instead of memory
+        FString Filename;
+        int64 FileSize = 0;
+
+        // Whether the file was written by the pipeline and must be deleted once consumed
+        bool bOwnsFile = false;
+    };
+
+    int64 GetMemoryBudget() const;
+    int64 GetSpillBudget() const;
+
+    FString SpillDirectory;
+
+    // Queued results, entries before FirstResult were already consumed
+    TArray<FResult> Results;
+    int32 FirstResult = 0;
+
+    int64 MemoryBytes = 0;
+    int64 SpilledBytes = 0;
+    int64 HeldBytes = 0;
+};
@@ -0,0 +1,411 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Subsystems/GenerationTelemetry.h"
+#include "TextureGeneratorModule.h"
+
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace GenerationTelemetry
+{
+    struct FStep
+    {
+        const TCHAR* Name;
+        double FTextureGenerationJobTimings::* Seconds;
+    };
+
+    static const FStep Steps[] =
+    {
+        { TEXT("queue"), &FTextureGenerationJobTimings::QueueSeconds },
+        { TEXT("encode"), &FTextureGenerationJobTimings::EncodeSeconds },
+        { TEXT("upload"), &FTextureGenerationJobTimings::UploadSeconds },
+        { TEXT("server"), &FTextureGenerationJobTimings::ServerSeconds },
+        { TEXT("download"), &FTextureGenerationJobTimings::DownloadSeconds },
+        { TEXT("decode"), &FTextureGenerationJobTimings::DecodeSeconds },
+        { TEXT("import"), &FTextureGenerationJobTimings::ImportSeconds },
+        { TEXT("save"), &FTextureGenerationJobTimings::SaveSeconds },
+    };
+    static constexpr int32 NumSteps = UE_ARRAY_COUNT(Steps);
+
+    static const TCHAR* FilePrefix = TEXT("Telemetry-");
+
+    // One file per month, the names sort chronologically
+    static FString GetFilename(const FDateTime& Time)
+    {
+        return FString::Printf(TEXT("%s%04d-%02d.jsonl"), FilePrefix, Time.GetYear(), Time.GetMonth());
+    }
+
+    template <typename EnumType>
+    static FString GetEnumName(EnumType Value)
+    {
+        return StaticEnum<EnumType>()->GetNameStringByValue(static_cast<int64>(Value));
+    }
+
+    template <typename EnumType>
+    static bool ParseEnumName(const FString& Name, EnumType& OutValue)
+    {
+        const int64 Value = StaticEnum<EnumType>()->GetValueByNameString(Name);
+        if (Value == INDEX_NONE)
+        {
+            return false;
+        }
+        OutValue = static_cast<EnumType>(Value);
+        return true;
+    }
+
+    // Nearest rank percentile of sorted values, negative without values
+    static double GetPercentile(const TArray<double>& Sorted, double Percentile)
+    {
+        if (Sorted.IsEmpty())
+        {
+            return -1.0;
+        }
+
+        const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+        return Sorted[Index];
+    }
+
+    // Jobs of one model, over the whole history or a single day
+    struct FGroup
+    {
+        EImageGenerationModel Model = EImageGenerationModel::StableImageCore;
+        FString Day;
+
+        int32 NumJobs = 0;
+        int32 NumCompleted = 0;
+        int32 NumFailed = 0;
+        int32 NumHedged = 0;
+        int64 BytesSent = 0;
+        int64 BytesReceived = 0;
+
+        // From submission to end of every job, throughput is measured over the time at least one was in flight,
+        // so idle hours between sessions don't dilute it
+        TArray<TPair<FDateTime, FDateTime>> Intervals;
+        FTimespan BusyTime;
+
+        // Of completed jobs only, failures often return early and would flatter the latency
+        TArray<double> TotalSeconds;
+        TArray<double> ServerSeconds;
+
+        double StepTotals[NumSteps] = {};
+        int32 StepCounts[NumSteps] = {};
+
+        double GetImagesPerHour() const
+        {
+            const double BusyHours = FMath::Max(BusyTime.GetTotalMinutes(), 1.0) / 60.0;
+            return NumCompleted / BusyHours;
+        }
+
+        double GetMeanStep(int32 StepIndex) const
+        {
+            return StepCounts[StepIndex] > 0 ? StepTotals[StepIndex] / StepCounts[StepIndex] : -1.0;
+        }
+    };
+
+    static void AddToGroup(FGroup& Group, const FGenerationTelemetry::FRecord& Record)
+    {
+        ++Group.NumJobs;
+        Group.NumHedged += Record.Timings.bHedged ? 1 : 0;
+        Group.BytesSent += Record.Timings.BytesSent;
+        Group.BytesReceived += Record.Timings.BytesReceived;
+
+        const FTimespan Duration = FTimespan::FromSeconds(FMath::Max(Record.TotalSeconds, 0.0));
+        Group.Intervals.Emplace(Record.FinishedAt - Duration, Record.FinishedAt);
+
+        if (Record.Outcome == ETextureGenerationJobState::Failed)
+        {
+            ++Group.NumFailed;
+        }
+        if (Record.Outcome != ETextureGenerationJobState::Completed)
+        {
+            return;
+        }
+
+        ++Group.NumCompleted;
+        if (Record.TotalSeconds >= 0.0)
+        {
+            Group.TotalSeconds.Add(Record.TotalSeconds);
+        }
+        if (Record.Timings.ServerSeconds >= 0.0)
+        {
+            Group.ServerSeconds.Add(Record.Timings.ServerSeconds);
+        }
+
+        for (int32 StepIndex = 0; StepIndex < NumSteps; ++StepIndex)
+        {
+            const double Seconds = Record.Timings.*Steps[StepIndex].Seconds;
+            if (Seconds >= 0.0)
+            {
+                Group.StepTotals[StepIndex] += Seconds;
+                ++Group.StepCounts[StepIndex];
+            }
+        }
+    }
+
+    // Length of the union of the intervals, overlapping jobs count once
+    static FTimespan GetBusyTime(TArray<TPair<FDateTime, FDateTime>>& Intervals)
+    {
+        Intervals.Sort([](const TPair<FDateTime, FDateTime>& A, const TPair<FDateTime, FDateTime>& B)
+        {
+            return A.Key < B.Key;
+        });
+
+        FTimespan BusyTime;
+        FDateTime CoveredUntil = FDateTime::MinValue();
+        for (const TPair<FDateTime, FDateTime>& Interval : Intervals)
+        {
+            const FDateTime Start = FMath::Max(Interval.Key, CoveredUntil);
+            if (Interval.Value > Start)
+            {
+                BusyTime += Interval.Value - Start;
+                CoveredUntil = Interval.Value;
+            }
+        }
+        return BusyTime;
+    }
+
+    // Groups per model, followed by the groups per model and day when requested
+    static TArray<FGroup> Aggregate(const TArray<FGenerationTelemetry::FRecord>& Records, bool bPerDay)
+    {
+        TMap<FString, FGroup> Groups;
+        for (const FGenerationTelemetry::FRecord& Record : Records)
+        {
+            FGroup& ModelGroup = Groups.FindOrAdd(GetEnumName(Record.Model));
+            ModelGroup.Model = Record.Model;
+            AddToGroup(ModelGroup, Record);
+
+            if (bPerDay)
+            {
+                const FString Day = Record.FinishedAt.ToString(TEXT("%Y-%m-%d"));
+                FGroup& DayGroup = Groups.FindOrAdd(GetEnumName(Record.Model) + TEXT("|") + Day);
+                DayGroup.Model = Record.Model;
+                DayGroup.Day = Day;
+                AddToGroup(DayGroup, Record);
+            }
+        }
+
+        TArray<FGroup> Result;
+        Groups.GenerateValueArray(Result);
+        Result.Sort([](const FGroup& A, const FGroup& B)
+        {
+            if (A.Day.IsEmpty() != B.Day.IsEmpty())
+            {
+                return A.Day.IsEmpty();
+            }
+            return A.Model != B.Model ? A.Model < B.Model : A.Day < B.Day;
+        });
+
+        for (FGroup& Group : Result)
+        {
+            Group.TotalSeconds.Sort();
+            Group.ServerSeconds.Sort();
+            Group.BusyTime = GetBusyTime(Group.Intervals);
+            Group.Intervals.Empty();
+        }
+        return Result;
+    }
+
+    static FString FormatSeconds(double Seconds)
+    {
+        return Seconds >= 0.0 ? FString::Printf(TEXT("%.1f"), Seconds) : FString(TEXT("-"));
+    }
+
+    // Missing values are left empty, spreadsheets would otherwise average them in
+    static FString FormatCsvValue(double Value, int32 Precision)
+    {
+        return Value >= 0.0 ? FString::Printf(TEXT("%.*f"), Precision, Value) : FString();
+    }
+}
+
+FGenerationTelemetry::FGenerationTelemetry(const FString& InDirectory)
+    : Directory(InDirectory)
+{
+    IFileManager::Get().MakeDirectory(*Directory, true);
+}
+
+FString FGenerationTelemetry::GetDefaultDirectory()
+{
+    return FPaths::ProjectSavedDir() / TEXT("TextureGenerator") / TEXT("Telemetry");
+}
+
+void FGenerationTelemetry::Record(const FTextureGenerationJobInfo& Job)
+{
+    using namespace GenerationTelemetry;
+
+    const FTextureGenerationJobTimings& Timings = Job.Timings;
+    const FDateTime Now = FDateTime::UtcNow();
+
+    TSharedRef<FJsonObject> Record = MakeShared<FJsonObject>();
+    Record->SetStringField(TEXT("job"), Job.JobId.ToString());
+    Record->SetStringField(TEXT("finished"), Now.ToIso8601());
+    Record->SetStringField(TEXT("model"), GetEnumName(Job.Model));
+    Record->SetStringField(TEXT("outcome"), GetEnumName(Job.State));
+    Record->SetNumberField(TEXT("width"), Timings.Width);
+    Record->SetNumberField(TEXT("height"), Timings.Height);
+    Record->SetNumberField(TEXT("sent"), static_cast<double>(Timings.BytesSent));
+    Record->SetNumberField(TEXT("received"), static_cast<double>(Timings.BytesReceived));
+    Record->SetBoolField(TEXT("hedged"), Timings.bHedged);
+
+    if (Timings.SubmitTime > 0.0)
+    {
+        Record->SetNumberField(TEXT("total"), FPlatformTime::Seconds() - Timings.SubmitTime);
+    }
+
+    // Steps the job did not go through are left out
+    for (const FStep& Step : Steps)
+    {
+        const double Seconds = Timings.*Step.Seconds;
+        if (Seconds >= 0.0)
+        {
+            Record->SetNumberField(Step.Name, Seconds);
+        }
+    }
+
+    FString Line;
+    TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Line);
+    FJsonSerializer::Serialize(Record, Writer);
+    Line.AppendChar(TEXT('\n'));
+
+    FFileHelper::SaveStringToFile(Line, *(Directory / GetFilename(Now)),
+        FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append);
+}
+
+void FGenerationTelemetry::AddRequestTimings(FTextureGenerationJobTimings& Timings, const FStabilityRequestTimings& RequestTimings)
+{
+    if (RequestTimings.CompletedTime <= 0.0)
+    {
+        return;
+    }
+
+    Timings.UploadSeconds = RequestTimings.UploadedTime - RequestTimings.SendTime;
+    Timings.ServerSeconds = RequestTimings.FirstByteTime - RequestTimings.UploadedTime;
+    Timings.DownloadSeconds = RequestTimings.CompletedTime - RequestTimings.FirstByteTime;
+    Timings.BytesSent += RequestTimings.BytesSent;
+    Timings.BytesReceived += RequestTimings.BytesReceived;
+}
+
+TArray<FGenerationTelemetry::FRecord> FGenerationTelemetry::Load(const FString& Directory, const FDateTime& Since)
+{
+    using namespace GenerationTelemetry;
+
+    TArray<FString> Files;
+    IFileManager::Get().FindFiles(Files, *(Directory / FString(FilePrefix) + TEXT("*.jsonl")), true, false);
+    Files.Sort();
+
+    // Months before the requested range are not read at all
+    const FString FirstFile = GetFilename(Since);
+
+    TArray<FRecord> Records;
+    for (const FString& File : Files)
+    {
+        if (File < FirstFile)
+        {
+            continue;
+        }
+
+        TArray<FString> Lines;
+        FFileHelper::LoadFileToStringArray(Lines, *(Directory / File));
+
+        for (const FString& Line : Lines)
+        {
+            TSharedPtr<FJsonObject> Object;
+            TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Line);
+            if (!FJsonSerializer::Deserialize(Reader, Object) || !Object.IsValid())
+            {
+                // A crash in the middle of a write leaves a truncated last line behind
+                continue;
+            }
+
+            FRecord Record;
+            if (!FDateTime::ParseIso8601(*Object->GetStringField(TEXT("finished")), Record.FinishedAt)
+                || Record.FinishedAt < Since
+                || !ParseEnumName(Object->GetStringField(TEXT("model")), Record.Model)
+                || !ParseEnumName(Object->GetStringField(TEXT("outcome")), Record.Outcome))
+            {
+                continue;
+            }
+
+            FTextureGenerationJobTimings& Timings = Record.Timings;
+            Object->TryGetNumberField(TEXT("total"), Record.TotalSeconds);
+            Object->TryGetNumberField(TEXT("width"), Timings.Width);
+            Object->TryGetNumberField(TEXT("height"), Timings.Height);
+            Object->TryGetNumberField(TEXT("sent"), Timings.BytesSent);
+            Object->TryGetNumberField(TEXT("received"), Timings.BytesReceived);
+            Object->TryGetBoolField(TEXT("hedged"), Timings.bHedged);
+            for (const FStep& Step : Steps)
+            {
+                Object->TryGetNumberField(Step.Name, Timings.*Step.Seconds);
+            }
+
+            Records.Add(MoveTemp(Record));
+        }
+    }
+
+    return Records;
+}
+
+FString FGenerationTelemetry::FormatReport(const TArray<FRecord>& Records, bool bPerDay)
+{
+    using namespace GenerationTelemetry;
+
+    FString Report = FString::Printf(TEXT("%-18s %-10s %6s %6s %6s %6s %9s %7s %7s %7s %10s %10s %10s\n"),
+        TEXT("Model"), TEXT("Day"), TEXT("Jobs"), TEXT("Done"), TEXT("Failed"), TEXT("Hedged"), TEXT("Images/h"),
+        TEXT("p50 s"), TEXT("p95 s"), TEXT("p99 s"), TEXT("Server p50"), TEXT("Server p95"), TEXT("Server p99"));
+
+    for (const FGroup& Group : Aggregate(Records, bPerDay))
+    {
+        Report += FString::Printf(TEXT("%-18s %-10s %6d %6d %6d %6d %9.1f %7s %7s %7s %10s %10s %10s\n"),
+            *GetEnumName(Group.Model), Group.Day.IsEmpty() ? TEXT("all") : *Group.Day,
+            Group.NumJobs, Group.NumCompleted, Group.NumFailed, Group.NumHedged, Group.GetImagesPerHour(),
+            *FormatSeconds(GetPercentile(Group.TotalSeconds, 0.5)),
+            *FormatSeconds(GetPercentile(Group.TotalSeconds, 0.95)),
+            *FormatSeconds(GetPercentile(Group.TotalSeconds, 0.99)),
+            *FormatSeconds(GetPercentile(Group.ServerSeconds, 0.5)),
+            *FormatSeconds(GetPercentile(Group.ServerSeconds, 0.95)),
+            *FormatSeconds(GetPercentile(Group.ServerSeconds, 0.99)));
+    }
+
+    return Report;
+}
+
+FString FGenerationTelemetry::ToCsv(const TArray<FRecord>& Records, bool bPerDay)
+{
+    using namespace GenerationTelemetry;
+
+    FString Csv = TEXT("Model,Day,Jobs,Completed,Failed,Hedged,ImagesPerHour,P50Seconds,P95Seconds,P99Seconds,ServerP50Seconds,ServerP95Seconds,ServerP99Seconds,MBSent,MBReceived");
+    for (const FStep& Step : Steps)
+    {
+        Csv += FString::Printf(TEXT(",Mean_%s"), Step.Name);
+    }
+    Csv += TEXT("\n");
+
+    for (const FGroup& Group : Aggregate(Records, bPerDay))
+    {
+        Csv += FString::Printf(TEXT("%s,%s,%d,%d,%d,%d,%.2f"),
+            *GetEnumName(Group.Model), Group.Day.IsEmpty() ? TEXT("all") : *Group.Day,
+            Group.NumJobs, Group.NumCompleted, Group.NumFailed, Group.NumHedged, Group.GetImagesPerHour());
+
+        for (const TArray<double>* Sorted : { &Group.TotalSeconds, &Group.ServerSeconds })
+        {
+            for (const double Percentile : { 0.5, 0.95, 0.99 })
+            {
+                Csv += TEXT(",") + FormatCsvValue(GetPercentile(*Sorted, Percentile), 2);
+            }
+        }
+
+        Csv += FString::Printf(TEXT(",%.2f,%.2f"), Group.BytesSent / (1024.0 * 1024.0), Group.BytesReceived / (1024.0 * 1024.0));
+        for (int32 StepIndex = 0; StepIndex < NumSteps; ++StepIndex)
+        {
+            Csv += TEXT(",") + FormatCsvValue(Group.GetMeanStep(StepIndex), 3);
+        }
+        Csv += TEXT("\n");
+    }
+
+    return Csv;
+}
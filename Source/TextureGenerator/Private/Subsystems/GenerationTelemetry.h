@@ -0,0 +1,53 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/TextureGenerationTypes.h"
+
+/**
+ * Persistent history of finished generation jobs, for capacity planning and spotting slowdowns of the provider.
+ * Every job appends one JSON line with its outcome, model, resolution, byte counts and the duration of each step,
+ * to one file per month so old history can be archived or deleted by hand.
+ */
+class FGenerationTelemetry
+{
+public:
+    /** A finished job as read back from the history */
+    struct FRecord
+    {
+        FDateTime FinishedAt;
+        EImageGenerationModel Model = EImageGenerationModel::StableImageCore;
+        ETextureGenerationJobState Outcome = ETextureGenerationJobState::Completed;
+
+        // From submission to the end of the job, including the save of completed jobs
+        double TotalSeconds = -1.0;
+        FTextureGenerationJobTimings Timings;
+    };
+
+    explicit FGenerationTelemetry(const FString& InDirectory);
+
+    /** Directory the subsystem records telemetry to. */
+    static FString GetDefaultDirectory();
+
+    /** Appends a finished job to the history. */
+    void Record(const FTextureGenerationJobInfo& Job);
+
+    /** Fills the upload, server and download steps and byte counts of a job from the timings of its HTTP request. */
+    static void AddRequestTimings(FTextureGenerationJobTimings& Timings, const FStabilityRequestTimings& RequestTimings);
+
+    /** Reads every job which finished at or after the given time, in the order they were recorded. */
+    static TArray<FRecord> Load(const FString& Directory, const FDateTime& Since);
+
+    /**
+     * Formats a plain text table of job counts, throughput and p50/p95/p99 latencies per model,
+     * and additionally per model and day when requested.
+     */
+    static FString FormatReport(const TArray<FRecord>& Records, bool bPerDay);
+
+    /** Writes the same aggregates as FormatReport as CSV, with the mean duration of every step. */
+    static FString ToCsv(const TArray<FRecord>& Records, bool bPerDay);
+
+private:
+    FString Directory;
+};
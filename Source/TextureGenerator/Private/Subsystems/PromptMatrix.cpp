@@ -0,0 +1,256 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Subsystems/PromptMatrix.h"
+
+namespace PromptMatrix
+{
+    // Uniform index in [0, Max], the modulo bias is negligible for any matrix that fits in memory anyway
+    static int64 RandRange(FRandomStream& Random, int64 Max)
+    {
+        const uint64 Value = (static_cast<uint64>(Random.GetUnsignedInt()) << 32) | Random.GetUnsignedInt();
+        return static_cast<int64>(Value % (static_cast<uint64>(Max) + 1));
+    }
+
+    template <typename ElementType>
+    static void Shuffle(FRandomStream& Random, TArray<ElementType>& Array)
+    {
+        for (int32 Index = Array.Num() - 1; Index > 0; --Index)
+        {
+            Array.Swap(Index, Random.RandRange(0, Index));
+        }
+    }
+
+    // Asset name part of an option, "mossy stone" becomes MossyStone. Options without letters or digits, e.g. the empty
+    // option of "{|weathered }", get a placeholder so every axis keeps its place in the name and combinations don't collide
+    static FString MakeNameToken(const FString& Option, int32 OptionIndex)
+    {
+        FString Token;
+        bool bStartOfWord = true;
+        for (const TCHAR Character : Option)
+        {
+            if (!FChar::IsAlnum(Character))
+            {
+                bStartOfWord = true;
+                continue;
+            }
+
+            Token.AppendChar(bStartOfWord ? FChar::ToUpper(Character) : Character);
+            bStartOfWord = false;
+        }
+
+        if (Token.IsEmpty())
+        {
+            Token = Option.TrimStartAndEnd().IsEmpty() ? FString(TEXT("None")) : FString::Printf(TEXT("Option%d"), OptionIndex + 1);
+        }
+        return Token;
+    }
+}
+
+TSharedPtr<FPromptMatrix> FPromptMatrix::Create(const FTextureGenerationRequest& Request, const TArray<EStylePreset>& StylePresets,
+    int32 NumSamples, EPromptMatrixSampling Sampling, FString& OutError)
+{
+    TSharedPtr<FPromptMatrix> Matrix(new FPromptMatrix());
+    Matrix->Request = Request;
+    Matrix->StylePresets = StylePresets;
+
+    const FString& Template = Request.Prompt;
+    FString Literal;
+    int32 Position = 0;
+    while (Position < Template.Len())
+    {
+        if (Template[Position] != TEXT('{'))
+        {
+            Literal.AppendChar(Template[Position++]);
+            continue;
+        }
+
+        const int32 Close = Template.Find(TEXT("}"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Position + 1);
+        const int32 NestedOpen = Template.Find(TEXT("{"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Position + 1);
+        if (Close == INDEX_NONE || (NestedOpen != INDEX_NONE && NestedOpen < Close))
+        {
+            OutError = FString::Printf(TEXT("The brace at character %d of the prompt template is not closed."), Position + 1);
+            return nullptr;
+        }
+
+        // Empty options are kept, "{|weathered }wall" makes a word optional
+        TArray<FString> Options;
+        Template.Mid(Position + 1, Close - Position - 1).ParseIntoArray(Options, TEXT("|"), false);
+        if (Options.Num() == 0)
+        {
+            Options.Add(FString());
+        }
+
+        if (!Literal.IsEmpty())
+        {
+            Matrix->Segments.Add({ MoveTemp(Literal), INDEX_NONE });
+            Literal.Reset();
+        }
+        Matrix->Segments.Add({ FString(), Matrix->Axes.Num() });
+        Matrix->Axes.Add(MoveTemp(Options));
+        Position = Close + 1;
+    }
+
+    if (!Literal.IsEmpty())
+    {
+        Matrix->Segments.Add({ MoveTemp(Literal), INDEX_NONE });
+    }
+
+    if (StylePresets.Num() > 0)
+    {
+        Matrix->StyleAxis = Matrix->Axes.Num();
+        TArray<FString>& StyleNames = Matrix->Axes.AddDefaulted_GetRef();
+        for (const EStylePreset Style : StylePresets)
+        {
+            StyleNames.Add(StaticEnum<EStylePreset>()->GetNameStringByValue(static_cast<int64>(Style)));
+        }
+    }
+
+    // Options which only differ in case or punctuation, e.g. {Brick|brick}, get their option number appended,
+    // otherwise one combination would overwrite the asset of another
+    for (const TArray<FString>& Options : Matrix->Axes)
+    {
+        TArray<FString>& Tokens = Matrix->NameTokens.AddDefaulted_GetRef();
+        TMap<FString, int32> NumUses;
+        for (int32 OptionIndex = 0; OptionIndex < Options.Num(); ++OptionIndex)
+        {
+            ++NumUses.FindOrAdd(Tokens.Add_GetRef(PromptMatrix::MakeNameToken(Options[OptionIndex], OptionIndex)));
+        }
+        for (int32 OptionIndex = 0; OptionIndex < Options.Num(); ++OptionIndex)
+        {
+            if (NumUses.FindChecked(Tokens[OptionIndex]) > 1)
+            {
+                Tokens[OptionIndex] += FString::FromInt(OptionIndex + 1);
+            }
+        }
+    }
+
+    for (const TArray<FString>& Options : Matrix->Axes)
+    {
+        if (Matrix->NumCombinations > MAX_int64 / Options.Num())
+        {
+            OutError = TEXT("The prompt template has more combinations than can be counted.");
+            return nullptr;
+        }
+        Matrix->NumCombinations *= Options.Num();
+    }
+
+    Matrix->bSampled = NumSamples > 0 && NumSamples < Matrix->NumCombinations;
+    Matrix->NumSamples = Matrix->bSampled ? NumSamples : Matrix->NumCombinations;
+    Matrix->Sampling = Sampling;
+    Matrix->Random.Initialize(Request.Seed > 0 ? Request.Seed : FMath::Rand());
+
+    if (!Matrix->bSampled)
+    {
+        return Matrix;
+    }
+
+    if (Sampling == EPromptMatrixSampling::Random)
+    {
+        // Floyd's algorithm draws distinct indices with memory for the sample only, however large the space
+        TSet<int64> Chosen;
+        Chosen.Reserve(NumSamples);
+        for (int64 Candidate = Matrix->NumCombinations - NumSamples; Candidate < Matrix->NumCombinations; ++Candidate)
+        {
+            const int64 Index = PromptMatrix::RandRange(Matrix->Random, Candidate);
+            Chosen.Add(Chosen.Contains(Index) ? Candidate : Index);
+        }
+
+        Matrix->SampledIndices = Chosen.Array();
+        PromptMatrix::Shuffle(Matrix->Random, Matrix->SampledIndices);
+    }
+    else
+    {
+        // Every axis is cut into one stratum per sample, each stratum is used by exactly one sample
+        Matrix->Strata.SetNum(Matrix->Axes.Num());
+        for (TArray<int32>& AxisStrata : Matrix->Strata)
+        {
+            AxisStrata.SetNumUninitialized(NumSamples);
+            for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+            {
+                AxisStrata[Sample] = Sample;
+            }
+            PromptMatrix::Shuffle(Matrix->Random, AxisStrata);
+        }
+    }
+
+    return Matrix;
+}
+
+int64 FPromptMatrix::GetCombinationIndex(int64 Sample)
+{
+    if (!bSampled)
+    {
+        return Sample;
+    }
+
+    if (Sampling == EPromptMatrixSampling::Random)
+    {
+        return SampledIndices[Sample];
+    }
+
+    int64 Index = 0;
+    for (int32 AxisIndex = 0; AxisIndex < Axes.Num(); ++AxisIndex)
+    {
+        const int32 NumOptions = Axes[AxisIndex].Num();
+        const double Position = (Strata[AxisIndex][Sample] + Random.FRand()) / NumSamples;
+        const int32 Option = FMath::Min(FMath::FloorToInt32(Position * NumOptions), NumOptions - 1);
+        Index = Index * NumOptions + Option;
+    }
+
+    // Axes with fewer options than samples repeat options. A repeat is redrawn uniformly from the combinations not issued yet,
+    // there always is one as the sample is smaller than the space, so the sample keeps its size without generating anything twice
+    int32 NumAttempts = 0;
+    while (IssuedIndices.Contains(Index))
+    {
+        Index = ++NumAttempts <= 64 ? PromptMatrix::RandRange(Random, NumCombinations - 1) : (Index + 1) % NumCombinations;
+    }
+
+    IssuedIndices.Add(Index);
+    return Index;
+}
+
+bool FPromptMatrix::Next(FTextureGenerationRequest& OutRequest)
+{
+    if (IsDone())
+    {
+        return false;
+    }
+
+    int64 Index = GetCombinationIndex(NextSample++);
+
+    // Decode the mixed radix index, the last axis changes fastest
+    TArray<int32, TInlineAllocator<8>> Options;
+    Options.SetNumUninitialized(Axes.Num());
+    for (int32 AxisIndex = Axes.Num() - 1; AxisIndex >= 0; --AxisIndex)
+    {
+        Options[AxisIndex] = static_cast<int32>(Index % Axes[AxisIndex].Num());
+        Index /= Axes[AxisIndex].Num();
+    }
+
+    OutRequest = Request;
+    OutRequest.Prompt.Reset();
+    for (const FSegment& Segment : Segments)
+    {
+        OutRequest.Prompt += Segment.AxisIndex == INDEX_NONE ? Segment.Text : Axes[Segment.AxisIndex][Options[Segment.AxisIndex]];
+    }
+    OutRequest.Prompt.TrimStartAndEndInline();
+
+    if (StyleAxis != INDEX_NONE)
+    {
+        OutRequest.StylePreset = StylePresets[Options[StyleAxis]];
+    }
+
+    // Combinations are told apart by their options, e.g. Wall_Brick_Mossy_Photographic
+    TArray<FString> NameParts;
+    if (!Request.AssetName.IsEmpty())
+    {
+        NameParts.Add(Request.AssetName);
+    }
+    for (int32 AxisIndex = 0; AxisIndex < Axes.Num(); ++AxisIndex)
+    {
+        NameParts.Add(NameTokens[AxisIndex][Options[AxisIndex]]);
+    }
+    OutRequest.AssetName = FString::Join(NameParts, TEXT("_"));
+
+    return true;
+}
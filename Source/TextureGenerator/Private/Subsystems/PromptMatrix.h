@@ -0,0 +1,82 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "Subsystems/TextureGenerationTypes.h"
+
+/**
+ * Every combination of the axes of a prompt template, e.g. "{brick|stone|wood} wall, {clean|mossy|burnt}",
+ * optionally times a list of style presets. Combinations are numbered in mixed radix with the last axis changing fastest,
+ * and built one at a time as the queue asks for them, so expanding a matrix holds only its template, never the whole space.
+ * A sample additionally stores its indices, or for a Latin hypercube its strata and the combinations issued so far.
+ * The jobs queued from a matrix are ordinary jobs and stay in the job list once finished, like any other.
+ */
+class FPromptMatrix
+{
+public:
+    /**
+     * Parses the axes of the request's prompt. Braces without a matching closing brace make the template malformed.
+     * @param Request Request shared by every combination, its prompt is the template
+     * @param StylePresets Presets forming one more axis, empty to keep the preset of the request
+     * @param NumSamples Number of combinations to generate, 0 or more than the matrix holds for all of them
+     * @param Sampling How a sample is drawn, seeded by the seed of the request when it has one
+     * @param OutError Reason the template could not be expanded
+     * @return The matrix, null if the template is malformed or has too many combinations
+     */
+    static TSharedPtr<FPromptMatrix> Create(const FTextureGenerationRequest& Request, const TArray<EStylePreset>& StylePresets,
+        int32 NumSamples, EPromptMatrixSampling Sampling, FString& OutError);
+
+    /** Builds the request of the next combination. Returns false once every combination was handed out. */
+    bool Next(FTextureGenerationRequest& OutRequest);
+
+    bool IsDone() const { return NextSample >= NumSamples; }
+
+    /** Size of the whole combination space. */
+    int64 GetNumCombinations() const { return NumCombinations; }
+
+    /** Number of combinations which are generated, the whole space unless sampled. */
+    int64 GetNumSamples() const { return NumSamples; }
+
+    /** Number of combinations handed out so far. */
+    int64 GetNumIssued() const { return NextSample; }
+
+private:
+    FPromptMatrix() = default;
+
+    // Combination index of a sample, a Latin hypercube sample which repeats an earlier one is redrawn
+    int64 GetCombinationIndex(int64 Sample);
+
+    // A literal piece of the template, or a reference to one of its axes
+    struct FSegment
+    {
+        FString Text;
+        int32 AxisIndex = INDEX_NONE;
+    };
+    TArray<FSegment> Segments;
+
+    // Options of every axis in template order, the style presets come last
+    TArray<TArray<FString>> Axes;
+    TArray<EStylePreset> StylePresets;
+    int32 StyleAxis = INDEX_NONE;
+
+    // Asset name part of every option by axis, unique within its axis
+    TArray<TArray<FString>> NameTokens;
+
+    FTextureGenerationRequest Request;
+    int64 NumCombinations = 1;
+    int64 NumSamples = 0;
+    int64 NextSample = 0;
+
+    // Random sample, shuffled so partial runs are as representative as full ones
+    TArray<int64> SampledIndices;
+
+    // Latin hypercube sample, one shuffled stratum per sample and axis
+    TArray<TArray<int32>> Strata;
+    TSet<int64> IssuedIndices;
+
+    bool bSampled = false;
+    EPromptMatrixSampling Sampling = EPromptMatrixSampling::Random;
+    FRandomStream Random;
+};
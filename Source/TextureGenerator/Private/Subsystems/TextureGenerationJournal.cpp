@@ -0,0 +1,241 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Subsystems/TextureGenerationJournal.h"
+#include "TextureGeneratorModule.h"
+
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "JsonObjectConverter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace TextureGenerationJournal
+{
+    static const TCHAR* SubmittedEvent = TEXT("submitted");
+    static const TCHAR* CompletedEvent = TEXT("completed");
+    static const TCHAR* ImportedEvent = TEXT("imported");
+    static const TCHAR* FailedEvent = TEXT("failed");
+    static const TCHAR* CancelledEvent = TEXT("cancelled");
+
+    static FString ToJsonLine(const TSharedRef<FJsonObject>& Record)
+    {
+        FString Line;
+        TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Line);
+        FJsonSerializer::Serialize(Record, Writer);
+        Line.AppendChar(TEXT('\n'));
+        return Line;
+    }
+}
+
+FTextureGenerationJournal::FTextureGenerationJournal(const FString& InDirectory)
+    : Directory(InDirectory)
+    , JournalFilename(InDirectory / TEXT("Journal.jsonl"))
+{
+    IFileManager::Get().MakeDirectory(*Directory, true);
+}
+
+TArray<FTextureGenerationJournal::FRecoveredJob> FTextureGenerationJournal::Recover()
+{
+    using namespace TextureGenerationJournal;
+
+    TArray<FRecoveredJob> Jobs;
+    TMap<FGuid, int32> JobIndices;
+
+    TArray<FString> Lines;
+    FFileHelper::LoadFileToStringArray(Lines, *JournalFilename);
+
+    for (const FString& Line : Lines)
+    {
+        TSharedPtr<FJsonObject> Record;
+        TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Line);
+        if (!FJsonSerializer::Deserialize(Reader, Record) || !Record.IsValid())
+        {
+            // A crash in the middle of a write leaves a truncated last line behind
+            UE_LOG(LogTextureGenerator, Warning, TEXT("Skipping unreadable generation journal record: %s"), *Line);
+            continue;
+        }
+
+        FGuid JobId;
+        if (!FGuid::Parse(Record->GetStringField(TEXT("job")), JobId))
+        {
+            continue;
+        }
+
+        const FString Event = Record->GetStringField(TEXT("event"));
+        if (Event == SubmittedEvent)
+        {
+            const TSharedPtr<FJsonObject>* RequestObject = nullptr;
+            if (!Record->TryGetObjectField(TEXT("request"), RequestObject))
+            {
+                continue;
+            }
+
+            FRecoveredJob Job;
+            Job.JobId = JobId;
+            if (FJsonObjectConverter::JsonObjectToUStruct(RequestObject->ToSharedRef(), &Job.Request))
+            {
+                JobIndices.Add(JobId, Jobs.Add(MoveTemp(Job)));
+            }
+        }
+        else if (const int32* Index = JobIndices.Find(JobId))
+        {
+            if (Event == CompletedEvent)
+            {
+                // Journals written before results were shared stored one file per job, named after the job
+                FRecoveredJob& Job = Jobs[*Index];
+                FString ResultString;
+                if (!Record->TryGetStringField(TEXT("result"), ResultString) || !FGuid::Parse(ResultString, Job.ResultId))
+                {
+                    Job.ResultId = JobId;
+                }
+                Job.bCompleted = FPaths::FileExists(GetStoredResultFilename(Job.ResultId));
+            }
+            else
+            {
+                // Imported, failed and cancelled jobs are done for good
+                Jobs[*Index].JobId.Invalidate();
+            }
+        }
+    }
+
+    Jobs.RemoveAll([](const FRecoveredJob& Job) { return !Job.JobId.IsValid(); });
+
+    for (const FRecoveredJob& Job : Jobs)
+    {
+        if (Job.bCompleted)
+        {
+            JobResults.Add(Job.JobId, Job.ResultId);
+            ++ResultReferences.FindOrAdd(Job.ResultId);
+        }
+    }
+
+    // Compact the journal, so it does not grow forever across sessions
+    FString Compacted;
+    for (const FRecoveredJob& Job : Jobs)
+    {
+        TSharedRef<FJsonObject> Record = MakeShared<FJsonObject>();
+        Record->SetStringField(TEXT("event"), SubmittedEvent);
+        Record->SetStringField(TEXT("job"), Job.JobId.ToString());
+        Record->SetObjectField(TEXT("request"), FJsonObjectConverter::UStructToJsonObject(Job.Request));
+        Compacted += ToJsonLine(Record);
+
+        if (Job.bCompleted)
+        {
+            TSharedRef<FJsonObject> CompletedRecord = MakeShared<FJsonObject>();
+            CompletedRecord->SetStringField(TEXT("event"), CompletedEvent);
+            CompletedRecord->SetStringField(TEXT("job"), Job.JobId.ToString());
+            CompletedRecord->SetStringField(TEXT("result"), Job.ResultId.ToString());
+            Compacted += ToJsonLine(CompletedRecord);
+        }
+    }
+
+    // Write next to the journal and swap, so a crash here never loses the previous journal
+    const FString TempFilename = JournalFilename + TEXT(".tmp");
+    if (FFileHelper::SaveStringToFile(Compacted, *TempFilename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+    {
+        IFileManager::Get().Move(*JournalFilename, *TempFilename, true);
+    }
+
+    if (Jobs.Num() > 0)
+    {
+        UE_LOG(LogTextureGenerator, Log, TEXT("Recovered %d unfinished texture generation jobs from the journal."), Jobs.Num());
+    }
+
+    return Jobs;
+}
+
+void FTextureGenerationJournal::RecordSubmitted(const FGuid& JobId, const FTextureGenerationRequest& Request)
+{
+    TSharedRef<FJsonObject> Record = MakeShared<FJsonObject>();
+    Record->SetStringField(TEXT("event"), TextureGenerationJournal::SubmittedEvent);
+    Record->SetStringField(TEXT("job"), JobId.ToString());
+    Record->SetObjectField(TEXT("request"), FJsonObjectConverter::UStructToJsonObject(Request));
+    AppendRecord(Record);
+}
+
+bool FTextureGenerationJournal::RecordCompleted(const FGuid& JobId, const FGuid& ResultId, const TArray<uint8>& ImageData)
+{
+    // The image must be on disk before the record claims the job is completed, coalesced jobs find it already there
+    int32* References = ResultReferences.Find(ResultId);
+    if (!References)
+    {
+        if (!FFileHelper::SaveArrayToFile(ImageData, *GetStoredResultFilename(ResultId)))
+        {
+            UE_LOG(LogTextureGenerator, Warning, TEXT("Failed to store the result of job %s in the generation journal."), *JobId.ToString());
+            return false;
+        }
+        References = &ResultReferences.Add(ResultId, 0);
+    }
+    ++(*References);
+    JobResults.Add(JobId, ResultId);
+
+    TSharedRef<FJsonObject> Record = MakeShared<FJsonObject>();
+    Record->SetStringField(TEXT("event"), TextureGenerationJournal::CompletedEvent);
+    Record->SetStringField(TEXT("job"), JobId.ToString());
+    Record->SetStringField(TEXT("result"), ResultId.ToString());
+    return AppendRecord(Record);
+}
+
+void FTextureGenerationJournal::RecordImported(const FGuid& JobId)
+{
+    TSharedRef<FJsonObject> Record = MakeShared<FJsonObject>();
+    Record->SetStringField(TEXT("event"), TextureGenerationJournal::ImportedEvent);
+    Record->SetStringField(TEXT("job"), JobId.ToString());
+    AppendRecord(Record);
+
+    ReleaseResult(JobId);
+}
+
+void FTextureGenerationJournal::RecordAbandoned(const FGuid& JobId, ETextureGenerationJobState State)
+{
+    TSharedRef<FJsonObject> Record = MakeShared<FJsonObject>();
+    Record->SetStringField(TEXT("event"), State == ETextureGenerationJobState::Cancelled
+        ? TextureGenerationJournal::CancelledEvent
+        : TextureGenerationJournal::FailedEvent);
+    Record->SetStringField(TEXT("job"), JobId.ToString());
+    AppendRecord(Record);
+
+    ReleaseResult(JobId);
+}
+
+void FTextureGenerationJournal::ReleaseResult(const FGuid& JobId)
+{
+    FGuid ResultId;
+    if (!JobResults.RemoveAndCopyValue(JobId, ResultId))
+    {
+        return;
+    }
+
+    int32& References = ResultReferences.FindChecked(ResultId);
+    if (--References > 0)
+    {
+        return;
+    }
+
+    ResultReferences.Remove(ResultId);
+    IFileManager::Get().Delete(*GetStoredResultFilename(ResultId), false, false, true);
+}
+
+bool FTextureGenerationJournal::AppendRecord(const TSharedRef<FJsonObject>& Record)
+{
+    return FFileHelper::SaveStringToFile(
+        TextureGenerationJournal::ToJsonLine(Record),
+        *JournalFilename,
+        FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM,
+        &IFileManager::Get(),
+        FILEWRITE_Append);
+}
+
+FString FTextureGenerationJournal::GetResultFilename(const FGuid& JobId) const
+{
+    const FGuid* ResultId = JobResults.Find(JobId);
+    return GetStoredResultFilename(ResultId ? *ResultId : JobId);
+}
+
+FString FTextureGenerationJournal::GetStoredResultFilename(const FGuid& ResultId) const
+{
+    return Directory / TEXT("Results") / ResultId.ToString() + TEXT(".png");
+}
@@ -0,0 +1,68 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/TextureGenerationTypes.h"
+
+/**
+ * Append-only on-disk record of generation jobs, used to resume batches after the editor was closed or crashed.
+ * Every state change is appended as a single JSON line, received images are stored next to the journal
+ * before they are marked as completed, so paid results survive until they are imported.
+ */
+class FTextureGenerationJournal
+{
+public:
+    /** Job which did not reach a terminal state before the journal was closed */
+    struct FRecoveredJob
+    {
+        FGuid JobId;
+        FTextureGenerationRequest Request;
+
+        // Whether the image was received and only the import is missing
+        bool bCompleted = false;
+
+        // Stored result, shared by jobs which received the same response
+        FGuid ResultId;
+    };
+
+    explicit FTextureGenerationJournal(const FString& InDirectory);
+
+    /**
+     * Replays the journal and returns unfinished jobs in submission order.
+     * The journal is compacted afterwards, so it only contains the returned jobs.
+     */
+    TArray<FRecoveredJob> Recover();
+
+    void RecordSubmitted(const FGuid& JobId, const FTextureGenerationRequest& Request);
+
+    /**
+     * Stores the received image on disk, then records the job as completed.
+     * Jobs coalesced into one request pass the same result identifier and share a single stored copy.
+     */
+    bool RecordCompleted(const FGuid& JobId, const FGuid& ResultId, const TArray<uint8>& ImageData);
+
+    /** Records the job as imported and removes its stored image once no other job refers to it. */
+    void RecordImported(const FGuid& JobId);
+
+    /** Records a failed or cancelled job and removes its stored image once no other job refers to it. */
+    void RecordAbandoned(const FGuid& JobId, ETextureGenerationJobState State);
+
+    /** Returns the file holding the image of a completed job. */
+    FString GetResultFilename(const FGuid& JobId) const;
+
+private:
+    bool AppendRecord(const TSharedRef<FJsonObject>& Record);
+
+    // Drops the reference of a job to its stored result, deleting the file with the last reference
+    void ReleaseResult(const FGuid& JobId);
+
+    FString GetStoredResultFilename(const FGuid& ResultId) const;
+
+    FString Directory;
+    FString JournalFilename;
+
+    // Stored result of every completed job which was not imported yet, and the number of jobs referring to each result
+    TMap<FGuid, FGuid> JobResults;
+    TMap<FGuid, int32> ResultReferences;
+};
@@ -0,0 +1,47 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Subsystems/TextureGenerationTypes.h"
+
+#include "API/ReferenceImageFile.h"
+#include "Engine/Texture2D.h"
+#include "HAL/FileManager.h"
+#include "Misc/SecureHash.h"
+
+FString FTextureGenerationRequest::GetInputFingerprint() const
+{
+    FSHA1 Hash;
+    auto UpdateString = [&Hash](const FString& Str)
+    {
+        FTCHARToUTF8 UTF8String(*Str);
+        Hash.Update(reinterpret_cast<const uint8*>(UTF8String.Get()), UTF8String.Length());
+        // Separator, so that adjacent fields cannot blend into each other
+        const uint8 Separator = 0;
+        Hash.Update(&Separator, 1);
+    };
+
+    // Only the source id of the reference matters, so renaming or moving the reference keeps the fingerprint
+    const FGuid ReferenceId = ReferenceTexture ? ReferenceTexture->Source.GetId() : FGuid();
+
+    UpdateString(FString::Printf(TEXT("%d|%d|%d|%.2f"), static_cast<int32>(Model), Seed, static_cast<int32>(StylePreset), HasReference() ? Strength : 0.0f));
+    UpdateString(Prompt);
+    UpdateString(NegativePrompt);
+    UpdateString(ReferenceId.ToString());
+
+    // Reference files are identified by their size and modification time, hashing their content would read every file on each build
+    if (!ReferenceTexture && !ReferenceImageFile.IsEmpty())
+    {
+        const FFileStatData StatData = IFileManager::Get().GetStatData(*FReferenceImageFile::GetFullPath(ReferenceImageFile));
+        UpdateString(FString::Printf(TEXT("%s|%lld|%s"), *ReferenceImageFile, StatData.FileSize, *StatData.ModificationTime.ToIso8601()));
+    }
+
+    // Only hashed for edits, so the fingerprints of regular requests stay the same
+    if (IsInpainting())
+    {
+        UpdateString(FString::Printf(TEXT("%s|%d|%d"), *MaskTexture->Source.GetId().ToString(), MaskMargin, MaskFeather));
+    }
+    Hash.Final();
+
+    uint8 Digest[FSHA1::DigestSize];
+    Hash.GetHash(Digest);
+    return BytesToHex(Digest, FSHA1::DigestSize);
+}
@@ -0,0 +1,2009 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Subsystems/TextureGeneratorSubsystem.h"
+#include "API/PlaceholderGenerator.h"
+#include "API/ReferenceImageFile.h"
+#include "API/StabilityAPIClient.h"
+#include "Subsystems/FolderIngestion.h"
+#include "Subsystems/GenerationTelemetry.h"
+#include "Subsystems/GenerationResultPipeline.h"
+#include "Subsystems/PromptMatrix.h"
+#include "Subsystems/TextureGenerationJournal.h"
+#include "Subsystems/TextureManifest.h"
+#include "TextureGeneratorModule.h"
+#include "TextureGeneratorSettings.h"
+#include "Utils/InpaintCompositor.h"
+#include "Utils/MaskMapPacker.h"
+#include "Utils/TextureDDCPublisher.h"
+#include "Utils/TextureUtils.h"
+#include "Utils/TiledCompositor.h"
+
+#include "Async/Async.h"
+#include "Editor.h"
+#include "Engine/Texture2D.h"
+#include "Engine/Texture2DArray.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "FileHelpers.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "ImageUtils.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialInstanceConstant.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "ObjectTools.h"
+#include "UObject/SavePackage.h"
+
+void UTextureGeneratorSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    TickHandle = FTSTicker::GetCoreTicker().AddTicker(
+        FTickerDelegate::CreateUObject(this, &UTextureGeneratorSubsystem::Tick));
+
+    ResultPipeline = MakeShared<FGenerationResultPipeline>(FPaths::ProjectSavedDir() / TEXT("TextureGenerator") / TEXT("Spill"));
+    DDCPublisher = MakeShared<FTextureDDCPublisher>();
+
+    if (GetDefault<UTextureGeneratorSettings>()->bRecordTelemetry)
+    {
+        Telemetry = MakeShared<FGenerationTelemetry>(FGenerationTelemetry::GetDefaultDirectory());
+    }
+
+    if (GetDefault<UTextureGeneratorSettings>()->bResumeInterruptedJobs)
+    {
+        Journal = MakeShared<FTextureGenerationJournal>(FPaths::ProjectSavedDir() / TEXT("TextureGenerator"));
+        RecoverJournaledJobs();
+    }
+}
+
+void UTextureGeneratorSubsystem::Deinitialize()
+{
+    FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
+
+    // Files of a running ingestion which were not imported yet are dropped, ingesting the folder again picks them up
+    FolderIngestion.Reset();
+
+    // Imported jobs are only journaled once saved, so wait for the remaining compilations instead of dropping them
+    SaveCompiledResults(true);
+    UPackage::WaitForAsyncFileWrites();
+
+    bIsShuttingDown = true;
+    CancelAllJobs();
+    RetiredClients.Empty();
+
+    Super::Deinitialize();
+}
+
+FGuid UTextureGeneratorSubsystem::GenerateTexture(const FTextureGenerationRequest& Request)
+{
+    return EnqueueJob(Request, true);
+}
+
+FGuid UTextureGeneratorSubsystem::EnqueueJob(const FTextureGenerationRequest& Request, bool bJournal)
+{
+    const FGuid JobId = FGuid::NewGuid();
+
+    FTextureGenerationJobInfo& Job = Jobs.Add(JobId);
+    Job.JobId = JobId;
+    Job.Request = Request;
+    Job.State = ETextureGenerationJobState::Queued;
+    Job.bJournaled = bJournal;
+    Job.Timings.SubmitTime = FPlatformTime::Seconds();
+
+    if (Journal.IsValid() && bJournal)
+    {
+        Journal->RecordSubmitted(JobId, Request);
+    }
+
+    // Jobs are only dispatched from the tick, so callers always get the identifier before any callback fires
+    PendingJobs.Enqueue(JobId);
+    ++NumQueuedJobs;
+
+    return JobId;
+}
+
+TArray<FGuid> UTextureGeneratorSubsystem::GenerateTextureBatch(const TArray<FTextureGenerationRequest>& Requests)
+{
+    TArray<FGuid> JobIds;
+    JobIds.Reserve(Requests.Num());
+
+    for (const FTextureGenerationRequest& Request : Requests)
+    {
+        JobIds.Add(GenerateTexture(Request));
+    }
+
+    return JobIds;
+}
+
+TArray<FGuid> UTextureGeneratorSubsystem::GenerateVariantSet(const FTextureGenerationRequest& Request, int32 NumVariants)
+{
+    if (NumVariants <= 0)
+    {
+        UE_LOG(LogTextureGenerator, Warning, TEXT("A variant set needs at least one variant."));
+        return TArray<FGuid>();
+    }
+
+    const FGuid SetId = FGuid::NewGuid();
+    FVariantSet& Set = VariantSets.Add(SetId);
+    Set.Request = Request;
+    if (Set.Request.AssetName.IsEmpty())
+    {
+        Set.Request.AssetName = SetId.ToString().Left(8);
+    }
+    Set.Results.SetNum(NumVariants);
+    Set.NumPending = NumVariants;
+
+    // Consecutive seeds, so the whole set can be reproduced from its first seed
+    const int32 MaxFirstSeed = MAX_int32 - NumVariants;
+    const int32 FirstSeed = Request.Seed > 0 ? FMath::Min(Request.Seed, MaxFirstSeed) : FMath::RandRange(1, MaxFirstSeed);
+    Set.Request.Seed = FirstSeed;
+
+    for (int32 VariantIndex = 0; VariantIndex < NumVariants; ++VariantIndex)
+    {
+        FTextureGenerationRequest VariantRequest = Set.Request;
+        VariantRequest.Seed = FirstSeed + VariantIndex;
+
+        // Variant jobs are journaled like any other job, after a restart they are imported as individual textures,
+        // so each one needs its own name or the variants would overwrite each other. The set itself is built from Set.Request
+        VariantRequest.AssetName = FString::Printf(TEXT("%s_Variant%02d"), *Set.Request.AssetName, VariantIndex + 1);
+        const FGuid JobId = GenerateTexture(VariantRequest);
+        Jobs.FindChecked(JobId).VariantIndex = VariantIndex;
+        VariantSetJobs.Add(JobId, SetId);
+        Set.JobIds.Add(JobId);
+    }
+
+    return Set.JobIds;
+}
+
+FGuid UTextureGeneratorSubsystem::GenerateTiledTexture(const FTextureGenerationRequest& Request, int32 OutputSize, int32 TileSize, int32 Overlap, float TileStrength)
+{
+    const FGuid SetId = FGuid::NewGuid();
+    FTiledSet& Set = TiledSets.Add(SetId);
+    Set.Request = Request;
+    Set.Request.MaskTexture = nullptr;
+    Set.TileSize = FMath::Max(FInpaintCompositor::MinRegionSize, TileSize);
+    Set.OutputSize = FMath::Max(Set.TileSize, OutputSize);
+    Set.Overlap = FMath::Clamp(Overlap, 0, Set.TileSize / 2);
+    Set.TileStrength = FMath::Clamp(TileStrength, 0.0f, 1.0f);
+
+    // The global pass finishes with the whole texture, its identifier stands for the tiled texture
+    Set.GlobalJobId = EnqueueJob(Set.Request, false);
+    TiledSetJobs.Add(Set.GlobalJobId, SetId);
+
+    return Set.GlobalJobId;
+}
+
+FGuid UTextureGeneratorSubsystem::GenerateDraft(const FTextureGenerationRequest& Request)
+{
+    if (Request.IsInpainting())
+    {
+        UE_LOG(LogTextureGenerator, Warning, TEXT("Masked edits cannot be drafted, generate them directly."));
+        return FGuid();
+    }
+
+    // The refinement has to reproduce the draft, so the seed cannot be left to the service
+    FTextureGenerationRequest RefineRequest = Request;
+    if (RefineRequest.Seed <= 0)
+    {
+        RefineRequest.Seed = FMath::RandRange(1, MAX_int32);
+    }
+
+    FTextureGenerationRequest DraftRequest = RefineRequest;
+    DraftRequest.Model = FModelRoutingPolicy::GetFastestModel(Request.Model);
+    DraftRequest.bAllowModelRouting = false;
+    DraftRequest.bCreateMaterial = false;
+    DraftRequest.ManifestName.Empty();
+    if (!DraftRequest.AssetName.IsEmpty())
+    {
+        DraftRequest.AssetName += TEXT("_Draft");
+    }
+
+    const FGuid JobId = GenerateTexture(DraftRequest);
+    DraftRequests.Add(JobId, MoveTemp(RefineRequest));
+    return JobId;
+}
+
+FGuid UTextureGeneratorSubsystem::RefineDraft(const FGuid& DraftJobId, bool bUseDraftAsReference, float ReferenceStrength)
+{
+    const FTextureGenerationRequest* DraftRequest = DraftRequests.Find(DraftJobId);
+    const FTextureGenerationJobInfo* DraftJob = Jobs.Find(DraftJobId);
+    if (!DraftRequest || !DraftJob || DraftJob->State != ETextureGenerationJobState::Completed)
+    {
+        UE_LOG(LogTextureGenerator, Warning, TEXT("Job %s is not a completed draft."), *DraftJobId.ToString());
+        return FGuid();
+    }
+
+    // The refinement is what the draft was made for, routing could send it to the fast model again
+    FTextureGenerationRequest Request = *DraftRequest;
+    Request.bAllowModelRouting = false;
+    if (bUseDraftAsReference && !Request.HasReference() && DraftJob->Texture)
+    {
+        Request.ReferenceTexture = DraftJob->Texture;
+        Request.Strength = FMath::Clamp(ReferenceStrength, 0.0f, 1.0f);
+    }
+
+    return GenerateTexture(Request);
+}
+
+TArray<FTextureManifestEntryStatus> UTextureGeneratorSubsystem::BuildManifest(const FString& ManifestFilename, bool bDryRun)
+{
+    FTextureGenerationManifest Manifest;
+    FString ErrorMessage;
+    if (!FTextureManifest::Load(ManifestFilename, Manifest, ErrorMessage))
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Failed to load texture manifest: %s"), *ErrorMessage);
+        return TArray<FTextureManifestEntryStatus>();
+    }
+
+    TArray<FTextureManifestEntryStatus> Statuses = FTextureManifest::Plan(Manifest, FPaths::GetBaseFilename(ManifestFilename));
+    if (bDryRun)
+    {
+        return Statuses;
+    }
+
+    TMap<FString, const FTextureGenerationRequest*> Entries;
+    for (const FTextureGenerationRequest& Entry : Manifest.Entries)
+    {
+        Entries.Add(Entry.AssetName, &Entry);
+    }
+
+    TArray<UPackage*> PackagesToSave;
+    TArray<UObject*> ObjectsToDelete;
+    int32 NumChanged = 0;
+
+    for (FTextureManifestEntryStatus& Status : Statuses)
+    {
+        switch (Status.Action)
+        {
+        case ETextureManifestAction::Generate:
+        case ETextureManifestAction::Regenerate:
+        {
+            const FTextureGenerationRequest& Entry = *Entries.FindChecked(Status.AssetName);
+
+            // Building again before the previous build finished must not pay for the same entry twice
+            for (const TPair<FGuid, FTextureGenerationJobInfo>& Pair : Jobs)
+            {
+                if (!Pair.Value.IsFinished()
+                    && Pair.Value.Request.ManifestName == Entry.ManifestName
+                    && Pair.Value.Request.AssetName == Entry.AssetName
+                    && Pair.Value.Request.GetInputFingerprint() == Entry.GetInputFingerprint())
+                {
+                    Status.JobId = Pair.Key;
+                    break;
+                }
+            }
+
+            if (!Status.JobId.IsValid())
+            {
+                Status.JobId = GenerateTexture(Entry);
+            }
+            break;
+        }
+        case ETextureManifestAction::Reimport:
+        {
+            const FTextureGenerationRequest& Entry = *Entries.FindChecked(Status.AssetName);
+            UTexture2D* Texture = Cast<UTexture2D>(FTextureUtils::FindGeneratedAsset(TEXT("T_") + Status.AssetName));
+            if (Entry.bCreateMaskMap)
+            {
+                // The mask map is derived from the texture, which is up to date
+                FImage Image;
+                UTexture2D* MaskMap = nullptr;
+                UMaterialInstanceConstant* MaterialInstance = nullptr;
+                bool bCreatedParent = false;
+                if (!Texture || !FImageUtils::GetTexture2DSourceImage(Texture, Image))
+                {
+                    UE_LOG(LogTextureGenerator, Warning, TEXT("Failed to read the source image of T_%s."), *Status.AssetName);
+                    continue;
+                }
+
+                Image.ChangeFormat(ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+                if (!ImportMaskMap(Entry, Status.AssetName, Texture, Image, MaskMap, MaterialInstance, bCreatedParent, ErrorMessage))
+                {
+                    UE_LOG(LogTextureGenerator, Warning, TEXT("%s"), *ErrorMessage);
+                    continue;
+                }
+
+                PackagesToSave.Add(MaskMap->GetPackage());
+                if (MaterialInstance)
+                {
+                    PackagesToSave.Add(MaterialInstance->GetPackage());
+                }
+                if (bCreatedParent)
+                {
+                    PackagesToSave.Add(MaterialInstance->Parent->GetPackage());
+                }
+                break;
+            }
+
+            FString PackageName;
+            if (UMaterial* Material = FTextureUtils::CreateMaterialForTexture(Texture, Status.AssetName, PackageName))
+            {
+                PackagesToSave.Add(Material->GetPackage());
+            }
+            break;
+        }
+        case ETextureManifestAction::Delete:
+        {
+            ObjectsToDelete.Add(FTextureUtils::FindGeneratedAsset(TEXT("T_") + Status.AssetName));
+            if (UObject* Material = Cast<UMaterial>(FTextureUtils::FindGeneratedAsset(TEXT("M_") + Status.AssetName)))
+            {
+                ObjectsToDelete.Add(Material);
+            }
+
+            // Mask maps and their material instances, the shared packed material stays
+            ObjectsToDelete.Add(FTextureUtils::FindGeneratedAsset(TEXT("T_") + Status.AssetName + TEXT("_ORM")));
+            ObjectsToDelete.Add(FTextureUtils::FindGeneratedAsset(TEXT("MI_") + Status.AssetName));
+            break;
+        }
+        default:
+            continue;
+        }
+
+        ++NumChanged;
+    }
+
+    if (PackagesToSave.Num() > 0)
+    {
+        UEditorLoadingAndSavingUtils::SavePackages(PackagesToSave, true);
+    }
+
+    ObjectsToDelete.Remove(nullptr);
+    if (ObjectsToDelete.Num() > 0)
+    {
+        ObjectTools::DeleteObjects(ObjectsToDelete, false);
+    }
+
+    UE_LOG(LogTextureGenerator, Log, TEXT("Built texture manifest %s: %d of %d assets changed."), *ManifestFilename, NumChanged, Statuses.Num());
+
+    return Statuses;
+}
+
+TArray<FAssetData> UTextureGeneratorSubsystem::FindGeneratedAssets(const FGeneratedAssetQuery& Query) const
+{
+    // Every generated asset has a prompt tag, the registry answers this from its tag index
+    FARFilter Filter;
+    Filter.TagsAndValues.Add(FName(TextureGeneratorMetaData::Prompt));
+
+    TArray<FAssetData> Assets;
+    IAssetRegistry::GetChecked().GetAssets(Filter, Assets);
+
+    TArray<FString> Words;
+    Query.PromptContains.ParseIntoArrayWS(Words);
+    const FString ModelName = StaticEnum<EImageGenerationModel>()->GetNameStringByValue(static_cast<int64>(Query.Model));
+    const FString SeedString = LexToString(Query.Seed);
+
+    TArray<TPair<FDateTime, FAssetData>> Matches;
+    for (FAssetData& Asset : Assets)
+    {
+        FString Prompt;
+        FTextureUtils::GetGeneratorTag(Asset, TextureGeneratorMetaData::Prompt, Prompt);
+        if (Words.ContainsByPredicate([&Prompt](const FString& Word) { return !Prompt.Contains(Word); }))
+        {
+            continue;
+        }
+
+        FString Value;
+        if (Query.bFilterByModel && (!FTextureUtils::GetGeneratorTag(Asset, TextureGeneratorMetaData::Model, Value) || Value != ModelName))
+        {
+            continue;
+        }
+        if (Query.Seed != 0 && (!FTextureUtils::GetGeneratorTag(Asset, TextureGeneratorMetaData::Seed, Value) || Value != SeedString))
+        {
+            continue;
+        }
+        if (!Query.Fingerprint.IsEmpty() && (!FTextureUtils::GetGeneratorTag(Asset, TextureGeneratorMetaData::Fingerprint, Value) || Value != Query.Fingerprint))
+        {
+            continue;
+        }
+
+        FDateTime Created;
+        if (FTextureUtils::GetGeneratorTag(Asset, TextureGeneratorMetaData::Created, Value))
+        {
+            FDateTime::ParseIso8601(*Value, Created);
+        }
+        if (Created < Query.GeneratedAfter || (Query.GeneratedBefore.GetTicks() > 0 && Created >= Query.GeneratedBefore))
+        {
+            continue;
+        }
+
+        Matches.Emplace(Created, MoveTemp(Asset));
+    }
+
+    Matches.Sort([](const TPair<FDateTime, FAssetData>& A, const TPair<FDateTime, FAssetData>& B) { return A.Key > B.Key; });
+
+    TArray<FAssetData> Result;
+    Result.Reserve(Matches.Num());
+    for (TPair<FDateTime, FAssetData>& Match : Matches)
+    {
+        Result.Add(MoveTemp(Match.Value));
+    }
+    return Result;
+}
+
+UTexture2D* UTextureGeneratorSubsystem::PackMaskMaps(UTexture2D* Occlusion, UTexture2D* Roughness, UTexture2D* Metallic, const FString& AssetName)
+{
+    if (AssetName.IsEmpty())
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Packing mask maps needs an asset name."));
+        return nullptr;
+    }
+
+    UTexture2D* Maps[3] = { Occlusion, Roughness, Metallic };
+    FImage Images[3];
+    for (int32 Index = 0; Index < 3; ++Index)
+    {
+        if (Maps[Index] && !FImageUtils::GetTexture2DSourceImage(Maps[Index], Images[Index]))
+        {
+            UE_LOG(LogTextureGenerator, Error, TEXT("Failed to read the source image of %s."), *Maps[Index]->GetName());
+            return nullptr;
+        }
+    }
+
+    FImage MaskImage;
+    if (!FMaskMapPacker::Pack(Occlusion ? &Images[0] : nullptr, Roughness ? &Images[1] : nullptr, Metallic ? &Images[2] : nullptr, MaskImage))
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Packing mask maps needs at least one map."));
+        return nullptr;
+    }
+
+    FString PackageName;
+    UTexture2D* ExistingMaskMap = Cast<UTexture2D>(FTextureUtils::FindGeneratedAsset(TEXT("T_") + AssetName + TEXT("_ORM")));
+    UTexture2D* MaskMap = ExistingMaskMap && FTextureUtils::UpdateTextureFromImage(ExistingMaskMap, MaskImage)
+        ? ExistingMaskMap
+        : FTextureUtils::CreateMaskTextureFromImage(MaskImage, AssetName, PackageName);
+    if (!MaskMap)
+    {
+        return nullptr;
+    }
+
+    // Saved like generated results, once the texture finished compiling
+    FPendingSave PendingSave;
+    PendingSave.Texture = MaskMap;
+    PendingSave.Packages.Add(MaskMap->GetPackage());
+    PendingSaves.Add(MoveTemp(PendingSave));
+    BrowserSyncObjects.Add(MaskMap);
+
+    return MaskMap;
+}
+
+int32 UTextureGeneratorSubsystem::IngestFolder(const FString& Directory, bool bRecursive, bool bCreateMaterials)
+{
+    if (FolderIngestion.IsValid())
+    {
+        UE_LOG(LogTextureGenerator, Warning, TEXT("Another folder is still being ingested."));
+        return 0;
+    }
+
+    const FString FullDirectory = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), Directory);
+    if (!IFileManager::Get().DirectoryExists(*FullDirectory))
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Folder %s does not exist."), *FullDirectory);
+        return 0;
+    }
+
+    TArray<FString> Filenames = FFolderIngestion::FindImageFiles(FullDirectory, bRecursive);
+    const int32 NumFiles = Filenames.Num();
+    if (NumFiles == 0)
+    {
+        UE_LOG(LogTextureGenerator, Warning, TEXT("Folder %s contains no image files."), *FullDirectory);
+        return 0;
+    }
+
+    UE_LOG(LogTextureGenerator, Log, TEXT("Ingesting %d images from %s."), NumFiles, *FullDirectory);
+    FolderIngestion = MakeShared<FFolderIngestion>(MoveTemp(Filenames), bCreateMaterials);
+
+    return NumFiles;
+}
+
+bool UTextureGeneratorSubsystem::IsIngestingFolder() const
+{
+    return FolderIngestion.IsValid();
+}
+
+FGuid UTextureGeneratorSubsystem::GeneratePromptMatrix(const FTextureGenerationRequest& Request, const TArray<EStylePreset>& StylePresets, int32 NumSamples, EPromptMatrixSampling Sampling)
+{
+    FString Error;
+    TSharedPtr<FPromptMatrix> Matrix = FPromptMatrix::Create(Request, StylePresets, NumSamples, Sampling, Error);
+    if (!Matrix.IsValid())
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Cannot expand prompt matrix: %s"), *Error);
+        return FGuid();
+    }
+
+    const FGuid MatrixId = FGuid::NewGuid();
+    UE_LOG(LogTextureGenerator, Log, TEXT("Prompt matrix %s generates %lld of %lld combinations."),
+        *MatrixId.ToString(), Matrix->GetNumSamples(), Matrix->GetNumCombinations());
+
+    // Combinations are queued from the tick, like jobs are dispatched
+    PromptMatrices.Add({ MatrixId, MoveTemp(Matrix) });
+    return MatrixId;
+}
+
+bool UTextureGeneratorSubsystem::IsPromptMatrixRunning(const FGuid& MatrixId) const
+{
+    return PromptMatrices.ContainsByPredicate([&MatrixId](const FRunningPromptMatrix& Running)
+    {
+        return Running.MatrixId == MatrixId;
+    });
+}
+
+bool UTextureGeneratorSubsystem::CancelPromptMatrix(const FGuid& MatrixId)
+{
+    return PromptMatrices.RemoveAll([&MatrixId](const FRunningPromptMatrix& Running)
+    {
+        return Running.MatrixId == MatrixId;
+    }) > 0;
+}
+
+bool UTextureGeneratorSubsystem::CancelJob(const FGuid& JobId)
+{
+    FTextureGenerationJobInfo* Job = Jobs.Find(JobId);
+    if (!Job || Job->IsFinished())
+    {
+        return false;
+    }
+
+    if (Job->State == ETextureGenerationJobState::Queued)
+    {
+        // The identifier stays in the queue and gets skipped once dequeued
+        --NumQueuedJobs;
+    }
+
+    TSharedPtr<FStabilityAPIClient> Client;
+    if (ActiveClients.RemoveAndCopyValue(JobId, Client))
+    {
+        // Unbind first, cancelling the HTTP request reports it as failed
+        Client->OnImageGenerated.Unbind();
+        Client->OnError.Unbind();
+        Client->CancelRequest();
+        RetiredClients.Add(Client);
+    }
+
+    FinishJob(JobId, ETextureGenerationJobState::Cancelled);
+    return true;
+}
+
+void UTextureGeneratorSubsystem::CancelAllJobs()
+{
+    PromptMatrices.Empty();
+
+    TArray<FGuid> JobIds;
+    Jobs.GetKeys(JobIds);
+
+    for (const FGuid& JobId : JobIds)
+    {
+        CancelJob(JobId);
+    }
+}
+
+bool UTextureGeneratorSubsystem::GetJobInfo(const FGuid& JobId, FTextureGenerationJobInfo& OutJobInfo) const
+{
+    if (const FTextureGenerationJobInfo* Job = Jobs.Find(JobId))
+    {
+        OutJobInfo = *Job;
+        return true;
+    }
+    return false;
+}
+
+ETextureGenerationJobState UTextureGeneratorSubsystem::GetJobState(const FGuid& JobId) const
+{
+    const FTextureGenerationJobInfo* Job = Jobs.Find(JobId);
+    return Job ? Job->State : ETextureGenerationJobState::Failed;
+}
+
+int32 UTextureGeneratorSubsystem::GetNumQueuedJobs() const
+{
+    return NumQueuedJobs;
+}
+
+int32 UTextureGeneratorSubsystem::GetNumInFlightJobs() const
+{
+    return ActiveClients.Num();
+}
+
+FModelEndpointStats UTextureGeneratorSubsystem::GetModelStats(EImageGenerationModel Model) const
+{
+    return RoutingPolicy.GetStats(Model);
+}
+
+FString UTextureGeneratorSubsystem::GetTelemetryReport(int32 Days, bool bPerDay) const
+{
+    const FDateTime Since = FDateTime::UtcNow() - FTimespan::FromDays(FMath::Max(1, Days));
+    return FGenerationTelemetry::FormatReport(FGenerationTelemetry::Load(FGenerationTelemetry::GetDefaultDirectory(), Since), bPerDay);
+}
+
+void UTextureGeneratorSubsystem::ClearFinishedJobs()
+{
+    for (auto It = Jobs.CreateIterator(); It; ++It)
+    {
+        if (It.Value().IsFinished())
+        {
+            DraftRequests.Remove(It.Key());
+            It.RemoveCurrent();
+        }
+    }
+}
+
+bool UTextureGeneratorSubsystem::Tick(float DeltaTime)
+{
+    RetiredClients.Reset();
+    DecodedResult = FImage();
+    DecodedResultId.Invalidate();
+
+    ImportPendingResults();
+    SyncBrowserToImportedAssets();
+    ImportIngestedFiles();
+    SaveCompiledResults(false);
+    DDCPublisher->Tick();
+    HedgeSlowRequests();
+    FeedPromptMatrices();
+    DispatchPendingJobs();
+    return true;
+}
+
+void UTextureGeneratorSubsystem::FeedPromptMatrices()
+{
+    // Two jobs per request slot keep the dispatcher busy between ticks, the rest of a matrix stays unexpanded
+    const int32 MaxQueuedJobs = 2 * FMath::Max(1, GetDefault<UTextureGeneratorSettings>()->MaxConcurrentRequests);
+
+    while (PromptMatrices.Num() > 0 && NumQueuedJobs < MaxQueuedJobs)
+    {
+        const FRunningPromptMatrix& Running = PromptMatrices[0];
+
+        FTextureGenerationRequest Request;
+        if (Running.Matrix->Next(Request))
+        {
+            GenerateTexture(Request);
+        }
+
+        if (Running.Matrix->IsDone())
+        {
+            UE_LOG(LogTextureGenerator, Log, TEXT("Prompt matrix %s queued all of its combinations."), *Running.MatrixId.ToString());
+            PromptMatrices.RemoveAt(0);
+        }
+    }
+}
+
+void UTextureGeneratorSubsystem::DispatchPendingJobs()
+{
+    const int32 MaxConcurrentRequests = FMath::Max(1, GetDefault<UTextureGeneratorSettings>()->MaxConcurrentRequests);
+
+    // Jobs joining an identical request already in flight do not take a request slot
+    ResultPipeline->SetHeldBytes(GetHeldResultBytes());
+
+    FGuid JobId;
+    while (FStabilityAPIClient::GetNumActiveHttpRequests() + NumActivePlaceholderJobs < MaxConcurrentRequests && PendingJobs.Peek(JobId))
+    {
+        // Hold back new requests while the importer cannot keep up with the results
+        if (!ResultPipeline->HasCapacity())
+        {
+            break;
+        }
+        PendingJobs.Pop();
+
+        const FTextureGenerationJobInfo* Job = Jobs.Find(JobId);
+        if (!Job || Job->State != ETextureGenerationJobState::Queued)
+        {
+            // Cancelled or forgotten while waiting in the queue
+            continue;
+        }
+
+        --NumQueuedJobs;
+        StartJob(JobId);
+    }
+}
+
+void UTextureGeneratorSubsystem::StartJob(const FGuid& JobId)
+{
+    FTextureGenerationJobInfo& Job = Jobs.FindChecked(JobId);
+    Job.Timings.StartTime = FPlatformTime::Seconds();
+    Job.Timings.QueueSeconds = Job.Timings.StartTime - Job.Timings.SubmitTime;
+
+    if (Job.Request.Prompt.IsEmpty())
+    {
+        FinishJob(JobId, ETextureGenerationJobState::Failed, TEXT("Prompt text is empty. Please enter some text first to generate the texture."));
+        return;
+    }
+
+    if (Job.Request.Model == EImageGenerationModel::Placeholder)
+    {
+        StartPlaceholderJob(JobId);
+        return;
+    }
+
+    const FString APIKey = GetDefault<UTextureGeneratorSettings>()->APIKey;
+    if (APIKey.IsEmpty())
+    {
+        FinishJob(JobId, ETextureGenerationJobState::Failed, TEXT("Stability API Key not set. Go to Project Settings -> Stability AI Image Generator -> and fill in the API key parameter."));
+        return;
+    }
+
+    FStabilityGenerationParams Params;
+    FString ErrorMessage;
+    if (!BuildGenerationParams(Job, Params, ErrorMessage))
+    {
+        FinishJob(JobId, ETextureGenerationJobState::Failed, ErrorMessage);
+        return;
+    }
+
+    TSharedPtr<FStabilityAPIClient> Client = MakeShared<FStabilityAPIClient>();
+    Client->SetAPIKey(APIKey);
+    Client->OnImageGenerated.BindUObject(this, &UTextureGeneratorSubsystem::HandleImageGenerated, JobId);
+    Client->OnError.BindUObject(this, &UTextureGeneratorSubsystem::HandleGenerationError, JobId);
+
+    Job.State = ETextureGenerationJobState::InFlight;
+    Job.Model = Job.Request.IsInpainting() ? Job.Request.Model : RouteJob(Job.Request);
+    Job.DispatchTime = FPlatformTime::Seconds();
+    ActiveClients.Add(JobId, Client);
+
+    Params.Model = Job.Model;
+
+    // Should the request turn out to be slow, its duplicate is built from the job again
+    if (GetDefault<UTextureGeneratorSettings>()->bHedgeSlowRequests && !Job.Request.IsInpainting())
+    {
+        HedgeableRequests.Add(JobId);
+        ++NumHedgeableRequests;
+    }
+
+    Client->GenerateImage(Params);
+
+    // Reading the reference and building the request body, the request itself is sent in the background.
+    // Failing to send finishes the job and its listeners may have submitted new jobs, so look it up again.
+    if (FTextureGenerationJobInfo* StartedJob = Jobs.Find(JobId))
+    {
+        StartedJob->Timings.EncodeSeconds = FPlatformTime::Seconds() - StartedJob->Timings.StartTime;
+    }
+}
+
+bool UTextureGeneratorSubsystem::BuildGenerationParams(FTextureGenerationJobInfo& Job, FStabilityGenerationParams& OutParams, FString& OutError)
+{
+    // Edits only send the masked region, read from the current reference and mask
+    if (Job.Request.IsInpainting())
+    {
+        // Captured once, so retries and the import use the reference and mask the region was computed from,
+        // even when either is edited while the request is in flight
+        FInpaintSnapshot* Snapshot = InpaintSnapshots.Find(Job.JobId);
+        if (!Snapshot)
+        {
+            FInpaintSnapshot NewSnapshot;
+            if (!PrepareInpainting(Job.Request, NewSnapshot, OutError))
+            {
+                return false;
+            }
+            Snapshot = &InpaintSnapshots.Add(Job.JobId, MoveTemp(NewSnapshot));
+        }
+
+        if (!FInpaintCompositor::EncodeRegion(Snapshot->Source, Snapshot->Mask, Snapshot->Region, OutParams.ReferenceImage, OutParams.MaskImage))
+        {
+            OutError = TEXT("Encoding the masked region failed.");
+            return false;
+        }
+    }
+    else if (Job.ReferenceImageData.Num() > 0)
+    {
+        // Copied, the job keeps the bytes until it finishes, for retries and duplicates
+        OutParams.ReferenceImage = Job.ReferenceImageData;
+    }
+    else if (IsValid(Job.Request.ReferenceTexture))
+    {
+        OutParams.ReferenceImage = FTextureUtils::GetTextureImageData(Job.Request.ReferenceTexture);
+    }
+    else if (!Job.Request.ReferenceImageFile.IsEmpty())
+    {
+        // Accepted formats are mapped and uploaded as they are, anything else the engine can read is converted to PNG
+        OutParams.ReferenceImageFile = FReferenceImageFile::Open(Job.Request.ReferenceImageFile, OutError);
+
+        FImage Image;
+        TArray64<uint8> ImageData;
+        if (!OutParams.ReferenceImageFile.IsValid())
+        {
+            if (!FImageUtils::LoadImage(*FReferenceImageFile::GetFullPath(Job.Request.ReferenceImageFile), Image)
+                || !FImageUtils::CompressImage(ImageData, TEXT("png"), Image))
+            {
+                return false;
+            }
+            OutParams.ReferenceImage = TArray<uint8>(ImageData);
+        }
+    }
+
+    OutParams.Prompt = Job.Request.Prompt;
+    OutParams.NegativePrompt = Job.Request.NegativePrompt;
+    OutParams.StylePreset = FStabilityAPIClient::GetStylePresetString(Job.Request.StylePreset);
+    OutParams.Seed = Job.Request.Seed;
+    OutParams.Strength = Job.Request.Strength;
+    return true;
+}
+
+void UTextureGeneratorSubsystem::StartPlaceholderJob(const FGuid& JobId)
+{
+    FTextureGenerationJobInfo& Job = Jobs.FindChecked(JobId);
+    Job.State = ETextureGenerationJobState::InFlight;
+    Job.Model = EImageGenerationModel::Placeholder;
+    Job.DispatchTime = FPlatformTime::Seconds();
+    ++NumActivePlaceholderJobs;
+
+    // Tiles carry their crop of the global pass, a reference texture is read like for the API
+    TArray<uint8> ReferenceImage;
+    if (Job.ReferenceImageData.Num() > 0)
+    {
+        ReferenceImage = MoveTemp(Job.ReferenceImageData);
+    }
+    else if (IsValid(Job.Request.ReferenceTexture))
+    {
+        ReferenceImage = TArray<uint8>(FTextureUtils::GetTextureImageData(Job.Request.ReferenceTexture));
+    }
+
+    // Synthesized on a worker and handed back like a received image, so it goes through the regular import path
+    TWeakObjectPtr<UTextureGeneratorSubsystem> WeakThis(this);
+    Async(EAsyncExecution::ThreadPool, [WeakThis, JobId, Prompt = Job.Request.Prompt, Seed = Job.Request.Seed,
+        Strength = Job.Request.Strength, ReferenceImage = MoveTemp(ReferenceImage)]()
+    {
+        TArray<uint8> ImageData;
+        const bool bGenerated = ReferenceImage.Num() > 0
+            ? FPlaceholderGenerator::GenerateImageData(Prompt, Seed, ReferenceImage, Strength, ImageData)
+            : FPlaceholderGenerator::GenerateImageData(Prompt, Seed, ImageData);
+
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, JobId, bGenerated, ImageData = MoveTemp(ImageData)]()
+        {
+            UTextureGeneratorSubsystem* This = WeakThis.Get();
+            if (!This)
+            {
+                return;
+            }
+
+            --This->NumActivePlaceholderJobs;
+            if (bGenerated)
+            {
+                This->HandleImageGenerated(ImageData, JobId);
+            }
+            else
+            {
+                This->HandleGenerationError(TEXT("Decoding the reference or encoding the placeholder texture failed."), JobId);
+            }
+        });
+    });
+}
+
+EImageGenerationModel UTextureGeneratorSubsystem::RouteJob(const FTextureGenerationRequest& Request) const
+{
+    if (!Request.bAllowModelRouting)
+    {
+        return Request.Model;
+    }
+
+    const UTextureGeneratorSettings* Settings = GetDefault<UTextureGeneratorSettings>();
+
+    // A throughput target translates into a latency budget, given how many requests run side by side
+    double LatencyBudget = Settings->TargetLatencySeconds;
+    if (Settings->TargetThroughputPerMinute > 0.0f)
+    {
+        const double ThroughputBudget = FMath::Max(1, Settings->MaxConcurrentRequests) * 60.0 / Settings->TargetThroughputPerMinute;
+        LatencyBudget = LatencyBudget > 0.0 ? FMath::Min(LatencyBudget, ThroughputBudget) : ThroughputBudget;
+    }
+
+    const EImageGenerationModel Model = RoutingPolicy.SelectModel(Request.Model, LatencyBudget, Settings->MaxModelErrorRate);
+    if (Model != Request.Model)
+    {
+        UE_LOG(LogTextureGenerator, Verbose, TEXT("Routing job from %s to %s to meet the latency budget of %.1fs."),
+            *UEnum::GetValueAsString(Request.Model), *UEnum::GetValueAsString(Model), LatencyBudget);
+    }
+    return Model;
+}
+
+void UTextureGeneratorSubsystem::FinishJob(const FGuid& JobId, ETextureGenerationJobState State, const FString& ErrorMessage)
+{
+    FTextureGenerationJobInfo* Job = Jobs.Find(JobId);
+    if (!Job)
+    {
+        return;
+    }
+
+    Job->State = State;
+    Job->ErrorMessage = ErrorMessage;
+    Job->ReferenceImageData.Empty();
+
+    ReleaseHedge(JobId);
+    InpaintSnapshots.Remove(JobId);
+
+    TSharedPtr<FStabilityAPIClient> Client;
+    if (ActiveClients.RemoveAndCopyValue(JobId, Client))
+    {
+        RetiredClients.Add(Client);
+    }
+
+    if (State == ETextureGenerationJobState::Failed)
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Texture generation job %s failed: %s"), *JobId.ToString(), *ErrorMessage);
+    }
+
+    // Completed jobs are journaled as imported once their assets were saved
+    if (Journal.IsValid() && Job->bJournaled && !bIsShuttingDown && State != ETextureGenerationJobState::Completed)
+    {
+        Journal->RecordAbandoned(JobId, State);
+    }
+
+    // Completed jobs are recorded once their assets were saved, jobs cancelled by a shutdown resume on the next start
+    const bool bAwaitingSave = State == ETextureGenerationJobState::Completed
+        && PendingSaves.ContainsByPredicate([&JobId](const FPendingSave& PendingSave) { return PendingSave.JobIds.Contains(JobId); });
+    if (!bIsShuttingDown && !bAwaitingSave)
+    {
+        RecordTelemetry(JobId);
+    }
+
+    // Listeners may submit new jobs, so broadcast a copy rather than the map entry
+    const FTextureGenerationJobInfo JobInfo = *Job;
+    JobFinishedNative.Broadcast(JobInfo);
+    OnJobFinished.Broadcast(JobInfo);
+
+    if (State != ETextureGenerationJobState::Completed)
+    {
+        ReleaseVariant(JobId);
+        ReleaseTiledJob(JobId);
+    }
+}
+
+void UTextureGeneratorSubsystem::HandleImageGenerated(const TArray<uint8>& ImageData, FGuid JobId)
+{
+    FTextureGenerationJobInfo* Job = Jobs.Find(JobId);
+    if (!Job || Job->State != ETextureGenerationJobState::InFlight)
+    {
+        return;
+    }
+
+    // The first response wins, a duplicate still in flight is no longer needed
+    ReleaseHedge(JobId);
+
+    if (const TSharedPtr<FStabilityAPIClient>* Client = ActiveClients.Find(JobId))
+    {
+        FGenerationTelemetry::AddRequestTimings(Job->Timings, (*Client)->GetRequestTimings());
+        Job->ResultId = (*Client)->GetResponseId();
+        Job->ResultSeed = (*Client)->GetResponseSeed();
+    }
+    else
+    {
+        // Placeholders are synthesized locally, their generation counts as server time
+        Job->Timings.ServerSeconds = FPlatformTime::Seconds() - Job->DispatchTime;
+    }
+
+    // Edits go to their own endpoint and placeholders never reach the API, either would skew the statistics of the model
+    if (!Job->Request.IsInpainting() && Job->Model != EImageGenerationModel::Placeholder)
+    {
+        RoutingPolicy.RecordSuccess(Job->Model, FPlatformTime::Seconds() - Job->DispatchTime);
+    }
+
+    Job->State = ETextureGenerationJobState::Importing;
+
+    // Keep the paid result on disk until the import went through, the pipeline reuses that copy when over budget
+    FString StoredFilename;
+    // Jobs coalesced into one request share a single stored copy
+    if (Journal.IsValid() && Job->bJournaled && Journal->RecordCompleted(JobId, Job->ResultId.IsValid() ? Job->ResultId : JobId, ImageData))
+    {
+        StoredFilename = Journal->GetResultFilename(JobId);
+    }
+
+    ResultPipeline->SetHeldBytes(GetHeldResultBytes());
+    ResultPipeline->Add(JobId, ImageData, StoredFilename);
+}
+
+void UTextureGeneratorSubsystem::HandleGenerationError(const FString& ErrorMessage, FGuid JobId)
+{
+    FTextureGenerationJobInfo* Job = Jobs.Find(JobId);
+    if (!Job || Job->State != ETextureGenerationJobState::InFlight)
+    {
+        return;
+    }
+
+    if (!Job->Request.IsInpainting() && Job->Model != EImageGenerationModel::Placeholder)
+    {
+        RoutingPolicy.RecordFailure(Job->Model);
+    }
+
+    // A duplicate still in flight takes over the job. The failed client is on the callstack, so it is only retired.
+    FHedgedRequest Hedge;
+    if (HedgedRequests.RemoveAndCopyValue(JobId, Hedge))
+    {
+        TSharedPtr<FStabilityAPIClient> Client;
+        if (ActiveClients.RemoveAndCopyValue(JobId, Client))
+        {
+            RetiredClients.Add(Client);
+        }
+
+        Hedge.Client->OnImageGenerated.BindUObject(this, &UTextureGeneratorSubsystem::HandleImageGenerated, JobId);
+        Hedge.Client->OnError.BindUObject(this, &UTextureGeneratorSubsystem::HandleGenerationError, JobId);
+        ActiveClients.Add(JobId, Hedge.Client);
+        Job->Model = Hedge.Model;
+        Job->DispatchTime = Hedge.DispatchTime;
+
+        UE_LOG(LogTextureGenerator, Verbose, TEXT("Request of job %s failed, waiting for its duplicate: %s"), *JobId.ToString(), *ErrorMessage);
+        return;
+    }
+
+    FinishJob(JobId, ETextureGenerationJobState::Failed, ErrorMessage);
+}
+
+void UTextureGeneratorSubsystem::HedgeSlowRequests()
+{
+    const UTextureGeneratorSettings* Settings = GetDefault<UTextureGeneratorSettings>();
+    if (!Settings->bHedgeSlowRequests || HedgeableRequests.IsEmpty())
+    {
+        return;
+    }
+
+    // Percentiles of a handful of samples say little about the tail
+    static constexpr int32 MinHedgeSamples = 5;
+
+    const int32 MaxConcurrentRequests = FMath::Max(1, Settings->MaxConcurrentRequests);
+    const double Now = FPlatformTime::Seconds();
+
+    for (auto It = HedgeableRequests.CreateIterator(); It; ++It)
+    {
+        // Duplicates take free request slots before queued jobs do, but never exceed the limit or the extra request budget
+        if (FStabilityAPIClient::GetNumActiveHttpRequests() >= MaxConcurrentRequests
+            || NumHedgeRequests >= Settings->MaxHedgeRequestShare * NumHedgeableRequests)
+        {
+            break;
+        }
+
+        const FGuid JobId = *It;
+        FTextureGenerationJobInfo* Job = Jobs.Find(JobId);
+        if (!Job || Job->State != ETextureGenerationJobState::InFlight
+            || RoutingPolicy.GetStats(Job->Model).NumSamples < MinHedgeSamples)
+        {
+            continue;
+        }
+
+        const double PercentileLatency = RoutingPolicy.GetLatencyPercentile(Job->Model, Settings->HedgeLatencyPercentile);
+        const double Elapsed = Now - Job->DispatchTime;
+        if (Elapsed < FMath::Max<double>(PercentileLatency, Settings->MinHedgeDelaySeconds))
+        {
+            continue;
+        }
+
+        It.RemoveCurrent();
+
+        FStabilityGenerationParams Params;
+        FString ErrorMessage;
+        if (!BuildGenerationParams(*Job, Params, ErrorMessage))
+        {
+            UE_LOG(LogTextureGenerator, Verbose, TEXT("Not hedging job %s: %s"), *JobId.ToString(), *ErrorMessage);
+            continue;
+        }
+
+        // The duplicate must not join the original, which coalescing would do for explicit seeds
+        Params.Model = Job->Model;
+        Params.bAllowCoalescing = false;
+        if (Settings->bHedgeWithFasterModel && Job->Request.bAllowModelRouting)
+        {
+            Params.Model = FModelRoutingPolicy::GetFasterModel(Job->Model);
+        }
+
+        UE_LOG(LogTextureGenerator, Log, TEXT("Hedging job %s on %s after %.1fs, %s usually finishes within %.1fs."),
+            *JobId.ToString(), *UEnum::GetValueAsString(Params.Model), Elapsed, *UEnum::GetValueAsString(Job->Model), PercentileLatency);
+
+        TSharedPtr<FStabilityAPIClient> Client = MakeShared<FStabilityAPIClient>();
+        Client->SetAPIKey(Settings->APIKey);
+        Client->OnImageGenerated.BindUObject(this, &UTextureGeneratorSubsystem::HandleHedgeGenerated, JobId);
+        Client->OnError.BindUObject(this, &UTextureGeneratorSubsystem::HandleHedgeError, JobId);
+
+        FHedgedRequest& Hedge = HedgedRequests.Add(JobId);
+        Hedge.Client = Client;
+        Hedge.Model = Params.Model;
+        Hedge.DispatchTime = Now;
+        ++NumHedgeRequests;
+        Job->Timings.bHedged = true;
+
+        Client->GenerateImage(Params);
+    }
+}
+
+void UTextureGeneratorSubsystem::HandleHedgeGenerated(const TArray<uint8>& ImageData, FGuid JobId)
+{
+    FHedgedRequest Hedge;
+    FTextureGenerationJobInfo* Job = Jobs.Find(JobId);
+    if (!Job || Job->State != ETextureGenerationJobState::InFlight || !HedgedRequests.RemoveAndCopyValue(JobId, Hedge))
+    {
+        return;
+    }
+
+    const double Now = FPlatformTime::Seconds();
+    UE_LOG(LogTextureGenerator, Log, TEXT("Duplicate of job %s finished first, %.1fs after the original request."), *JobId.ToString(), Now - Job->DispatchTime);
+
+    // The time the original took so far is a lower bound of its latency, recording it keeps the slow tail in the statistics.
+    // It never succeeded nor failed, so the error rate is left alone.
+    RoutingPolicy.RecordLatency(Job->Model, Now - Job->DispatchTime);
+
+    TSharedPtr<FStabilityAPIClient> Client;
+    if (ActiveClients.RemoveAndCopyValue(JobId, Client))
+    {
+        Client->OnImageGenerated.Unbind();
+        Client->OnError.Unbind();
+        Client->CancelRequest();
+        RetiredClients.Add(Client);
+    }
+
+    // From here on the duplicate is the request of the job
+    ActiveClients.Add(JobId, Hedge.Client);
+    Job->Model = Hedge.Model;
+    Job->DispatchTime = Hedge.DispatchTime;
+
+    HandleImageGenerated(ImageData, JobId);
+}
+
+void UTextureGeneratorSubsystem::HandleHedgeError(const FString& ErrorMessage, FGuid JobId)
+{
+    FHedgedRequest Hedge;
+    if (!HedgedRequests.RemoveAndCopyValue(JobId, Hedge))
+    {
+        return;
+    }
+
+    // The original request carries on
+    RoutingPolicy.RecordFailure(Hedge.Model);
+    RetiredClients.Add(Hedge.Client);
+
+    UE_LOG(LogTextureGenerator, Verbose, TEXT("Duplicate request of job %s failed: %s"), *JobId.ToString(), *ErrorMessage);
+}
+
+void UTextureGeneratorSubsystem::ReleaseHedge(const FGuid& JobId)
+{
+    HedgeableRequests.Remove(JobId);
+
+    FHedgedRequest Hedge;
+    if (HedgedRequests.RemoveAndCopyValue(JobId, Hedge))
+    {
+        // Unbind first, cancelling the HTTP request reports it as failed
+        Hedge.Client->OnImageGenerated.Unbind();
+        Hedge.Client->OnError.Unbind();
+        Hedge.Client->CancelRequest();
+        RetiredClients.Add(Hedge.Client);
+    }
+}
+
+void UTextureGeneratorSubsystem::CompleteJob(const FGuid& JobId, const TArray<uint8>& ImageData)
+{
+    if (VariantSetJobs.Contains(JobId))
+    {
+        AddVariantResult(JobId, ImageData);
+        return;
+    }
+
+    if (TiledSetJobs.Contains(JobId))
+    {
+        AddTiledResult(JobId, ImageData);
+        return;
+    }
+
+    FTextureGenerationJobInfo& Job = Jobs.FindChecked(JobId);
+
+    FString ErrorMessage;
+    if (!ImportJobResult(Job, ImageData, ErrorMessage))
+    {
+        FinishJob(JobId, ETextureGenerationJobState::Failed, ErrorMessage);
+        return;
+    }
+
+    FinishJob(JobId, ETextureGenerationJobState::Completed);
+}
+
+void UTextureGeneratorSubsystem::RecoverJournaledJobs()
+{
+    for (FTextureGenerationJournal::FRecoveredJob& Recovered : Journal->Recover())
+    {
+        FTextureGenerationJobInfo& Job = Jobs.Add(Recovered.JobId);
+        Job.JobId = Recovered.JobId;
+        Job.Request = MoveTemp(Recovered.Request);
+        Job.Timings.SubmitTime = FPlatformTime::Seconds();
+
+        if (Recovered.bCompleted)
+        {
+            // The image was already paid for, import it from disk instead of generating it again
+            Job.State = ETextureGenerationJobState::Importing;
+            Job.ResultId = Recovered.ResultId;
+            ResultPipeline->AddStored(Recovered.JobId, Journal->GetResultFilename(Recovered.JobId));
+        }
+        else
+        {
+            Job.State = ETextureGenerationJobState::Queued;
+            PendingJobs.Enqueue(Recovered.JobId);
+            ++NumQueuedJobs;
+        }
+    }
+}
+
+void UTextureGeneratorSubsystem::ImportPendingResults()
+{
+    if (ResultPipeline->IsEmpty())
+    {
+        return;
+    }
+
+    // Results are imported from the tick, recovered ones once the editor finished starting up.
+    // Imports stop once the budget of the tick is spent, but at least one result is imported so large batches keep moving.
+    const double Deadline = FPlatformTime::Seconds() + GetDefault<UTextureGeneratorSettings>()->ImportBudgetMilliseconds / 1000.0;
+
+    do
+    {
+        FGuid JobId;
+        TArray<uint8> ImageData;
+        const bool bLoaded = ResultPipeline->Pop(JobId, ImageData);
+
+        const FTextureGenerationJobInfo* Job = Jobs.Find(JobId);
+        if (!Job || Job->State != ETextureGenerationJobState::Importing)
+        {
+            // Cancelled while waiting for import
+            continue;
+        }
+
+        if (!bLoaded)
+        {
+            FinishJob(JobId, ETextureGenerationJobState::Failed, TEXT("Stored generation result could not be loaded."));
+            continue;
+        }
+
+        CompleteJob(JobId, ImageData);
+    }
+    while (!ResultPipeline->IsEmpty() && FPlatformTime::Seconds() < Deadline);
+}
+
+int64 UTextureGeneratorSubsystem::GetHeldResultBytes() const
+{
+    int64 Bytes = DecodedResult.RawData.Num();
+
+    for (const TPair<FGuid, FVariantSet>& Pair : VariantSets)
+    {
+        for (const TArray<uint8>& Result : Pair.Value.Results)
+        {
+            Bytes += Result.Num();
+        }
+    }
+
+    for (const TPair<FGuid, FTiledSet>& Pair : TiledSets)
+    {
+        Bytes += Pair.Value.Canvas.RawData.Num();
+        for (const FImage& TileImage : Pair.Value.TileImages)
+        {
+            Bytes += TileImage.RawData.Num();
+        }
+    }
+
+    return Bytes;
+}
+
+void UTextureGeneratorSubsystem::SyncBrowserToImportedAssets()
+{
+    // Syncing moves the Content Browser, so it happens once per batch rather than once per result
+    if (BrowserSyncObjects.Num() == 0 || !ResultPipeline->IsEmpty())
+    {
+        return;
+    }
+
+    TArray<UObject*> Objects;
+    for (const TWeakObjectPtr<UObject>& Object : BrowserSyncObjects)
+    {
+        if (Object.IsValid())
+        {
+            Objects.Add(Object.Get());
+        }
+    }
+    BrowserSyncObjects.Reset();
+
+    if (Objects.Num() > 0)
+    {
+        GEditor->SyncBrowserToObjects(Objects);
+    }
+}
+
+void UTextureGeneratorSubsystem::ImportIngestedFiles()
+{
+    if (!FolderIngestion.IsValid())
+    {
+        return;
+    }
+
+    FolderIngestion->Tick();
+
+    // Imports stop once the budget of the tick is spent, so the editor stays responsive while a large folder is ingested
+    const double Deadline = FPlatformTime::Seconds() + GetDefault<UTextureGeneratorSettings>()->ImportBudgetMilliseconds / 1000.0;
+
+    FFolderIngestion::FFile File;
+    while (FPlatformTime::Seconds() < Deadline && FolderIngestion->Pop(File))
+    {
+        const bool bImported = File.bDecoded && ImportIngestedImage(File.AssetName, File.Image, FolderIngestion->ShouldCreateMaterials());
+        if (!bImported)
+        {
+            UE_LOG(LogTextureGenerator, Warning, TEXT("Failed to %s %s."), File.bDecoded ? TEXT("import") : TEXT("decode"), *File.Filename);
+        }
+        FolderIngestion->RecordResult(bImported);
+    }
+
+    // Start decoding the next batch right away, so the workers are busy until the next tick
+    FolderIngestion->Tick();
+
+    if (FolderIngestion->IsDone())
+    {
+        const double Seconds = FMath::Max(FolderIngestion->GetElapsedSeconds(), 0.001);
+        UE_LOG(LogTextureGenerator, Log, TEXT("Ingested %d of %d images in %.1f s (%.1f images/s), %d failed, %d skipped as existing assets."),
+            FolderIngestion->GetNumImported(), FolderIngestion->GetNumFiles(), Seconds,
+            FolderIngestion->GetNumImported() / Seconds, FolderIngestion->GetNumFailed(), FolderIngestion->GetNumSkipped());
+        FolderIngestion.Reset();
+    }
+}
+
+bool UTextureGeneratorSubsystem::ImportIngestedImage(const FString& BaseName, const FImage& Image, bool bCreateMaterial)
+{
+    // Files named like existing assets were skipped by the ingestion, so this only creates new assets
+    FString PackageName;
+    UTexture2D* Texture = FTextureUtils::CreateTextureFromImage(Image, BaseName, PackageName);
+    if (!Texture)
+    {
+        return false;
+    }
+
+    FPendingSave PendingSave;
+    PendingSave.Texture = Texture;
+    PendingSave.Packages.Add(Texture->GetPackage());
+    PendingSave.bWriteAsync = true;
+
+    if (bCreateMaterial)
+    {
+        if (UMaterial* Material = FTextureUtils::CreateMaterialForTexture(Texture, BaseName, PackageName))
+        {
+            PendingSave.Packages.Add(Material->GetPackage());
+        }
+        else
+        {
+            UE_LOG(LogTextureGenerator, Warning, TEXT("Creating the material of %s failed."), *Texture->GetName());
+        }
+    }
+
+    PendingSaves.Add(MoveTemp(PendingSave));
+    return true;
+}
+
+bool UTextureGeneratorSubsystem::ImportJobResult(FTextureGenerationJobInfo& Job, const TArray<uint8>& ImageData, FString& OutError)
+{
+    const double DecodeStartTime = FPlatformTime::Seconds();
+
+    // Jobs coalesced into one request receive the same response back to back, decode it only once
+    if (!Job.ResultId.IsValid() || Job.ResultId != DecodedResultId)
+    {
+        DecodedResultId.Invalidate();
+        if (!FTextureUtils::DecodeImageData(ImageData, DecodedResult))
+        {
+            OutError = TEXT("Decoding the generated image failed.");
+            return false;
+        }
+        DecodedResultId = Job.ResultId;
+    }
+
+    const double ImportStartTime = FPlatformTime::Seconds();
+    Job.Timings.DecodeSeconds = ImportStartTime - DecodeStartTime;
+    Job.Timings.Width = DecodedResult.SizeX;
+    Job.Timings.Height = DecodedResult.SizeY;
+
+    const bool bImported = ImportJobImage(Job, DecodedResult, OutError);
+    Job.Timings.ImportSeconds = FPlatformTime::Seconds() - ImportStartTime;
+    return bImported;
+}
+
+bool UTextureGeneratorSubsystem::ImportJobImage(FTextureGenerationJobInfo& Job, const FImage& Image, FString& OutError)
+{
+    const FString BaseName = Job.Request.AssetName.IsEmpty() ? FGuid::NewGuid().ToString().Left(8) : Job.Request.AssetName;
+
+    // Unnamed edits go back into the reference texture, it keeps its own materials and metadata
+    const bool bEditsReference = Job.Request.IsInpainting() && Job.Request.AssetName.IsEmpty();
+
+    // Edits only received their region, blend it into the full reference image
+    const FImage* Result = &Image;
+    FImage EditedImage;
+    if (Job.Request.IsInpainting())
+    {
+        // Jobs resumed from the journal lost their snapshot, they are blended into the current reference
+        FInpaintSnapshot Snapshot;
+        if (FInpaintSnapshot* StoredSnapshot = InpaintSnapshots.Find(Job.JobId))
+        {
+            Snapshot = MoveTemp(*StoredSnapshot);
+            InpaintSnapshots.Remove(Job.JobId);
+        }
+        else if (!PrepareInpainting(Job.Request, Snapshot, OutError))
+        {
+            return false;
+        }
+
+        if (!FInpaintCompositor::Composite(Snapshot.Source, Snapshot.Mask, Snapshot.Region, Image, Job.Request.MaskFeather))
+        {
+            OutError = TEXT("Blending the regenerated region into the reference failed.");
+            return false;
+        }
+
+        // New textures are always BGRA8, the reference keeps its own format
+        if (bEditsReference && Snapshot.OriginalSource.RawData.Num() > 0)
+        {
+            FInpaintCompositor::WriteRegion(Snapshot.Source, Snapshot.Mask, Snapshot.Region, Job.Request.MaskFeather, Snapshot.OriginalSource);
+            EditedImage = MoveTemp(Snapshot.OriginalSource);
+        }
+        else
+        {
+            EditedImage = MoveTemp(Snapshot.Source);
+        }
+        Result = &EditedImage;
+    }
+
+    // Manifest entries replace the texture of their previous build in place, so materials referencing it pick up the new image
+    UTexture2D* ExistingTexture = nullptr;
+    if (bEditsReference)
+    {
+        ExistingTexture = Job.Request.ReferenceTexture;
+    }
+    else if (!Job.Request.ManifestName.IsEmpty())
+    {
+        ExistingTexture = Cast<UTexture2D>(FTextureUtils::FindGeneratedAsset(TEXT("T_") + BaseName));
+    }
+
+    // Save the generated image as texture asset
+    FString PackageName;
+    UTexture2D* NewTexture = ExistingTexture && FTextureUtils::UpdateTextureFromImage(ExistingTexture, *Result, !bEditsReference)
+        ? ExistingTexture
+        : FTextureUtils::CreateTextureFromImage(*Result, BaseName, PackageName);
+    if (!NewTexture)
+    {
+        OutError = TEXT("Creating texture from image data failed.");
+        return false;
+    }
+    Job.Texture = NewTexture;
+
+    // Remember what the texture was generated from, manifest builds compare it against the current inputs
+    if (!bEditsReference)
+    {
+        StoreProvenance(NewTexture, Job.Request, Job.Model, Job.ResultSeed);
+    }
+
+    FPendingSave PendingSave;
+    PendingSave.JobIds.Add(Job.JobId);
+    PendingSave.Texture = NewTexture;
+    PendingSave.Packages.Add(NewTexture->GetPackage());
+
+    TArray<UObject*> Objects;
+    Objects.Add(NewTexture);
+
+    // Derive the mask map, its packed material instance takes the place of the basic material
+    if (Job.Request.bCreateMaskMap && !bEditsReference)
+    {
+        UTexture2D* MaskMap = nullptr;
+        UMaterialInstanceConstant* MaterialInstance = nullptr;
+        bool bCreatedParent = false;
+        if (!ImportMaskMap(Job.Request, BaseName, NewTexture, *Result, MaskMap, MaterialInstance, bCreatedParent, OutError))
+        {
+            return false;
+        }
+        Job.MaskMap = MaskMap;
+
+        PendingSave.Packages.Add(MaskMap->GetPackage());
+        Objects.Add(MaskMap);
+
+        if (MaterialInstance)
+        {
+            Job.MaterialInstance = MaterialInstance;
+
+            PendingSave.Packages.Add(MaterialInstance->GetPackage());
+            Objects.Add(MaterialInstance);
+
+            // The shared parent is saved once, when it was created, not with every instance
+            if (bCreatedParent)
+            {
+                PendingSave.Packages.Add(MaterialInstance->Parent->GetPackage());
+            }
+        }
+    }
+    // Create a basic material utilizing the generated texture
+    else if (Job.Request.bCreateMaterial && !bEditsReference)
+    {
+        UMaterial* NewMaterial = ExistingTexture ? Cast<UMaterial>(FTextureUtils::FindGeneratedAsset(TEXT("M_") + BaseName)) : nullptr;
+        if (!NewMaterial)
+        {
+            NewMaterial = FTextureUtils::CreateMaterialForTexture(NewTexture, BaseName, PackageName);
+        }
+        if (!NewMaterial)
+        {
+            OutError = TEXT("Creating material from texture failed.");
+            return false;
+        }
+        Job.Material = NewMaterial;
+
+        PendingSave.Packages.Add(NewMaterial->GetPackage());
+        Objects.Add(NewMaterial);
+    }
+
+    // The texture compiles in the background, saving it now would block until the compression is done
+    PendingSaves.Add(MoveTemp(PendingSave));
+
+    // Shown in the Content Browser once the whole batch is imported
+    for (UObject* Object : Objects)
+    {
+        BrowserSyncObjects.Add(Object);
+    }
+
+    return true;
+}
+
+bool UTextureGeneratorSubsystem::ImportMaskMap(const FTextureGenerationRequest& Request, const FString& BaseName, UTexture2D* Texture, const FImage& Image,
+    UTexture2D*& OutMaskMap, UMaterialInstanceConstant*& OutMaterialInstance, bool& bOutCreatedParent, FString& OutError)
+{
+    bOutCreatedParent = false;
+
+    FImage MaskImage;
+    FMaskMapPacker::DeriveFromBaseColor(Image, Request.Metallic, MaskImage);
+
+    // Like the texture, the mask map of a manifest entry is replaced in place
+    FString PackageName;
+    UTexture2D* ExistingMaskMap = Request.ManifestName.IsEmpty() ? nullptr : Cast<UTexture2D>(FTextureUtils::FindGeneratedAsset(TEXT("T_") + BaseName + TEXT("_ORM")));
+    OutMaskMap = ExistingMaskMap && FTextureUtils::UpdateTextureFromImage(ExistingMaskMap, MaskImage)
+        ? ExistingMaskMap
+        : FTextureUtils::CreateMaskTextureFromImage(MaskImage, BaseName, PackageName);
+    if (!OutMaskMap)
+    {
+        OutError = TEXT("Creating mask map from texture failed.");
+        return false;
+    }
+
+    // The metallic value is not part of the input fingerprint, changing it only derives the mask map again
+    FTextureUtils::SetGeneratorMetaData(OutMaskMap, TextureGeneratorMetaData::Metallic, FString::SanitizeFloat(Request.Metallic));
+
+    OutMaterialInstance = nullptr;
+    if (Request.bCreateMaterial)
+    {
+        OutMaterialInstance = FTextureUtils::CreatePackedMaterialInstance(Texture, OutMaskMap, BaseName, PackageName, bOutCreatedParent);
+        if (!OutMaterialInstance)
+        {
+            OutError = TEXT("Creating packed material instance failed.");
+            return false;
+        }
+
+        // A manifest entry switched to mask maps leaves its basic material behind, its users move over to the instance
+        UMaterial* OldMaterial = Request.ManifestName.IsEmpty() ? nullptr : Cast<UMaterial>(FTextureUtils::FindGeneratedAsset(TEXT("M_") + BaseName));
+        if (OldMaterial)
+        {
+            TArray<UObject*> ObjectsToConsolidate;
+            ObjectsToConsolidate.Add(OldMaterial);
+            ObjectTools::ConsolidateObjects(OutMaterialInstance, ObjectsToConsolidate, false);
+        }
+    }
+
+    return true;
+}
+
+void UTextureGeneratorSubsystem::StoreProvenance(UObject* Asset, const FTextureGenerationRequest& Request, EImageGenerationModel Model, int64 ResultSeed)
+{
+    // A request without a seed records the one the service picked, so the result can be reproduced
+    const int64 Seed = Request.Seed > 0 ? Request.Seed : ResultSeed;
+
+    FTextureUtils::SetGeneratorMetaData(Asset, TextureGeneratorMetaData::Fingerprint, Request.GetInputFingerprint());
+    FTextureUtils::SetGeneratorMetaData(Asset, TextureGeneratorMetaData::Prompt, Request.Prompt);
+    FTextureUtils::SetGeneratorMetaData(Asset, TextureGeneratorMetaData::Model, StaticEnum<EImageGenerationModel>()->GetNameStringByValue(static_cast<int64>(Model)));
+    FTextureUtils::SetGeneratorMetaData(Asset, TextureGeneratorMetaData::Seed, LexToString(Seed));
+    FTextureUtils::SetGeneratorMetaData(Asset, TextureGeneratorMetaData::Created, FDateTime::UtcNow().ToIso8601());
+
+    if (!Request.NegativePrompt.IsEmpty())
+    {
+        FTextureUtils::SetGeneratorMetaData(Asset, TextureGeneratorMetaData::NegativePrompt, Request.NegativePrompt);
+    }
+    if (Request.StylePreset != EStylePreset::None)
+    {
+        FTextureUtils::SetGeneratorMetaData(Asset, TextureGeneratorMetaData::Style, StaticEnum<EStylePreset>()->GetNameStringByValue(static_cast<int64>(Request.StylePreset)));
+    }
+    if (Request.HasReference())
+    {
+        FTextureUtils::SetGeneratorMetaData(Asset, TextureGeneratorMetaData::Strength, FString::SanitizeFloat(Request.Strength));
+    }
+    if (!Request.ManifestName.IsEmpty())
+    {
+        FTextureUtils::SetGeneratorMetaData(Asset, TextureGeneratorMetaData::Manifest, Request.ManifestName);
+    }
+}
+
+bool UTextureGeneratorSubsystem::PrepareInpainting(const FTextureGenerationRequest& Request, FInpaintSnapshot& OutSnapshot, FString& OutError)
+{
+    if (!FInpaintCompositor::LoadImages(Request.ReferenceTexture, Request.MaskTexture, OutSnapshot.Source, OutSnapshot.Mask, OutError, &OutSnapshot.OriginalSource))
+    {
+        return false;
+    }
+
+    // The feathered edge has to fit into the margin, everything outside of the region stays untouched
+    OutSnapshot.Region = FInpaintCompositor::FindRegion(OutSnapshot.Mask, FMath::Max(Request.MaskMargin, Request.MaskFeather));
+    if (OutSnapshot.Region.IsEmpty())
+    {
+        OutError = TEXT("The mask does not mark any pixels to regenerate.");
+        return false;
+    }
+
+    return true;
+}
+
+void UTextureGeneratorSubsystem::SaveCompiledResults(bool bForce)
+{
+    TArray<UPackage*> PackagesToSave;
+    TArray<UPackage*> PackagesToWrite;
+    TArray<FGuid> SavedJobs;
+
+    for (int32 Index = 0; Index < PendingSaves.Num();)
+    {
+        FPendingSave& PendingSave = PendingSaves[Index];
+        UTexture* Texture = PendingSave.Texture.Get();
+        if (!bForce && Texture && Texture->IsCompiling())
+        {
+            ++Index;
+            continue;
+        }
+
+        for (const TWeakObjectPtr<UPackage>& Package : PendingSave.Packages)
+        {
+            if (Package.IsValid())
+            {
+                (PendingSave.bWriteAsync ? PackagesToWrite : PackagesToSave).AddUnique(Package.Get());
+            }
+        }
+        SavedJobs.Append(PendingSave.JobIds);
+
+        if (Texture)
+        {
+            DDCPublisher->Publish(Texture);
+        }
+
+        PendingSaves.RemoveAt(Index);
+    }
+
+    // Results finishing together are saved in one go, each job is charged an equal share of the save
+    if (PackagesToSave.Num() > 0)
+    {
+        const double SaveStartTime = FPlatformTime::Seconds();
+        UEditorLoadingAndSavingUtils::SavePackages(PackagesToSave, true);
+
+        const double SaveSeconds = (FPlatformTime::Seconds() - SaveStartTime) / FMath::Max(1, SavedJobs.Num());
+        for (const FGuid& JobId : SavedJobs)
+        {
+            if (FTextureGenerationJobInfo* Job = Jobs.Find(JobId))
+            {
+                Job->Timings.SaveSeconds = SaveSeconds;
+            }
+        }
+    }
+
+    for (const FGuid& JobId : SavedJobs)
+    {
+        const FTextureGenerationJobInfo* Job = Jobs.Find(JobId);
+        if (Job && Job->State == ETextureGenerationJobState::Completed)
+        {
+            RecordTelemetry(JobId);
+        }
+    }
+
+    // Ingested packages skip the editor's save and its source control checks, their files are written in the background
+    for (UPackage* Package : PackagesToWrite)
+    {
+        const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+
+        FSavePackageArgs SaveArgs;
+        SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+        SaveArgs.SaveFlags = SAVE_Async | SAVE_NoError;
+        if (!UPackage::SavePackage(Package, nullptr, *Filename, SaveArgs))
+        {
+            UE_LOG(LogTextureGenerator, Warning, TEXT("Failed to save %s."), *Package->GetName());
+        }
+    }
+
+    if (Journal.IsValid())
+    {
+        for (const FGuid& JobId : SavedJobs)
+        {
+            // Forgotten jobs may still have been journaled
+            const FTextureGenerationJobInfo* Job = Jobs.Find(JobId);
+            if (!Job || Job->bJournaled)
+            {
+                Journal->RecordImported(JobId);
+            }
+        }
+    }
+}
+
+void UTextureGeneratorSubsystem::RecordTelemetry(const FGuid& JobId)
+{
+    const FTextureGenerationJobInfo* Job = Jobs.Find(JobId);
+    if (Telemetry.IsValid() && Job)
+    {
+        Telemetry->Record(*Job);
+    }
+}
+
+void UTextureGeneratorSubsystem::AddVariantResult(const FGuid& JobId, const TArray<uint8>& ImageData)
+{
+    const FGuid SetId = VariantSetJobs.FindChecked(JobId);
+    FVariantSet& Set = VariantSets.FindChecked(SetId);
+
+    // Kept compressed until the whole set arrived, a set of decoded 4K variants would take hundreds of megabytes
+    Set.Results[Jobs.FindChecked(JobId).VariantIndex] = ImageData;
+
+    if (--Set.NumPending == 0)
+    {
+        BuildVariantSet(SetId);
+    }
+}
+
+void UTextureGeneratorSubsystem::ReleaseVariant(const FGuid& JobId)
+{
+    // Sets interrupted by the shutdown are not built
+    FGuid SetId;
+    if (bIsShuttingDown || !VariantSetJobs.RemoveAndCopyValue(JobId, SetId))
+    {
+        return;
+    }
+
+    FVariantSet& Set = VariantSets.FindChecked(SetId);
+    TArray<uint8>& Result = Set.Results[Jobs.FindChecked(JobId).VariantIndex];
+    if (Result.Num() > 0)
+    {
+        // Cancelled after its result arrived, it was already counted
+        Result.Empty();
+        return;
+    }
+
+    if (--Set.NumPending == 0)
+    {
+        BuildVariantSet(SetId);
+    }
+}
+
+void UTextureGeneratorSubsystem::BuildVariantSet(const FGuid& SetId)
+{
+    FVariantSet Set;
+    if (!VariantSets.RemoveAndCopyValue(SetId, Set))
+    {
+        return;
+    }
+
+    for (const FGuid& JobId : Set.JobIds)
+    {
+        VariantSetJobs.Remove(JobId);
+    }
+
+    // Failed and cancelled variants are left out, the remaining ones keep their order
+    TArray<FImage> Slices;
+    TArray<FGuid> SliceJobs;
+    for (int32 VariantIndex = 0; VariantIndex < Set.Results.Num(); ++VariantIndex)
+    {
+        if (Set.Results[VariantIndex].Num() == 0)
+        {
+            continue;
+        }
+
+        FImage Image;
+        const bool bDecoded = FTextureUtils::DecodeImageData(Set.Results[VariantIndex], Image);
+        Set.Results[VariantIndex].Empty();
+        if (!bDecoded)
+        {
+            FinishJob(Set.JobIds[VariantIndex], ETextureGenerationJobState::Failed, TEXT("Decoding the generated image failed."));
+            continue;
+        }
+
+        if (Slices.Num() > 0 && (Image.SizeX != Slices[0].SizeX || Image.SizeY != Slices[0].SizeY))
+        {
+            FinishJob(Set.JobIds[VariantIndex], ETextureGenerationJobState::Failed, TEXT("Variant size differs from the rest of the set."));
+            continue;
+        }
+
+        Slices.Add(MoveTemp(Image));
+        SliceJobs.Add(Set.JobIds[VariantIndex]);
+    }
+
+    if (Slices.Num() == 0)
+    {
+        return;
+    }
+
+    const FString& BaseName = Set.Request.AssetName;
+    FString PackageName;
+    FString ErrorMessage;
+
+    UMaterial* Material = nullptr;
+    UMaterialInstanceConstant* MaterialInstance = nullptr;
+    UTexture2DArray* TextureArray = FTextureUtils::CreateTextureArrayFromImages(Slices, BaseName, PackageName);
+    if (!TextureArray)
+    {
+        ErrorMessage = TEXT("Creating texture array from the variants failed.");
+    }
+    else
+    {
+        StoreProvenance(TextureArray, Set.Request, Jobs.FindChecked(SliceJobs[0]).Model, 0);
+
+        FPendingSave PendingSave;
+        PendingSave.Texture = TextureArray;
+        PendingSave.Packages.Add(TextureArray->GetPackage());
+
+        TArray<UObject*> Objects;
+        Objects.Add(TextureArray);
+
+        if (Set.Request.bCreateMaterial)
+        {
+            Material = FTextureUtils::CreateMaterialForTextureArray(TextureArray, BaseName, PackageName);
+            MaterialInstance = FTextureUtils::CreateMaterialInstance(Material, BaseName, PackageName);
+            if (!MaterialInstance)
+            {
+                ErrorMessage = TEXT("Creating material for the variants failed.");
+            }
+            else
+            {
+                PendingSave.Packages.Add(Material->GetPackage());
+                PendingSave.Packages.Add(MaterialInstance->GetPackage());
+                Objects.Add(MaterialInstance);
+            }
+        }
+
+        if (ErrorMessage.IsEmpty())
+        {
+            PendingSave.JobIds = SliceJobs;
+        }
+        PendingSaves.Add(MoveTemp(PendingSave));
+
+        // Shown in the Content Browser once the whole batch is imported
+        for (UObject* Object : Objects)
+        {
+            BrowserSyncObjects.Add(Object);
+        }
+    }
+
+    for (int32 SliceIndex = 0; SliceIndex < SliceJobs.Num(); ++SliceIndex)
+    {
+        FTextureGenerationJobInfo* Job = Jobs.Find(SliceJobs[SliceIndex]);
+        if (!Job || Job->IsFinished())
+        {
+            continue;
+        }
+
+        if (!ErrorMessage.IsEmpty())
+        {
+            FinishJob(SliceJobs[SliceIndex], ETextureGenerationJobState::Failed, ErrorMessage);
+            continue;
+        }
+
+        Job->TextureArray = TextureArray;
+        Job->VariantIndex = SliceIndex;
+        Job->Material = Material;
+        Job->MaterialInstance = MaterialInstance;
+        FinishJob(SliceJobs[SliceIndex], ETextureGenerationJobState::Completed);
+    }
+}
+
+void UTextureGeneratorSubsystem::AddTiledResult(const FGuid& JobId, const TArray<uint8>& ImageData)
+{
+    const FGuid SetId = TiledSetJobs.FindChecked(JobId);
+
+    FImage Image;
+    if (!FTextureUtils::DecodeImageData(ImageData, Image))
+    {
+        FinishJob(JobId, ETextureGenerationJobState::Failed, TEXT("Decoding the generated image failed."));
+        return;
+    }
+
+    FTiledSet& Set = TiledSets.FindChecked(SetId);
+    if (JobId == Set.GlobalJobId)
+    {
+        StartTiles(SetId, Image);
+        return;
+    }
+
+    Set.TileImages[Set.TileJobIds.IndexOfByKey(JobId)] = MoveTemp(Image);
+    TiledSetJobs.Remove(JobId);
+    const bool bLastTile = --Set.NumPending == 0;
+
+    // Tiles are internal steps, they finish without assets of their own
+    FinishJob(JobId, ETextureGenerationJobState::Completed);
+
+    if (bLastTile)
+    {
+        BuildTiledTexture(SetId);
+    }
+}
+
+void UTextureGeneratorSubsystem::StartTiles(const FGuid& SetId, const FImage& GlobalImage)
+{
+    FTiledSet& Set = TiledSets.FindChecked(SetId);
+
+    const float Scale = static_cast<float>(Set.OutputSize) / FMath::Max(GlobalImage.SizeX, GlobalImage.SizeY);
+    const int32 Width = FMath::Max(1, FMath::RoundToInt(GlobalImage.SizeX * Scale));
+    const int32 Height = FMath::Max(1, FMath::RoundToInt(GlobalImage.SizeY * Scale));
+    GlobalImage.ResizeTo(Set.Canvas, Width, Height, ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+
+    Set.Tiles = FTiledCompositor::SplitIntoTiles(FIntPoint(Width, Height), Set.TileSize, Set.Overlap);
+    Set.TileImages.SetNum(Set.Tiles.Num());
+    Set.NumPending = Set.Tiles.Num();
+
+    // Every tile refines its part of the scaled global pass, the queue runs up to MaxConcurrentRequests of them side by side
+    FTextureGenerationRequest TileRequest = Set.Request;
+    TileRequest.ReferenceTexture = nullptr;
+    TileRequest.ReferenceImageFile.Empty();
+    TileRequest.Strength = Set.TileStrength;
+    TileRequest.AssetName.Empty();
+    TileRequest.ManifestName.Empty();
+    TileRequest.bCreateMaterial = false;
+
+    for (const FIntRect& Tile : Set.Tiles)
+    {
+        TArray<uint8> TileData;
+        if (!FTiledCompositor::EncodeTile(Set.Canvas, Tile, TileData))
+        {
+            // The scaled global pass stays visible in place of the tile
+            Set.TileJobIds.Add(FGuid());
+            --Set.NumPending;
+            continue;
+        }
+
+        const FGuid TileJobId = EnqueueJob(TileRequest, false);
+        Jobs.FindChecked(TileJobId).ReferenceImageData = MoveTemp(TileData);
+        TiledSetJobs.Add(TileJobId, SetId);
+        Set.TileJobIds.Add(TileJobId);
+    }
+
+    UE_LOG(LogTextureGenerator, Log, TEXT("Refining %dx%d texture in %d tiles of up to %d px."), Width, Height, Set.Tiles.Num(), Set.TileSize);
+
+    if (Set.NumPending == 0)
+    {
+        BuildTiledTexture(SetId);
+    }
+}
+
+void UTextureGeneratorSubsystem::ReleaseTiledJob(const FGuid& JobId)
+{
+    // Tiled textures interrupted by the shutdown are not built
+    FGuid SetId;
+    if (bIsShuttingDown || !TiledSetJobs.RemoveAndCopyValue(JobId, SetId))
+    {
+        return;
+    }
+
+    FTiledSet& Set = TiledSets.FindChecked(SetId);
+    if (JobId == Set.GlobalJobId)
+    {
+        // Without the global pass there is nothing left to build, drop the tiles still running
+        const TArray<FGuid> TileJobIds = Set.TileJobIds;
+        TiledSets.Remove(SetId);
+        for (const FGuid& TileJobId : TileJobIds)
+        {
+            TiledSetJobs.Remove(TileJobId);
+            CancelJob(TileJobId);
+        }
+        return;
+    }
+
+    // Failed tiles leave the scaled global pass visible
+    if (--Set.NumPending == 0)
+    {
+        BuildTiledTexture(SetId);
+    }
+}
+
+void UTextureGeneratorSubsystem::BuildTiledTexture(const FGuid& SetId)
+{
+    FTiledSet Set;
+    if (!TiledSets.RemoveAndCopyValue(SetId, Set))
+    {
+        return;
+    }
+    TiledSetJobs.Remove(Set.GlobalJobId);
+
+    FTextureGenerationJobInfo* Job = Jobs.Find(Set.GlobalJobId);
+    if (!Job || Job->IsFinished())
+    {
+        return;
+    }
+
+    FTiledCompositor::Blend(Set.Canvas, Set.Tiles, Set.TileImages);
+
+    FString ErrorMessage;
+    if (!ImportJobImage(*Job, Set.Canvas, ErrorMessage))
+    {
+        FinishJob(Set.GlobalJobId, ETextureGenerationJobState::Failed, ErrorMessage);
+        return;
+    }
+
+    FinishJob(Set.GlobalJobId, ETextureGenerationJobState::Completed);
+}
@@ -0,0 +1,163 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Subsystems/TextureManifest.h"
+#include "TextureGeneratorSettings.h"
+#include "Utils/TextureUtils.h"
+
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Engine/Texture2D.h"
+#include "JsonObjectConverter.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialInstanceConstant.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace TextureManifest
+{
+    // Generated assets carry their provenance as tags, only those saved before it was indexed need to be loaded
+    static FString GetAssetTag(const FAssetData& Asset, const TCHAR* Key)
+    {
+        FString Value;
+        if (Asset.FindTag(FName(TextureGeneratorMetaData::Prompt)))
+        {
+            FTextureUtils::GetGeneratorTag(Asset, Key, Value);
+        }
+        else
+        {
+            Value = FTextureUtils::GetGeneratorMetaData(Asset.GetAsset(), Key);
+        }
+        return Value;
+    }
+}
+
+bool FTextureManifest::Load(const FString& Filename, FTextureGenerationManifest& OutManifest, FString& OutError)
+{
+    FString Json;
+    if (!FFileHelper::LoadFileToString(Json, *Filename))
+    {
+        OutError = FString::Printf(TEXT("Could not read %s."), *Filename);
+        return false;
+    }
+
+    OutManifest = FTextureGenerationManifest();
+    if (!FJsonObjectConverter::JsonObjectStringToUStruct(Json, &OutManifest))
+    {
+        OutError = FString::Printf(TEXT("%s is not a valid texture manifest."), *Filename);
+        return false;
+    }
+
+    const FString ManifestName = FPaths::GetBaseFilename(Filename);
+
+    TSet<FString> AssetNames;
+    for (FTextureGenerationRequest& Entry : OutManifest.Entries)
+    {
+        // Entries are matched with their assets by name, random names would generate a new asset on every build
+        if (Entry.AssetName.IsEmpty())
+        {
+            OutError = FString::Printf(TEXT("Entry with prompt '%s' has no asset name."), *Entry.Prompt);
+            return false;
+        }
+
+        bool bAlreadyInSet = false;
+        AssetNames.Add(Entry.AssetName, &bAlreadyInSet);
+        if (bAlreadyInSet)
+        {
+            OutError = FString::Printf(TEXT("Asset name '%s' is used by more than one entry."), *Entry.AssetName);
+            return false;
+        }
+
+        Entry.ManifestName = ManifestName;
+    }
+
+    return true;
+}
+
+TArray<FTextureManifestEntryStatus> FTextureManifest::Plan(const FTextureGenerationManifest& Manifest, const FString& ManifestName)
+{
+    using namespace TextureManifest;
+
+    TArray<FTextureManifestEntryStatus> Statuses;
+    TSet<FString> AssetNames;
+
+    // Every check goes through the asset registry, so planning a manifest of thousands of up to date entries loads nothing
+    FString PackagePath = GetDefault<UTextureGeneratorSettings>()->DefaultAssetPath;
+    PackagePath.RemoveFromEnd(TEXT("/"));
+
+    TArray<FAssetData> Assets;
+    IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+    AssetRegistry.GetAssetsByPath(FName(*PackagePath), Assets);
+
+    TMap<FName, const FAssetData*> AssetsByName;
+    AssetsByName.Reserve(Assets.Num());
+    for (const FAssetData& Asset : Assets)
+    {
+        AssetsByName.Add(Asset.AssetName, &Asset);
+    }
+
+    auto HasAsset = [&AssetsByName](const FString& AssetName, const UClass* Class)
+    {
+        const FAssetData* const* Asset = AssetsByName.Find(FName(*AssetName));
+        return Asset && (*Asset)->IsInstanceOf(Class);
+    };
+
+    // Mask maps saved before the metallic value was recorded are derived again once
+    auto HasMetallic = [&AssetsByName](const FString& AssetName, float Metallic)
+    {
+        const FAssetData* const* Asset = AssetsByName.Find(FName(*AssetName));
+        FString Value;
+        return Asset && FTextureUtils::GetGeneratorTag(**Asset, TextureGeneratorMetaData::Metallic, Value) && Value == FString::SanitizeFloat(Metallic);
+    };
+
+    for (const FTextureGenerationRequest& Entry : Manifest.Entries)
+    {
+        AssetNames.Add(Entry.AssetName);
+
+        FTextureManifestEntryStatus& Status = Statuses.AddDefaulted_GetRef();
+        Status.AssetName = Entry.AssetName;
+
+        const FAssetData* const* Texture = AssetsByName.Find(FName(TEXT("T_") + Entry.AssetName));
+        if (!Texture || !(*Texture)->IsInstanceOf(UTexture2D::StaticClass()))
+        {
+            Status.Action = ETextureManifestAction::Generate;
+        }
+        else if (GetAssetTag(**Texture, TextureGeneratorMetaData::Fingerprint) != Entry.GetInputFingerprint())
+        {
+            Status.Action = ETextureManifestAction::Regenerate;
+        }
+        else if (Entry.bCreateMaskMap
+            && (!HasAsset(TEXT("T_") + Entry.AssetName + TEXT("_ORM"), UTexture2D::StaticClass())
+                || !HasMetallic(TEXT("T_") + Entry.AssetName + TEXT("_ORM"), Entry.Metallic)
+                || (Entry.bCreateMaterial && !HasAsset(TEXT("MI_") + Entry.AssetName, UMaterialInstanceConstant::StaticClass()))))
+        {
+            // Mask maps are derived from the texture, enabling them later or changing their metallic value does not need a new image
+            Status.Action = ETextureManifestAction::Reimport;
+        }
+        else if (!Entry.bCreateMaskMap && Entry.bCreateMaterial && !HasAsset(TEXT("M_") + Entry.AssetName, UMaterial::StaticClass()))
+        {
+            Status.Action = ETextureManifestAction::Reimport;
+        }
+        else
+        {
+            Status.Action = ETextureManifestAction::UpToDate;
+        }
+    }
+
+    // Textures generated from this manifest which no longer have an entry
+    for (const FAssetData& Asset : Assets)
+    {
+        const FString AssetName = Asset.AssetName.ToString();
+        if (!Asset.IsInstanceOf(UTexture2D::StaticClass()) || !AssetName.StartsWith(TEXT("T_")) || AssetNames.Contains(AssetName.RightChop(2)))
+        {
+            continue;
+        }
+
+        if (GetAssetTag(Asset, TextureGeneratorMetaData::Manifest) == ManifestName)
+        {
+            FTextureManifestEntryStatus& Status = Statuses.AddDefaulted_GetRef();
+            Status.AssetName = AssetName.RightChop(2);
+            Status.Action = ETextureManifestAction::Delete;
+        }
+    }
+
+    return Statuses;
+}
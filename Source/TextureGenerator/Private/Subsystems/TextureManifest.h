@@ -0,0 +1,28 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/TextureGenerationTypes.h"
+
+/**
+ * Loads texture manifests and diffs them against the assets generated from them, like a build system
+ * comparing inputs against outputs. Every generated texture carries the fingerprint of its inputs
+ * in its package metadata, so only entries whose inputs changed need another API call.
+ */
+class FTextureManifest
+{
+public:
+    /**
+     * Loads a manifest from a JSON file, e.g. {"entries": [{"assetName": "Bricks", "prompt": "..."}]}.
+     * Every entry gets the manifest name assigned, which is the base name of the file.
+     * @return false when the file cannot be parsed, or entries do not have unique asset names
+     */
+    static bool Load(const FString& Filename, FTextureGenerationManifest& OutManifest, FString& OutError);
+
+    /**
+     * Compares the manifest with the existing assets.
+     * @return The action needed for every entry in manifest order, followed by the assets to delete
+     */
+    static TArray<FTextureManifestEntryStatus> Plan(const FTextureGenerationManifest& Manifest, const FString& ManifestName);
+};
@@ -13,6 +13,14 @@ void FTextureGeneratorCommands::RegisterCommands()
         EUserInterfaceActionType::Button,
         FInputChord()
     );
+
+    UI_COMMAND(
+        OpenMemoryReport,
+        "Generated Texture Memory",
+        "Show the memory cost of the generated textures and flag expensive import settings",
+        EUserInterfaceActionType::Button,
+        FInputChord()
+    );
 }
 
 #undef LOCTEXT_NAMESPACE
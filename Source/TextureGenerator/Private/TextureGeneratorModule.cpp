@@ -5,6 +5,8 @@
 #include "TextureGeneratorCommands.h"
 #include "TextureGeneratorSettings.h"
 #include "Widgets/STextureGeneratorWidget.h"
+#include "Widgets/STextureMemoryReport.h"
+#include "Utils/TextureUtils.h"
 #include "Misc/MessageDialog.h"
 #include "ToolMenus.h"
 #include "Widgets/Docking/SDockTab.h"
@@ -22,6 +24,7 @@
 DEFINE_LOG_CATEGORY(LogTextureGenerator);
 
 static const FName TextureGeneratorTabName("TextureGenerator");
+static const FName MemoryReportTabName("TextureGeneratorMemoryReport");
 
 #define LOCTEXT_NAMESPACE "FTextureGeneratorModule"
 
@@ -34,6 +37,9 @@ void FTextureGeneratorModule::StartupModule()
     // Register commands
     FTextureGeneratorCommands::Register();
 
+    // Make provenance of generated assets searchable without loading them
+    FTextureUtils::RegisterMetaDataTags();
+
     // Register plugin settings
     if (ISettingsModule* SettingsModule = FModuleManager::GetModulePtr<ISettingsModule>("Settings"))
     {
@@ -50,6 +56,10 @@ void FTextureGeneratorModule::StartupModule()
         FTextureGeneratorCommands::Get().OpenPluginWindow,
         FExecuteAction::CreateRaw(this, &FTextureGeneratorModule::PluginButtonClicked),
         FCanExecuteAction());
+    PluginCommands->MapAction(
+        FTextureGeneratorCommands::Get().OpenMemoryReport,
+        FExecuteAction::CreateRaw(this, &FTextureGeneratorModule::MemoryReportClicked),
+        FCanExecuteAction());
 
     UToolMenus::RegisterStartupCallback(FSimpleMulticastDelegate::FDelegate::CreateRaw(this, &FTextureGeneratorModule::RegisterMenus));
     
@@ -59,6 +69,12 @@ void FTextureGeneratorModule::StartupModule()
         FOnSpawnTab::CreateRaw(this, &FTextureGeneratorModule::OnSpawnPluginTab))
         .SetDisplayName(LOCTEXT("TextureGeneratorTabTitle", "Stability AI Texture Generator"))
         .SetMenuType(ETabSpawnerMenuType::Hidden);
+
+    FGlobalTabmanager::Get()->RegisterNomadTabSpawner(
+        MemoryReportTabName,
+        FOnSpawnTab::CreateRaw(this, &FTextureGeneratorModule::OnSpawnMemoryReportTab))
+        .SetDisplayName(LOCTEXT("MemoryReportTabTitle", "Generated Texture Memory"))
+        .SetMenuType(ETabSpawnerMenuType::Hidden);
 }
 
 void FTextureGeneratorModule::ShutdownModule()
@@ -71,11 +87,14 @@ void FTextureGeneratorModule::ShutdownModule()
     
     // Unregister tab spawner
     FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(TextureGeneratorTabName);
+    FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(MemoryReportTabName);
     
     // Unregister menu
     UToolMenus::UnRegisterStartupCallback(this);
     UToolMenus::UnregisterOwner(this);
     
+    FTextureUtils::UnregisterMetaDataTags();
+
     // Unregister commands
     FTextureGeneratorStyle::Shutdown();
     FTextureGeneratorCommands::Unregister();
@@ -86,6 +105,11 @@ void FTextureGeneratorModule::PluginButtonClicked()
     FGlobalTabmanager::Get()->TryInvokeTab(TextureGeneratorTabName);
 }
 
+void FTextureGeneratorModule::MemoryReportClicked()
+{
+    FGlobalTabmanager::Get()->TryInvokeTab(MemoryReportTabName);
+}
+
 void FTextureGeneratorModule::RegisterMenus()
 {
     // Owner will be used for cleanup in call to UToolMenus::UnregisterOwner
@@ -96,6 +120,7 @@ void FTextureGeneratorModule::RegisterMenus()
     {
         FToolMenuSection& Section = Menu->FindOrAddSection("WindowLayout");
         Section.AddMenuEntryWithCommandList(FTextureGeneratorCommands::Get().OpenPluginWindow, PluginCommands);
+        Section.AddMenuEntryWithCommandList(FTextureGeneratorCommands::Get().OpenMemoryReport, PluginCommands);
     }
     
     // Add toolbar button
@@ -123,6 +148,15 @@ TSharedRef<SDockTab> FTextureGeneratorModule::OnSpawnPluginTab(const FSpawnTabAr
         ];
 }
 
+TSharedRef<SDockTab> FTextureGeneratorModule::OnSpawnMemoryReportTab(const FSpawnTabArgs& SpawnTabArgs)
+{
+    return SNew(SDockTab)
+        .TabRole(ETabRole::NomadTab)
+        [
+            SNew(STextureMemoryReport)
+        ];
+}
+
 #undef LOCTEXT_NAMESPACE
 
 IMPLEMENT_MODULE(FTextureGeneratorModule, TextureGenerator)
@@ -0,0 +1,315 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Utils/InpaintCompositor.h"
+
+#include "Engine/Texture2D.h"
+#include "ImageUtils.h"
+
+namespace InpaintCompositor
+{
+    // Masks are grayscale, any channel would do
+    FORCEINLINE uint8 GetMaskValue(const FColor& Color)
+    {
+        return Color.R;
+    }
+
+    // Grows the [Min, Max) range to at least MinSize, shifting it to stay within [0, Size)
+    static void GrowRange(int32& Min, int32& Max, int32 MinSize, int32 Size)
+    {
+        const int32 Missing = FMath::Min(MinSize, Size) - (Max - Min);
+        if (Missing <= 0)
+        {
+            return;
+        }
+
+        Min -= Missing / 2;
+        Max += Missing - Missing / 2;
+        if (Min < 0)
+        {
+            Max -= Min;
+            Min = 0;
+        }
+        if (Max > Size)
+        {
+            Min -= Max - Size;
+            Max = Size;
+        }
+    }
+
+    // Box filter of the mask over the region as integer window sums, so pixels out of reach of the mask get an exact zero weight
+    static void FilterMask(const FImage& Mask, const FIntRect& Region, int32 Radius, TArray<int32>& OutWindowSums)
+    {
+        const int32 Width = Region.Width();
+        const int32 Height = Region.Height();
+        const FColor* MaskPixels = reinterpret_cast<const FColor*>(Mask.RawData.GetData());
+
+        TArray<int32> RowSums;
+        RowSums.SetNumUninitialized(Width * Height);
+        TArray<int64> Prefix;
+        Prefix.SetNumUninitialized(FMath::Max(Width, Height) + 1);
+
+        for (int32 Y = 0; Y < Height; ++Y)
+        {
+            const FColor* MaskRow = MaskPixels + static_cast<int64>(Region.Min.Y + Y) * Mask.SizeX + Region.Min.X;
+            Prefix[0] = 0;
+            for (int32 X = 0; X < Width; ++X)
+            {
+                Prefix[X + 1] = Prefix[X] + GetMaskValue(MaskRow[X]);
+            }
+            for (int32 X = 0; X < Width; ++X)
+            {
+                RowSums[Y * Width + X] = static_cast<int32>(Prefix[FMath::Min(X + Radius + 1, Width)] - Prefix[FMath::Max(X - Radius, 0)]);
+            }
+        }
+
+        OutWindowSums.SetNumUninitialized(Width * Height);
+        for (int32 X = 0; X < Width; ++X)
+        {
+            Prefix[0] = 0;
+            for (int32 Y = 0; Y < Height; ++Y)
+            {
+                Prefix[Y + 1] = Prefix[Y] + RowSums[Y * Width + X];
+            }
+            for (int32 Y = 0; Y < Height; ++Y)
+            {
+                OutWindowSums[Y * Width + X] = static_cast<int32>(Prefix[FMath::Min(Y + Radius + 1, Height)] - Prefix[FMath::Max(Y - Radius, 0)]);
+            }
+        }
+    }
+
+    // Copies the region of an image into an image of its own
+    static void CopyRegion(const FImage& Image, const FIntRect& Region, FImage& OutRegion)
+    {
+        const int64 BytesPerPixel = Image.GetBytesPerPixel();
+        OutRegion.Init(Region.Width(), Region.Height(), Image.Format, Image.GammaSpace);
+        for (int32 Y = 0; Y < Region.Height(); ++Y)
+        {
+            const int64 SourceOffset = (static_cast<int64>(Region.Min.Y + Y) * Image.SizeX + Region.Min.X) * BytesPerPixel;
+            FMemory::Memcpy(OutRegion.RawData.GetData() + Y * Region.Width() * BytesPerPixel, Image.RawData.GetData() + SourceOffset, Region.Width() * BytesPerPixel);
+        }
+    }
+}
+
+bool FInpaintCompositor::LoadImages(UTexture2D* SourceTexture, UTexture2D* MaskTexture, FImage& OutSource, FImage& OutMask, FString& OutError,
+    FImage* OutOriginalSource)
+{
+    if (!SourceTexture || !MaskTexture)
+    {
+        OutError = TEXT("Inpainting needs both a reference texture and a mask.");
+        return false;
+    }
+
+    if (!FImageUtils::GetTexture2DSourceImage(SourceTexture, OutSource))
+    {
+        OutError = FString::Printf(TEXT("Failed to read the source image of %s."), *SourceTexture->GetName());
+        return false;
+    }
+
+    // High precision and linear sources are edited in 8 bit sRGB, the original lets the rest of the image keep its values
+    if (OutOriginalSource)
+    {
+        *OutOriginalSource = FImage();
+        if (OutSource.Format != ERawImageFormat::BGRA8 || OutSource.GammaSpace != EGammaSpace::sRGB)
+        {
+            *OutOriginalSource = OutSource;
+        }
+    }
+    OutSource.ChangeFormat(ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+
+    FImage Mask;
+    if (!FImageUtils::GetTexture2DSourceImage(MaskTexture, Mask))
+    {
+        OutError = FString::Printf(TEXT("Failed to read the source image of %s."), *MaskTexture->GetName());
+        return false;
+    }
+
+    // Keep the gamma space of the mask, its values are weights rather than colors
+    if (Mask.SizeX != OutSource.SizeX || Mask.SizeY != OutSource.SizeY)
+    {
+        Mask.ResizeTo(OutMask, OutSource.SizeX, OutSource.SizeY, ERawImageFormat::BGRA8, Mask.GammaSpace);
+    }
+    else
+    {
+        Mask.CopyTo(OutMask, ERawImageFormat::BGRA8, Mask.GammaSpace);
+    }
+
+    return true;
+}
+
+FIntRect FInpaintCompositor::FindRegion(const FImage& Mask, int32 Margin)
+{
+    const FColor* Pixels = reinterpret_cast<const FColor*>(Mask.RawData.GetData());
+
+    int32 MinX = Mask.SizeX;
+    int32 MinY = Mask.SizeY;
+    int32 MaxX = -1;
+    int32 MaxY = -1;
+    for (int32 Y = 0; Y < Mask.SizeY; ++Y)
+    {
+        const FColor* Row = Pixels + static_cast<int64>(Y) * Mask.SizeX;
+        for (int32 X = 0; X < Mask.SizeX; ++X)
+        {
+            if (InpaintCompositor::GetMaskValue(Row[X]) > 0)
+            {
+                MinX = FMath::Min(MinX, X);
+                MaxX = FMath::Max(MaxX, X);
+                MinY = FMath::Min(MinY, Y);
+                MaxY = Y;
+            }
+        }
+    }
+
+    if (MaxX < 0)
+    {
+        return FIntRect();
+    }
+
+    Margin = FMath::Max(0, Margin);
+    FIntRect Region(MinX - Margin, MinY - Margin, MaxX + 1 + Margin, MaxY + 1 + Margin);
+    Region.Clip(FIntRect(0, 0, Mask.SizeX, Mask.SizeY));
+
+    InpaintCompositor::GrowRange(Region.Min.X, Region.Max.X, MinRegionSize, Mask.SizeX);
+    InpaintCompositor::GrowRange(Region.Min.Y, Region.Max.Y, MinRegionSize, Mask.SizeY);
+
+    return Region;
+}
+
+bool FInpaintCompositor::EncodeRegion(const FImage& Source, const FImage& Mask, const FIntRect& Region, TArray<uint8>& OutImageData, TArray<uint8>& OutMaskData)
+{
+    const int32 Width = Region.Width();
+    const int32 Height = Region.Height();
+    if (Width <= 0 || Height <= 0)
+    {
+        return false;
+    }
+
+    FImage SourceRegion(Width, Height, ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+    FImage MaskRegion(Width, Height, ERawImageFormat::G8, EGammaSpace::Linear);
+
+    const FColor* SourcePixels = reinterpret_cast<const FColor*>(Source.RawData.GetData());
+    const FColor* MaskPixels = reinterpret_cast<const FColor*>(Mask.RawData.GetData());
+    FColor* SourceRegionPixels = reinterpret_cast<FColor*>(SourceRegion.RawData.GetData());
+
+    for (int32 Y = 0; Y < Height; ++Y)
+    {
+        const int64 SourceRow = static_cast<int64>(Region.Min.Y + Y) * Source.SizeX + Region.Min.X;
+        FMemory::Memcpy(SourceRegionPixels + static_cast<int64>(Y) * Width, SourcePixels + SourceRow, Width * sizeof(FColor));
+
+        uint8* MaskRow = MaskRegion.RawData.GetData() + static_cast<int64>(Y) * Width;
+        for (int32 X = 0; X < Width; ++X)
+        {
+            MaskRow[X] = InpaintCompositor::GetMaskValue(MaskPixels[SourceRow + X]);
+        }
+    }
+
+    TArray64<uint8> ImageData;
+    TArray64<uint8> MaskData;
+    if (!FImageUtils::CompressImage(ImageData, TEXT("png"), SourceRegion) || !FImageUtils::CompressImage(MaskData, TEXT("png"), MaskRegion))
+    {
+        return false;
+    }
+
+    OutImageData = TArray<uint8>(ImageData);
+    OutMaskData = TArray<uint8>(MaskData);
+    return true;
+}
+
+bool FInpaintCompositor::Composite(FImage& Image, const FImage& Mask, const FIntRect& Region, const FImage& Patch, int32 FeatherRadius)
+{
+    const int32 Width = Region.Width();
+    const int32 Height = Region.Height();
+    if (Width <= 0 || Height <= 0 || Image.Format != ERawImageFormat::BGRA8 || Patch.SizeX <= 0 || Patch.SizeY <= 0)
+    {
+        return false;
+    }
+
+    // The endpoint may round the size of the result, scale it back onto the region
+    FImage ResizedPatch;
+    const FImage* RegionPatch = &Patch;
+    if (Patch.SizeX != Width || Patch.SizeY != Height || Patch.Format != ERawImageFormat::BGRA8)
+    {
+        Patch.ResizeTo(ResizedPatch, Width, Height, ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+        RegionPatch = &ResizedPatch;
+    }
+
+    const int32 Radius = FMath::Clamp(FeatherRadius, 0, 256);
+    TArray<int32> WindowSums;
+    InpaintCompositor::FilterMask(Mask, Region, Radius, WindowSums);
+
+    // Doubling the filtered mask keeps the masked area fully replaced and fades out over the radius around it
+    const float WeightScale = 2.0f / (FMath::Square(2 * Radius + 1) * 255.0f);
+
+    FColor* ImagePixels = reinterpret_cast<FColor*>(Image.RawData.GetData());
+    const FColor* PatchPixels = reinterpret_cast<const FColor*>(RegionPatch->RawData.GetData());
+
+    for (int32 Y = 0; Y < Height; ++Y)
+    {
+        FColor* ImageRow = ImagePixels + static_cast<int64>(Region.Min.Y + Y) * Image.SizeX + Region.Min.X;
+        for (int32 X = 0; X < Width; ++X)
+        {
+            const int32 WindowSum = WindowSums[Y * Width + X];
+            if (WindowSum == 0)
+            {
+                continue;
+            }
+
+            const float Weight = FMath::Min(1.0f, WindowSum * WeightScale);
+            const FColor& PatchColor = PatchPixels[Y * Width + X];
+            FColor& Color = ImageRow[X];
+            Color.R = static_cast<uint8>(FMath::RoundToInt(FMath::Lerp(static_cast<float>(Color.R), static_cast<float>(PatchColor.R), Weight)));
+            Color.G = static_cast<uint8>(FMath::RoundToInt(FMath::Lerp(static_cast<float>(Color.G), static_cast<float>(PatchColor.G), Weight)));
+            Color.B = static_cast<uint8>(FMath::RoundToInt(FMath::Lerp(static_cast<float>(Color.B), static_cast<float>(PatchColor.B), Weight)));
+        }
+    }
+
+    return true;
+}
+
+void FInpaintCompositor::WriteRegion(const FImage& Composited, const FImage& Mask, const FIntRect& Region, int32 FeatherRadius, FImage& Image)
+{
+    check(Composited.Format == ERawImageFormat::BGRA8 && Composited.SizeX == Image.SizeX && Composited.SizeY == Image.SizeY);
+
+    const int32 Width = Region.Width();
+    const int32 Height = Region.Height();
+    if (Width <= 0 || Height <= 0)
+    {
+        return;
+    }
+
+    // Same weights as the composite, pixels it left alone are not written at all
+    TArray<int32> WindowSums;
+    InpaintCompositor::FilterMask(Mask, Region, FMath::Clamp(FeatherRadius, 0, 256), WindowSums);
+
+    FImage Patch;
+    FImage Original;
+    InpaintCompositor::CopyRegion(Composited, Region, Patch);
+    InpaintCompositor::CopyRegion(Image, Region, Original);
+    Patch.ChangeFormat(ERawImageFormat::RGBA32F, EGammaSpace::Linear);
+    Original.ChangeFormat(ERawImageFormat::RGBA32F, EGammaSpace::Linear);
+
+    // Written pixels take the blended color and keep their alpha, which went through 8 bits in the composite
+    const FLinearColor* PatchPixels = reinterpret_cast<const FLinearColor*>(Patch.RawData.GetData());
+    FLinearColor* OriginalPixels = reinterpret_cast<FLinearColor*>(Original.RawData.GetData());
+    for (int32 Index = 0; Index < Width * Height; ++Index)
+    {
+        if (WindowSums[Index] != 0)
+        {
+            OriginalPixels[Index] = FLinearColor(PatchPixels[Index].R, PatchPixels[Index].G, PatchPixels[Index].B, OriginalPixels[Index].A);
+        }
+    }
+    Original.ChangeFormat(Image.Format, Image.GammaSpace);
+
+    const int64 BytesPerPixel = Image.GetBytesPerPixel();
+    for (int32 Y = 0; Y < Height; ++Y)
+    {
+        const int64 TargetOffset = (static_cast<int64>(Region.Min.Y + Y) * Image.SizeX + Region.Min.X) * BytesPerPixel;
+        for (int32 X = 0; X < Width; ++X)
+        {
+            if (WindowSums[Y * Width + X] != 0)
+            {
+                FMemory::Memcpy(Image.RawData.GetData() + TargetOffset + X * BytesPerPixel,
+                    Original.RawData.GetData() + (static_cast<int64>(Y) * Width + X) * BytesPerPixel, BytesPerPixel);
+            }
+        }
+    }
+}
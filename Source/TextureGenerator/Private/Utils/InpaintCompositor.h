@@ -0,0 +1,54 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageCore.h"
+
+class UTexture2D;
+
+/**
+ * Masked region edits of generated textures. Only the bounding box of the mask, grown by a margin of context,
+ * is sent to the inpaint endpoint, and the returned patch is blended back with a feathered mask,
+ * so pixels away from the mask keep their exact values.
+ */
+class FInpaintCompositor
+{
+public:
+    /** Smallest region side accepted by the inpaint endpoint */
+    static constexpr int32 MinRegionSize = 64;
+
+    /**
+     * Reads the source texture as a BGRA8 sRGB image and the mask as a BGRA8 image of the same size,
+     * white marking the pixels to regenerate. Masks of a different size are resized to the source.
+     * OutOriginalSource receives the source in its own format when that is not BGRA8 sRGB, and is left empty otherwise.
+     */
+    static bool LoadImages(UTexture2D* SourceTexture, UTexture2D* MaskTexture, FImage& OutSource, FImage& OutMask, FString& OutError,
+        FImage* OutOriginalSource = nullptr);
+
+    /**
+     * Bounding box of the masked pixels grown by the margin on every side, clamped to the image
+     * and grown further to at least MinRegionSize where the image allows it.
+     * @return The region, empty when nothing is masked
+     */
+    static FIntRect FindRegion(const FImage& Mask, int32 Margin);
+
+    /**
+     * Encodes the region of the source and the mask as PNG for the inpaint request.
+     * The mask is written as grayscale, an alpha channel would be read as the mask instead.
+     */
+    static bool EncodeRegion(const FImage& Source, const FImage& Mask, const FIntRect& Region, TArray<uint8>& OutImageData, TArray<uint8>& OutMaskData);
+
+    /**
+     * Blends the regenerated patch into the region of the image. The mask is feathered outwards over FeatherRadius pixels,
+     * pixels outside of it and the alpha channel keep their values. Patches of a different size than the region are resized to it.
+     */
+    static bool Composite(FImage& Image, const FImage& Mask, const FIntRect& Region, const FImage& Patch, int32 FeatherRadius);
+
+    /**
+     * Copies the pixels Composite blended into a composited BGRA8 image to the same sized image in any other format,
+     * given the same mask, region and feather radius. Only the regenerated pixels go through the 8 bit conversion,
+     * the rest of the region and the alpha channel keep their values.
+     */
+    static void WriteRegion(const FImage& Composited, const FImage& Mask, const FIntRect& Region, int32 FeatherRadius, FImage& Image);
+};
@@ -0,0 +1,162 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Utils/MaskMapPacker.h"
+
+#include "Async/ParallelFor.h"
+
+namespace MaskMapPacker
+{
+    FORCEINLINE uint8 ToByte(float Value)
+    {
+        return static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Value * 255.0f), 0, 255));
+    }
+
+    // Box filter of the given radius, rows and columns in parallel
+    static void BoxBlur(const TArray<float>& Source, int32 Width, int32 Height, int32 Radius, TArray<float>& OutBlurred)
+    {
+        TArray<float> Horizontal;
+        Horizontal.SetNumUninitialized(Source.Num());
+        ParallelFor(Height, [&Source, &Horizontal, Width, Radius](int32 Y)
+        {
+            const float* Row = Source.GetData() + static_cast<int64>(Y) * Width;
+            float* OutRow = Horizontal.GetData() + static_cast<int64>(Y) * Width;
+
+            TArray<double> Prefix;
+            Prefix.SetNumUninitialized(Width + 1);
+            Prefix[0] = 0.0;
+            for (int32 X = 0; X < Width; ++X)
+            {
+                Prefix[X + 1] = Prefix[X] + Row[X];
+            }
+            for (int32 X = 0; X < Width; ++X)
+            {
+                const int32 Min = FMath::Max(X - Radius, 0);
+                const int32 Max = FMath::Min(X + Radius + 1, Width);
+                OutRow[X] = static_cast<float>((Prefix[Max] - Prefix[Min]) / (Max - Min));
+            }
+        });
+
+        OutBlurred.SetNumUninitialized(Source.Num());
+        ParallelFor(Width, [&Horizontal, &OutBlurred, Width, Height, Radius](int32 X)
+        {
+            TArray<double> Prefix;
+            Prefix.SetNumUninitialized(Height + 1);
+            Prefix[0] = 0.0;
+            for (int32 Y = 0; Y < Height; ++Y)
+            {
+                Prefix[Y + 1] = Prefix[Y] + Horizontal[static_cast<int64>(Y) * Width + X];
+            }
+            for (int32 Y = 0; Y < Height; ++Y)
+            {
+                const int32 Min = FMath::Max(Y - Radius, 0);
+                const int32 Max = FMath::Min(Y + Radius + 1, Height);
+                OutBlurred[static_cast<int64>(Y) * Width + X] = static_cast<float>((Prefix[Max] - Prefix[Min]) / (Max - Min));
+            }
+        });
+    }
+
+    // BGRA8 copy of a map at the given size, keeping its gamma space since the values are not colors
+    static const FImage* PrepareMap(const FImage* Map, int32 Width, int32 Height, FImage& Storage)
+    {
+        if (!Map || (Map->SizeX == Width && Map->SizeY == Height && Map->Format == ERawImageFormat::BGRA8))
+        {
+            return Map;
+        }
+
+        if (Map->SizeX != Width || Map->SizeY != Height)
+        {
+            Map->ResizeTo(Storage, Width, Height, ERawImageFormat::BGRA8, Map->GammaSpace);
+        }
+        else
+        {
+            Map->CopyTo(Storage, ERawImageFormat::BGRA8, Map->GammaSpace);
+        }
+        return &Storage;
+    }
+}
+
+void FMaskMapPacker::DeriveFromBaseColor(const FImage& BaseColor, float Metallic, FImage& OutMaskMap)
+{
+    check(BaseColor.Format == ERawImageFormat::BGRA8);
+
+    const int32 Width = BaseColor.SizeX;
+    const int32 Height = BaseColor.SizeY;
+    const FColor* Pixels = reinterpret_cast<const FColor*>(BaseColor.RawData.GetData());
+
+    TArray<float> Luminance;
+    Luminance.SetNumUninitialized(static_cast<int64>(Width) * Height);
+    ParallelFor(Height, [&Luminance, Pixels, Width](int32 Y)
+    {
+        const int64 RowStart = static_cast<int64>(Y) * Width;
+        for (int32 X = 0; X < Width; ++X)
+        {
+            const FColor& Color = Pixels[RowStart + X];
+            Luminance[RowStart + X] = (0.2126f * Color.R + 0.7152f * Color.G + 0.0722f * Color.B) / 255.0f;
+        }
+    });
+
+    // Cavities and detail are measured against the surroundings within about 1/64 of the image
+    TArray<float> Surroundings;
+    MaskMapPacker::BoxBlur(Luminance, Width, Height, FMath::Max(2, FMath::Min(Width, Height) / 64), Surroundings);
+
+    OutMaskMap.Init(Width, Height, ERawImageFormat::BGRA8, EGammaSpace::Linear);
+    FColor* MaskPixels = reinterpret_cast<FColor*>(OutMaskMap.RawData.GetData());
+    const uint8 MetallicValue = MaskMapPacker::ToByte(Metallic);
+
+    ParallelFor(Height, [&Luminance, &Surroundings, MaskPixels, Width, MetallicValue](int32 Y)
+    {
+        const int64 RowStart = static_cast<int64>(Y) * Width;
+        for (int32 X = 0; X < Width; ++X)
+        {
+            const float Value = Luminance[RowStart + X];
+            const float Difference = Surroundings[RowStart + X] - Value;
+
+            const float Occlusion = 1.0f - 3.0f * FMath::Max(0.0f, Difference);
+            const float Roughness = 0.4f + 0.5f * (1.0f - Value) + FMath::Abs(Difference);
+
+            // Occlusion, roughness and metallic go to red, green and blue
+            MaskPixels[RowStart + X] = FColor(MaskMapPacker::ToByte(Occlusion), MaskMapPacker::ToByte(Roughness), MetallicValue, 255);
+        }
+    });
+}
+
+bool FMaskMapPacker::Pack(const FImage* Occlusion, const FImage* Roughness, const FImage* Metallic, FImage& OutMaskMap)
+{
+    const FImage* First = Occlusion ? Occlusion : (Roughness ? Roughness : Metallic);
+    if (!First || First->SizeX <= 0 || First->SizeY <= 0)
+    {
+        return false;
+    }
+
+    const int32 Width = First->SizeX;
+    const int32 Height = First->SizeY;
+
+    FImage Storage[3];
+    const FImage* Maps[3] =
+    {
+        MaskMapPacker::PrepareMap(Occlusion, Width, Height, Storage[0]),
+        MaskMapPacker::PrepareMap(Roughness, Width, Height, Storage[1]),
+        MaskMapPacker::PrepareMap(Metallic, Width, Height, Storage[2])
+    };
+    const uint8 Defaults[3] = { DefaultOcclusion, DefaultRoughness, DefaultMetallic };
+
+    OutMaskMap.Init(Width, Height, ERawImageFormat::BGRA8, EGammaSpace::Linear);
+    FColor* MaskPixels = reinterpret_cast<FColor*>(OutMaskMap.RawData.GetData());
+
+    ParallelFor(Height, [&Maps, &Defaults, MaskPixels, Width](int32 Y)
+    {
+        const int64 RowStart = static_cast<int64>(Y) * Width;
+        for (int32 X = 0; X < Width; ++X)
+        {
+            uint8 Values[3];
+            for (int32 Channel = 0; Channel < 3; ++Channel)
+            {
+                // The first channel of a BGRA8 grayscale map, any channel would do
+                Values[Channel] = Maps[Channel] ? reinterpret_cast<const FColor*>(Maps[Channel]->RawData.GetData())[RowStart + X].R : Defaults[Channel];
+            }
+            MaskPixels[RowStart + X] = FColor(Values[0], Values[1], Values[2], 255);
+        }
+    });
+
+    return true;
+}
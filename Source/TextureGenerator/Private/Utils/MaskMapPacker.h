@@ -0,0 +1,33 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageCore.h"
+
+/**
+ * Builds occlusion/roughness/metallic mask maps, packed into the red, green and blue channel of one linear BGRA8 image.
+ * One mask compressed texture sampled once replaces three grayscale textures and samplers.
+ */
+class FMaskMapPacker
+{
+public:
+    /** Values of channels without an input map: fully lit, fully rough and not metallic. */
+    static constexpr uint8 DefaultOcclusion = 255;
+    static constexpr uint8 DefaultRoughness = 255;
+    static constexpr uint8 DefaultMetallic = 0;
+
+    /**
+     * Derives a mask map from a BGRA8 base color image, in parallel. Occlusion darkens cavities, pixels darker than
+     * their surroundings, and roughness follows darkness and local detail. These are approximations for generated
+     * textures without authored maps. Metallic is constant.
+     */
+    static void DeriveFromBaseColor(const FImage& BaseColor, float Metallic, FImage& OutMaskMap);
+
+    /**
+     * Packs separate grayscale maps, reading their first channel. Maps of a different size than the first given one
+     * are resized to it, missing maps get the default value of their channel.
+     * @return Whether at least one map was given
+     */
+    static bool Pack(const FImage* Occlusion, const FImage* Roughness, const FImage* Metallic, FImage& OutMaskMap);
+};
@@ -0,0 +1,885 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Utils/PixelKernels.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+    #define TEXTUREGENERATOR_PIXEL_KERNELS_NEON 1
+    #include <arm_neon.h>
+#elif PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_CPU_X86_FAMILY
+    // SSE2 is part of x64, AVX2 is only used when the whole build targets it
+    #define TEXTUREGENERATOR_PIXEL_KERNELS_SSE2 1
+    #include <emmintrin.h>
+    #if PLATFORM_ALWAYS_HAS_AVX_2
+        #define TEXTUREGENERATOR_PIXEL_KERNELS_AVX2 1
+        #include <immintrin.h>
+    #endif
+#endif
+
+#ifndef TEXTUREGENERATOR_PIXEL_KERNELS_NEON
+    #define TEXTUREGENERATOR_PIXEL_KERNELS_NEON 0
+#endif
+#ifndef TEXTUREGENERATOR_PIXEL_KERNELS_SSE2
+    #define TEXTUREGENERATOR_PIXEL_KERNELS_SSE2 0
+#endif
+#ifndef TEXTUREGENERATOR_PIXEL_KERNELS_AVX2
+    #define TEXTUREGENERATOR_PIXEL_KERNELS_AVX2 0
+#endif
+
+namespace PixelKernels
+{
+    // Resolution of the linear to sRGB table, fine enough to stay within one step of the exact conversion
+    static constexpr int32 LinearToSRGBTableSize = 4096;
+    static constexpr float LinearToSRGBScale = static_cast<float>(LinearToSRGBTableSize - 1);
+
+    static constexpr float InvMaxValue = 1.0f / 255.0f;
+
+    struct FTables
+    {
+        float SRGBToLinear[256];
+        uint8 LinearToSRGB[LinearToSRGBTableSize];
+
+        FTables()
+        {
+            for (int32 Index = 0; Index < 256; ++Index)
+            {
+                const double Encoded = Index / 255.0;
+                SRGBToLinear[Index] = static_cast<float>(Encoded <= 0.04045 ? Encoded / 12.92 : FMath::Pow((Encoded + 0.055) / 1.055, 2.4));
+            }
+
+            for (int32 Index = 0; Index < LinearToSRGBTableSize; ++Index)
+            {
+                const double Linear = Index / static_cast<double>(LinearToSRGBTableSize - 1);
+                const double Encoded = Linear <= 0.0031308 ? Linear * 12.92 : 1.055 * FMath::Pow(Linear, 1.0 / 2.4) - 0.055;
+                LinearToSRGB[Index] = static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Encoded * 255.0), 0, 255));
+            }
+        }
+    };
+
+    static const FTables& GetTables()
+    {
+        static const FTables Tables;
+        return Tables;
+    }
+
+    // Clamps to [0, 1], NaN becoming 0, and scales with round to nearest. Kept in separate statements,
+    // so the compiler cannot fuse the multiply and add, which would break bit-exactness with the vector paths.
+    FORCEINLINE int32 QuantizeUnit(float Value, float Scale)
+    {
+        Value = Value > 0.0f ? Value : 0.0f;
+        Value = Value < 1.0f ? Value : 1.0f;
+        const float Scaled = Value * Scale;
+        const float Rounded = Scaled + 0.5f;
+        return static_cast<int32>(Rounded);
+    }
+
+    FORCEINLINE uint8 Premultiply(uint32 Value, uint32 Alpha)
+    {
+        // Exact round(Value * Alpha / 255)
+        const uint32 Product = Value * Alpha + 128;
+        return static_cast<uint8>((Product + (Product >> 8)) >> 8);
+    }
+
+    FORCEINLINE uint8 Unpremultiply(uint32 Value, uint32 Alpha)
+    {
+        if (Alpha == 0)
+        {
+            return 0;
+        }
+
+        const uint32 Result = (Value * 255 + Alpha / 2) / Alpha;
+        return static_cast<uint8>(Result < 255 ? Result : 255);
+    }
+
+    // Gradients of the noise lattice, picked by the low three bits of a corner hash: axes first, then diagonals
+    static constexpr float GradientDiagonal = 0.70710678f;
+    static constexpr float NoiseGradients[8][2] =
+    {
+        { 1.0f, 0.0f }, { -1.0f, 0.0f }, { 0.0f, 1.0f }, { 0.0f, -1.0f },
+        { GradientDiagonal, GradientDiagonal }, { -GradientDiagonal, GradientDiagonal }, { GradientDiagonal, -GradientDiagonal }, { -GradientDiagonal, -GradientDiagonal }
+    };
+
+    // Scales the interpolated noise to about [-1, 1]
+    static constexpr float NoiseScale = 1.41421356f;
+
+    FORCEINLINE uint32 HashLattice(uint32 X, uint32 Y, uint32 Seed)
+    {
+        uint32 Value = (X * 0x8da6b343u) ^ (Y * 0xd8163841u) ^ (Seed * 0xcb1ab31fu);
+        Value ^= Value >> 16;
+        Value *= 0x7feb352du;
+        Value ^= Value >> 15;
+        Value *= 0x846ca68bu;
+        Value ^= Value >> 16;
+        return Value;
+    }
+
+    FORCEINLINE int32 WrapLattice(int32 Value, int32 Period)
+    {
+        const int32 Remainder = Value % Period;
+        return Remainder < 0 ? Remainder + Period : Remainder;
+    }
+
+    // The noise helpers below keep one operation per statement for the same reason as QuantizeUnit
+    FORCEINLINE float Fade(float T)
+    {
+        float Polynomial = T * 6.0f;
+        Polynomial = Polynomial - 15.0f;
+        Polynomial = Polynomial * T;
+        Polynomial = Polynomial + 10.0f;
+        const float Square = T * T;
+        const float Cube = Square * T;
+        return Cube * Polynomial;
+    }
+
+    FORCEINLINE float LerpNoise(float A, float B, float Alpha)
+    {
+        const float Difference = B - A;
+        const float Step = Difference * Alpha;
+        return A + Step;
+    }
+
+    FORCEINLINE float GradientDot(int32 X, int32 Y, int32 Period, uint32 Seed, float DX, float DY)
+    {
+        const float* Gradient = NoiseGradients[HashLattice(WrapLattice(X, Period), WrapLattice(Y, Period), Seed) & 7];
+        const float AlongX = Gradient[0] * DX;
+        const float AlongY = Gradient[1] * DY;
+        return AlongX + AlongY;
+    }
+
+    // Gradient noise on a lattice repeating every Period cells
+    static float PeriodicNoise(float X, float Y, int32 Period, uint32 Seed)
+    {
+        const int32 X0 = FMath::FloorToInt32(X);
+        const int32 Y0 = FMath::FloorToInt32(Y);
+        const float FX = X - static_cast<float>(X0);
+        const float FY = Y - static_cast<float>(Y0);
+        const float FX1 = FX - 1.0f;
+        const float FY1 = FY - 1.0f;
+
+        const float U = Fade(FX);
+        const float V = Fade(FY);
+        const float Bottom = LerpNoise(GradientDot(X0, Y0, Period, Seed, FX, FY), GradientDot(X0 + 1, Y0, Period, Seed, FX1, FY), U);
+        const float Top = LerpNoise(GradientDot(X0, Y0 + 1, Period, Seed, FX, FY1), GradientDot(X0 + 1, Y0 + 1, Period, Seed, FX1, FY1), U);
+        return LerpNoise(Bottom, Top, V) * NoiseScale;
+    }
+
+    // Sum of the octave amplitudes, the same for every pixel
+    FORCEINLINE float FractalNoiseNorm(int32 NumOctaves)
+    {
+        float Norm = 0.0f;
+        float Amplitude = 1.0f;
+        for (int32 Octave = 0; Octave < NumOctaves; ++Octave)
+        {
+            Norm = Norm + Amplitude;
+            Amplitude = Amplitude * 0.5f;
+        }
+        return Norm;
+    }
+
+    // Fractal noise of the columns from FirstColumn to the end of a row, Dst pointing at the start of the row
+    static void FractalNoiseColumns(int32 Row, int32 Size, int32 FirstColumn, int32 BasePeriod, int32 NumOctaves, uint32 Seed, float* Dst)
+    {
+        const float InvSize = 1.0f / static_cast<float>(Size);
+        const float V = (static_cast<float>(Row) + 0.5f) * InvSize;
+        const float Norm = FractalNoiseNorm(NumOctaves);
+        for (int32 X = FirstColumn; X < Size; ++X)
+        {
+            const float U = (static_cast<float>(X) + 0.5f) * InvSize;
+
+            float Sum = 0.0f;
+            float Amplitude = 1.0f;
+            int32 Period = BasePeriod;
+            for (int32 Octave = 0; Octave < NumOctaves; ++Octave)
+            {
+                const float Scale = static_cast<float>(Period);
+                const float Noise = PeriodicNoise(U * Scale, V * Scale, Period, Seed + Octave);
+                const float Weighted = Amplitude * Noise;
+                Sum = Sum + Weighted;
+                Amplitude = Amplitude * 0.5f;
+                Period *= 2;
+            }
+
+            const float Centered = 0.5f * (Sum / Norm);
+            const float Value = 0.5f + Centered;
+            Dst[X] = Value > 0.0f ? (Value < 1.0f ? Value : 1.0f) : 0.0f;
+        }
+    }
+}
+
+void FPixelKernels::FScalar::SwizzleRedBlue(const uint8* Src, uint8* Dst, int64 NumPixels)
+{
+    for (int64 Index = 0; Index < NumPixels; ++Index, Src += 4, Dst += 4)
+    {
+        const uint8 Red = Src[0];
+        const uint8 Green = Src[1];
+        const uint8 Blue = Src[2];
+        const uint8 Alpha = Src[3];
+        Dst[0] = Blue;
+        Dst[1] = Green;
+        Dst[2] = Red;
+        Dst[3] = Alpha;
+    }
+}
+
+void FPixelKernels::FScalar::SRGBToLinear(const uint8* Src, float* Dst, int64 NumPixels)
+{
+    const PixelKernels::FTables& Tables = PixelKernels::GetTables();
+    for (int64 Index = 0; Index < NumPixels; ++Index, Src += 4, Dst += 4)
+    {
+        Dst[0] = Tables.SRGBToLinear[Src[0]];
+        Dst[1] = Tables.SRGBToLinear[Src[1]];
+        Dst[2] = Tables.SRGBToLinear[Src[2]];
+        Dst[3] = static_cast<float>(Src[3]) * PixelKernels::InvMaxValue;
+    }
+}
+
+void FPixelKernels::FScalar::LinearToSRGB(const float* Src, uint8* Dst, int64 NumPixels)
+{
+    using namespace PixelKernels;
+
+    const FTables& Tables = GetTables();
+    for (int64 Index = 0; Index < NumPixels; ++Index, Src += 4, Dst += 4)
+    {
+        Dst[0] = Tables.LinearToSRGB[QuantizeUnit(Src[0], LinearToSRGBScale)];
+        Dst[1] = Tables.LinearToSRGB[QuantizeUnit(Src[1], LinearToSRGBScale)];
+        Dst[2] = Tables.LinearToSRGB[QuantizeUnit(Src[2], LinearToSRGBScale)];
+        Dst[3] = static_cast<uint8>(QuantizeUnit(Src[3], 255.0f));
+    }
+}
+
+void FPixelKernels::FScalar::Expand8To16(const uint8* Src, uint16* Dst, int64 NumValues)
+{
+    for (int64 Index = 0; Index < NumValues; ++Index)
+    {
+        Dst[Index] = static_cast<uint16>((Src[Index] << 8) | Src[Index]);
+    }
+}
+
+void FPixelKernels::FScalar::ConvertToFloat(const uint8* Src, float* Dst, int64 NumValues)
+{
+    for (int64 Index = 0; Index < NumValues; ++Index)
+    {
+        Dst[Index] = static_cast<float>(Src[Index]) * PixelKernels::InvMaxValue;
+    }
+}
+
+void FPixelKernels::FScalar::PremultiplyAlpha(uint8* Pixels, int64 NumPixels)
+{
+    for (int64 Index = 0; Index < NumPixels; ++Index, Pixels += 4)
+    {
+        const uint32 Alpha = Pixels[3];
+        Pixels[0] = PixelKernels::Premultiply(Pixels[0], Alpha);
+        Pixels[1] = PixelKernels::Premultiply(Pixels[1], Alpha);
+        Pixels[2] = PixelKernels::Premultiply(Pixels[2], Alpha);
+    }
+}
+
+void FPixelKernels::FScalar::UnpremultiplyAlpha(uint8* Pixels, int64 NumPixels)
+{
+    for (int64 Index = 0; Index < NumPixels; ++Index, Pixels += 4)
+    {
+        const uint32 Alpha = Pixels[3];
+        Pixels[0] = PixelKernels::Unpremultiply(Pixels[0], Alpha);
+        Pixels[1] = PixelKernels::Unpremultiply(Pixels[1], Alpha);
+        Pixels[2] = PixelKernels::Unpremultiply(Pixels[2], Alpha);
+    }
+}
+
+void FPixelKernels::FScalar::FractalNoiseRow(int32 Row, int32 Size, int32 BasePeriod, int32 NumOctaves, uint32 Seed, float* Dst)
+{
+    PixelKernels::FractalNoiseColumns(Row, Size, 0, BasePeriod, NumOctaves, Seed, Dst);
+}
+
+const TCHAR* FPixelKernels::GetVectorPathName()
+{
+#if TEXTUREGENERATOR_PIXEL_KERNELS_AVX2
+    return TEXT("AVX2");
+#elif TEXTUREGENERATOR_PIXEL_KERNELS_SSE2
+    return TEXT("SSE2");
+#elif TEXTUREGENERATOR_PIXEL_KERNELS_NEON
+    return TEXT("NEON");
+#else
+    return TEXT("Scalar");
+#endif
+}
+
+// Each vector path handles whole blocks and leaves the remainder to the scalar reference
+
+void FPixelKernels::SwizzleRedBlue(const uint8* Src, uint8* Dst, int64 NumPixels)
+{
+    int64 Index = 0;
+
+#if TEXTUREGENERATOR_PIXEL_KERNELS_AVX2
+    const __m256i Shuffle = _mm256_setr_epi8(
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    for (; Index + 8 <= NumPixels; Index += 8)
+    {
+        const __m256i Pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Src + Index * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(Dst + Index * 4), _mm256_shuffle_epi8(Pixels, Shuffle));
+    }
+#elif TEXTUREGENERATOR_PIXEL_KERNELS_SSE2
+    // Without byte shuffles, swap the bytes with shifts on 32 bit pixels
+    const __m128i GreenAlphaMask = _mm_set1_epi32(static_cast<int32>(0xFF00FF00));
+    const __m128i LowByteMask = _mm_set1_epi32(0x000000FF);
+    for (; Index + 4 <= NumPixels; Index += 4)
+    {
+        const __m128i Pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + Index * 4));
+        const __m128i GreenAlpha = _mm_and_si128(Pixels, GreenAlphaMask);
+        const __m128i First = _mm_slli_epi32(_mm_and_si128(Pixels, LowByteMask), 16);
+        const __m128i Third = _mm_and_si128(_mm_srli_epi32(Pixels, 16), LowByteMask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + Index * 4), _mm_or_si128(GreenAlpha, _mm_or_si128(First, Third)));
+    }
+#elif TEXTUREGENERATOR_PIXEL_KERNELS_NEON
+    for (; Index + 16 <= NumPixels; Index += 16)
+    {
+        uint8x16x4_t Pixels = vld4q_u8(Src + Index * 4);
+        const uint8x16_t First = Pixels.val[0];
+        Pixels.val[0] = Pixels.val[2];
+        Pixels.val[2] = First;
+        vst4q_u8(Dst + Index * 4, Pixels);
+    }
+#endif
+
+    FScalar::SwizzleRedBlue(Src + Index * 4, Dst + Index * 4, NumPixels - Index);
+}
+
+void FPixelKernels::SRGBToLinear(const uint8* Src, float* Dst, int64 NumPixels)
+{
+    int64 Index = 0;
+
+#if TEXTUREGENERATOR_PIXEL_KERNELS_AVX2
+    // Only AVX2 can gather from the table, the other paths are bound by the table loads anyway
+    const float* Table = PixelKernels::GetTables().SRGBToLinear;
+    const __m256 InvMaxValue = _mm256_set1_ps(PixelKernels::InvMaxValue);
+    for (; Index + 2 <= NumPixels; Index += 2)
+    {
+        const __m256i Values = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(Src + Index * 4)));
+        const __m256 Color = _mm256_i32gather_ps(Table, Values, 4);
+        const __m256 Alpha = _mm256_mul_ps(_mm256_cvtepi32_ps(Values), InvMaxValue);
+        _mm256_storeu_ps(Dst + Index * 4, _mm256_blend_ps(Color, Alpha, 0x88));
+    }
+#endif
+
+    FScalar::SRGBToLinear(Src + Index * 4, Dst + Index * 4, NumPixels - Index);
+}
+
+void FPixelKernels::LinearToSRGB(const float* Src, uint8* Dst, int64 NumPixels)
+{
+    int64 Index = 0;
+
+#if TEXTUREGENERATOR_PIXEL_KERNELS_SSE2
+    const uint8* Table = PixelKernels::GetTables().LinearToSRGB;
+    const __m128 Zero = _mm_setzero_ps();
+    const __m128 One = _mm_set1_ps(1.0f);
+    const __m128 Half = _mm_set1_ps(0.5f);
+    const __m128 Scale = _mm_setr_ps(PixelKernels::LinearToSRGBScale, PixelKernels::LinearToSRGBScale, PixelKernels::LinearToSRGBScale, 255.0f);
+    for (; Index < NumPixels; ++Index)
+    {
+        // Max returns its second operand for NaN, which maps NaN to 0 like the scalar path
+        __m128 Values = _mm_max_ps(_mm_loadu_ps(Src + Index * 4), Zero);
+        Values = _mm_min_ps(Values, One);
+        Values = _mm_add_ps(_mm_mul_ps(Values, Scale), Half);
+
+        alignas(16) int32 Quantized[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(Quantized), _mm_cvttps_epi32(Values));
+
+        uint8* Pixel = Dst + Index * 4;
+        Pixel[0] = Table[Quantized[0]];
+        Pixel[1] = Table[Quantized[1]];
+        Pixel[2] = Table[Quantized[2]];
+        Pixel[3] = static_cast<uint8>(Quantized[3]);
+    }
+#elif TEXTUREGENERATOR_PIXEL_KERNELS_NEON
+    const uint8* Table = PixelKernels::GetTables().LinearToSRGB;
+    const float32x4_t Zero = vdupq_n_f32(0.0f);
+    const float32x4_t One = vdupq_n_f32(1.0f);
+    const float32x4_t Half = vdupq_n_f32(0.5f);
+    const float ScaleValues[4] = { PixelKernels::LinearToSRGBScale, PixelKernels::LinearToSRGBScale, PixelKernels::LinearToSRGBScale, 255.0f };
+    const float32x4_t Scale = vld1q_f32(ScaleValues);
+    for (; Index < NumPixels; ++Index)
+    {
+        // The "number" variant of max ignores NaN, mapping it to 0 like the scalar path
+        float32x4_t Values = vmaxnmq_f32(vld1q_f32(Src + Index * 4), Zero);
+        Values = vminq_f32(Values, One);
+        Values = vmulq_f32(Values, Scale);
+        Values = vaddq_f32(Values, Half);
+
+        int32 Quantized[4];
+        vst1q_s32(Quantized, vcvtq_s32_f32(Values));
+
+        uint8* Pixel = Dst + Index * 4;
+        Pixel[0] = Table[Quantized[0]];
+        Pixel[1] = Table[Quantized[1]];
+        Pixel[2] = Table[Quantized[2]];
+        Pixel[3] = static_cast<uint8>(Quantized[3]);
+    }
+#endif
+
+    FScalar::LinearToSRGB(Src + Index * 4, Dst + Index * 4, NumPixels - Index);
+}
+
+void FPixelKernels::Expand8To16(const uint8* Src, uint16* Dst, int64 NumValues)
+{
+    int64 Index = 0;
+
+#if TEXTUREGENERATOR_PIXEL_KERNELS_AVX2
+    for (; Index + 32 <= NumValues; Index += 32)
+    {
+        // Unpacking works within 128 bit lanes, reorder the quadwords first so the output stays in order
+        const __m256i Values = _mm256_permute4x64_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Src + Index)), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(Dst + Index), _mm256_unpacklo_epi8(Values, Values));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(Dst + Index + 16), _mm256_unpackhi_epi8(Values, Values));
+    }
+#elif TEXTUREGENERATOR_PIXEL_KERNELS_SSE2
+    for (; Index + 16 <= NumValues; Index += 16)
+    {
+        // Interleaving a byte with itself gives Value * 257
+        const __m128i Values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + Index));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + Index), _mm_unpacklo_epi8(Values, Values));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + Index + 8), _mm_unpackhi_epi8(Values, Values));
+    }
+#elif TEXTUREGENERATOR_PIXEL_KERNELS_NEON
+    for (; Index + 16 <= NumValues; Index += 16)
+    {
+        const uint8x16_t Values = vld1q_u8(Src + Index);
+        vst1q_u16(Dst + Index, vreinterpretq_u16_u8(vzip1q_u8(Values, Values)));
+        vst1q_u16(Dst + Index + 8, vreinterpretq_u16_u8(vzip2q_u8(Values, Values)));
+    }
+#endif
+
+    FScalar::Expand8To16(Src + Index, Dst + Index, NumValues - Index);
+}
+
+void FPixelKernels::ConvertToFloat(const uint8* Src, float* Dst, int64 NumValues)
+{
+    int64 Index = 0;
+
+#if TEXTUREGENERATOR_PIXEL_KERNELS_AVX2
+    const __m256 InvMaxValue = _mm256_set1_ps(PixelKernels::InvMaxValue);
+    for (; Index + 8 <= NumValues; Index += 8)
+    {
+        const __m256i Values = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(Src + Index)));
+        _mm256_storeu_ps(Dst + Index, _mm256_mul_ps(_mm256_cvtepi32_ps(Values), InvMaxValue));
+    }
+#elif TEXTUREGENERATOR_PIXEL_KERNELS_SSE2
+    const __m128 InvMaxValue = _mm_set1_ps(PixelKernels::InvMaxValue);
+    const __m128i Zero = _mm_setzero_si128();
+    for (; Index + 16 <= NumValues; Index += 16)
+    {
+        const __m128i Values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + Index));
+        const __m128i Low = _mm_unpacklo_epi8(Values, Zero);
+        const __m128i High = _mm_unpackhi_epi8(Values, Zero);
+        _mm_storeu_ps(Dst + Index, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(Low, Zero)), InvMaxValue));
+        _mm_storeu_ps(Dst + Index + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(Low, Zero)), InvMaxValue));
+        _mm_storeu_ps(Dst + Index + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(High, Zero)), InvMaxValue));
+        _mm_storeu_ps(Dst + Index + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(High, Zero)), InvMaxValue));
+    }
+#elif TEXTUREGENERATOR_PIXEL_KERNELS_NEON
+    for (; Index + 8 <= NumValues; Index += 8)
+    {
+        const uint16x8_t Values = vmovl_u8(vld1_u8(Src + Index));
+        vst1q_f32(Dst + Index, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(Values))), PixelKernels::InvMaxValue));
+        vst1q_f32(Dst + Index + 4, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(Values))), PixelKernels::InvMaxValue));
+    }
+#endif
+
+    FScalar::ConvertToFloat(Src + Index, Dst + Index, NumValues - Index);
+}
+
+#if TEXTUREGENERATOR_PIXEL_KERNELS_SSE2
+namespace PixelKernels
+{
+    // Premultiplies two pixels widened to 16 bit, keeping their alpha
+    FORCEINLINE __m128i PremultiplyWide(__m128i Values)
+    {
+        const __m128i AlphaMask = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+        const __m128i Alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(Values, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128i Product = _mm_add_epi16(_mm_mullo_epi16(Values, Alpha), _mm_set1_epi16(128));
+        const __m128i Result = _mm_srli_epi16(_mm_add_epi16(Product, _mm_srli_epi16(Product, 8)), 8);
+        return _mm_or_si128(_mm_andnot_si128(AlphaMask, Result), _mm_and_si128(AlphaMask, Values));
+    }
+
+    // Unpremultiplies a single pixel widened to 32 bit, keeping its alpha
+    FORCEINLINE __m128i UnpremultiplyWide(__m128i Values)
+    {
+        const __m128i AlphaMask = _mm_setr_epi32(0, 0, 0, -1);
+        const __m128i Alpha = _mm_shuffle_epi32(Values, _MM_SHUFFLE(3, 3, 3, 3));
+
+        // Exact in single precision, the quotient never lands close enough to an integer to round across it
+        const __m128i Numerator = _mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(Values, 8), Values), _mm_srli_epi32(Alpha, 1));
+        __m128 Quotient = _mm_div_ps(_mm_cvtepi32_ps(Numerator), _mm_cvtepi32_ps(Alpha));
+        Quotient = _mm_min_ps(Quotient, _mm_set1_ps(255.0f));
+
+        const __m128i ZeroAlpha = _mm_cmpeq_epi32(Alpha, _mm_setzero_si128());
+        const __m128i Result = _mm_andnot_si128(ZeroAlpha, _mm_cvttps_epi32(Quotient));
+        return _mm_or_si128(_mm_andnot_si128(AlphaMask, Result), _mm_and_si128(AlphaMask, Values));
+    }
+}
+#endif
+
+void FPixelKernels::PremultiplyAlpha(uint8* Pixels, int64 NumPixels)
+{
+    int64 Index = 0;
+
+#if TEXTUREGENERATOR_PIXEL_KERNELS_AVX2
+    const __m256i AlphaMask = _mm256_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1);
+    const __m256i Rounding = _mm256_set1_epi16(128);
+    const __m256i Zero = _mm256_setzero_si256();
+    for (; Index + 8 <= NumPixels; Index += 8)
+    {
+        // Unpacking and packing both work within 128 bit lanes, so the pixel order is preserved
+        const __m256i Values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Pixels + Index * 4));
+        __m256i Wide[2] = { _mm256_unpacklo_epi8(Values, Zero), _mm256_unpackhi_epi8(Values, Zero) };
+        for (__m256i& Half : Wide)
+        {
+            const __m256i Alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(Half, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            const __m256i Product = _mm256_add_epi16(_mm256_mullo_epi16(Half, Alpha), Rounding);
+            const __m256i Result = _mm256_srli_epi16(_mm256_add_epi16(Product, _mm256_srli_epi16(Product, 8)), 8);
+            Half = _mm256_or_si256(_mm256_andnot_si256(AlphaMask, Result), _mm256_and_si256(AlphaMask, Half));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(Pixels + Index * 4), _mm256_packus_epi16(Wide[0], Wide[1]));
+    }
+#elif TEXTUREGENERATOR_PIXEL_KERNELS_SSE2
+    const __m128i Zero = _mm_setzero_si128();
+    for (; Index + 4 <= NumPixels; Index += 4)
+    {
+        const __m128i Values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Pixels + Index * 4));
+        const __m128i Low = PixelKernels::PremultiplyWide(_mm_unpacklo_epi8(Values, Zero));
+        const __m128i High = PixelKernels::PremultiplyWide(_mm_unpackhi_epi8(Values, Zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Pixels + Index * 4), _mm_packus_epi16(Low, High));
+    }
+#elif TEXTUREGENERATOR_PIXEL_KERNELS_NEON
+    const uint16x8_t Rounding = vdupq_n_u16(128);
+    for (; Index + 16 <= NumPixels; Index += 16)
+    {
+        uint8x16x4_t Values = vld4q_u8(Pixels + Index * 4);
+        const uint8x16_t Alpha = Values.val[3];
+        for (int32 Channel = 0; Channel < 3; ++Channel)
+        {
+            const uint16x8_t Low = vaddq_u16(vmull_u8(vget_low_u8(Values.val[Channel]), vget_low_u8(Alpha)), Rounding);
+            const uint16x8_t High = vaddq_u16(vmull_u8(vget_high_u8(Values.val[Channel]), vget_high_u8(Alpha)), Rounding);
+            Values.val[Channel] = vcombine_u8(
+                vshrn_n_u16(vaddq_u16(Low, vshrq_n_u16(Low, 8)), 8),
+                vshrn_n_u16(vaddq_u16(High, vshrq_n_u16(High, 8)), 8));
+        }
+        vst4q_u8(Pixels + Index * 4, Values);
+    }
+#endif
+
+    FScalar::PremultiplyAlpha(Pixels + Index * 4, NumPixels - Index);
+}
+
+void FPixelKernels::UnpremultiplyAlpha(uint8* Pixels, int64 NumPixels)
+{
+    int64 Index = 0;
+
+#if TEXTUREGENERATOR_PIXEL_KERNELS_SSE2
+    const __m128i Zero = _mm_setzero_si128();
+    for (; Index + 4 <= NumPixels; Index += 4)
+    {
+        const __m128i Values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Pixels + Index * 4));
+        const __m128i Low = _mm_unpacklo_epi8(Values, Zero);
+        const __m128i High = _mm_unpackhi_epi8(Values, Zero);
+
+        const __m128i Pixel0 = PixelKernels::UnpremultiplyWide(_mm_unpacklo_epi16(Low, Zero));
+        const __m128i Pixel1 = PixelKernels::UnpremultiplyWide(_mm_unpackhi_epi16(Low, Zero));
+        const __m128i Pixel2 = PixelKernels::UnpremultiplyWide(_mm_unpacklo_epi16(High, Zero));
+        const __m128i Pixel3 = PixelKernels::UnpremultiplyWide(_mm_unpackhi_epi16(High, Zero));
+
+        const __m128i Result = _mm_packus_epi16(_mm_packs_epi32(Pixel0, Pixel1), _mm_packs_epi32(Pixel2, Pixel3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Pixels + Index * 4), Result);
+    }
+#elif TEXTUREGENERATOR_PIXEL_KERNELS_NEON
+    const float32x4_t MaxValue = vdupq_n_f32(255.0f);
+    for (; Index + 16 <= NumPixels; Index += 16)
+    {
+        uint8x16x4_t Values = vld4q_u8(Pixels + Index * 4);
+        const uint16x8_t AlphaWide[2] = { vmovl_u8(vget_low_u8(Values.val[3])), vmovl_u8(vget_high_u8(Values.val[3])) };
+
+        for (int32 Channel = 0; Channel < 3; ++Channel)
+        {
+            const uint16x8_t ValueWide[2] = { vmovl_u8(vget_low_u8(Values.val[Channel])), vmovl_u8(vget_high_u8(Values.val[Channel])) };
+            uint16x4_t Results[4];
+            for (int32 Quarter = 0; Quarter < 4; ++Quarter)
+            {
+                const uint32x4_t Value = vmovl_u16(Quarter % 2 == 0 ? vget_low_u16(ValueWide[Quarter / 2]) : vget_high_u16(ValueWide[Quarter / 2]));
+                const uint32x4_t Alpha = vmovl_u16(Quarter % 2 == 0 ? vget_low_u16(AlphaWide[Quarter / 2]) : vget_high_u16(AlphaWide[Quarter / 2]));
+
+                // Exact in single precision, see the SSE path
+                const uint32x4_t Numerator = vaddq_u32(vmulq_n_u32(Value, 255), vshrq_n_u32(Alpha, 1));
+                const float32x4_t Quotient = vminq_f32(vdivq_f32(vcvtq_f32_u32(Numerator), vcvtq_f32_u32(Alpha)), MaxValue);
+
+                // Zero alpha divides by zero, mask those lanes out
+                const uint32x4_t NonZeroAlpha = vtstq_u32(Alpha, Alpha);
+                Results[Quarter] = vmovn_u32(vandq_u32(vcvtq_u32_f32(Quotient), NonZeroAlpha));
+            }
+
+            Values.val[Channel] = vcombine_u8(
+                vmovn_u16(vcombine_u16(Results[0], Results[1])),
+                vmovn_u16(vcombine_u16(Results[2], Results[3])));
+        }
+        vst4q_u8(Pixels + Index * 4, Values);
+    }
+#endif
+
+    FScalar::UnpremultiplyAlpha(Pixels + Index * 4, NumPixels - Index);
+}
+
+#if TEXTUREGENERATOR_PIXEL_KERNELS_SSE2
+namespace PixelKernels
+{
+    // Low 32 bits of the lane products, SSE2 only multiplies the even lanes to 64 bit
+    FORCEINLINE __m128i MultiplyLow(__m128i A, __m128i B)
+    {
+#if TEXTUREGENERATOR_PIXEL_KERNELS_AVX2
+        return _mm_mullo_epi32(A, B);
+#else
+        const __m128i Even = _mm_mul_epu32(A, B);
+        const __m128i Odd = _mm_mul_epu32(_mm_srli_epi64(A, 32), _mm_srli_epi64(B, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(Even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(Odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+    }
+
+    FORCEINLINE __m128i HashLatticeWide(__m128i X, __m128i Y, __m128i SeedTerm)
+    {
+        __m128i Value = _mm_xor_si128(MultiplyLow(X, _mm_set1_epi32(static_cast<int32>(0x8da6b343u))), MultiplyLow(Y, _mm_set1_epi32(static_cast<int32>(0xd8163841u))));
+        Value = _mm_xor_si128(Value, SeedTerm);
+        Value = _mm_xor_si128(Value, _mm_srli_epi32(Value, 16));
+        Value = MultiplyLow(Value, _mm_set1_epi32(static_cast<int32>(0x7feb352du)));
+        Value = _mm_xor_si128(Value, _mm_srli_epi32(Value, 15));
+        Value = MultiplyLow(Value, _mm_set1_epi32(static_cast<int32>(0x846ca68bu)));
+        return _mm_xor_si128(Value, _mm_srli_epi32(Value, 16));
+    }
+
+    FORCEINLINE __m128i FloorWide(__m128 Value)
+    {
+        // Truncation rounds negative fractions up, step those down by one
+        const __m128i Truncated = _mm_cvttps_epi32(Value);
+        return _mm_add_epi32(Truncated, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(Truncated), Value)));
+    }
+
+    // Lattice coordinates of the row are in [0, 2 * Period), a single subtraction wraps them
+    FORCEINLINE __m128i WrapLatticeWide(__m128i Value, __m128i Period)
+    {
+        return _mm_sub_epi32(Value, _mm_andnot_si128(_mm_cmpgt_epi32(Period, Value), Period));
+    }
+
+    // Selects the gradient of NoiseGradients from the bits of the hash instead of a table lookup
+    FORCEINLINE __m128 GradientDotWide(__m128i Hash, __m128 DX, __m128 DY)
+    {
+        const __m128 Bit0 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(Hash, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+        const __m128 Bit1 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(Hash, _mm_set1_epi32(2)), _mm_set1_epi32(2)));
+        const __m128 Diagonals = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(Hash, _mm_set1_epi32(4)), _mm_set1_epi32(4)));
+        const __m128 SignBit = _mm_set1_ps(-0.0f);
+        const __m128 One = _mm_set1_ps(1.0f);
+        const __m128 Diagonal = _mm_set1_ps(GradientDiagonal);
+
+        const __m128 MagnitudeX = _mm_or_ps(_mm_and_ps(Diagonals, Diagonal), _mm_andnot_ps(Diagonals, One));
+        const __m128 UsesX = _mm_or_ps(Diagonals, _mm_andnot_ps(Bit1, _mm_castsi128_ps(_mm_set1_epi32(-1))));
+        const __m128 GradientX = _mm_and_ps(UsesX, _mm_xor_ps(MagnitudeX, _mm_and_ps(Bit0, SignBit)));
+
+        const __m128 AxisY = _mm_and_ps(Bit1, _mm_xor_ps(One, _mm_and_ps(Bit0, SignBit)));
+        const __m128 DiagonalY = _mm_xor_ps(Diagonal, _mm_and_ps(Bit1, SignBit));
+        const __m128 GradientY = _mm_or_ps(_mm_and_ps(Diagonals, DiagonalY), _mm_andnot_ps(Diagonals, AxisY));
+
+        return _mm_add_ps(_mm_mul_ps(GradientX, DX), _mm_mul_ps(GradientY, DY));
+    }
+
+    FORCEINLINE __m128 FadeWide(__m128 T)
+    {
+        __m128 Polynomial = _mm_sub_ps(_mm_mul_ps(T, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f));
+        Polynomial = _mm_add_ps(_mm_mul_ps(Polynomial, T), _mm_set1_ps(10.0f));
+        return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(T, T), T), Polynomial);
+    }
+
+    FORCEINLINE __m128 LerpNoiseWide(__m128 A, __m128 B, __m128 Alpha)
+    {
+        return _mm_add_ps(A, _mm_mul_ps(_mm_sub_ps(B, A), Alpha));
+    }
+
+    FORCEINLINE __m128 PeriodicNoiseWide(__m128 X, __m128 Y, int32 Period, uint32 Seed)
+    {
+        const __m128i PeriodWide = _mm_set1_epi32(Period);
+        const __m128i OneWide = _mm_set1_epi32(1);
+        const __m128 One = _mm_set1_ps(1.0f);
+        const __m128i SeedTerm = _mm_set1_epi32(static_cast<int32>(Seed * 0xcb1ab31fu));
+
+        const __m128i X0 = FloorWide(X);
+        const __m128i Y0 = FloorWide(Y);
+        const __m128 FX = _mm_sub_ps(X, _mm_cvtepi32_ps(X0));
+        const __m128 FY = _mm_sub_ps(Y, _mm_cvtepi32_ps(Y0));
+        const __m128 FX1 = _mm_sub_ps(FX, One);
+        const __m128 FY1 = _mm_sub_ps(FY, One);
+
+        const __m128i CellX0 = WrapLatticeWide(X0, PeriodWide);
+        const __m128i CellX1 = WrapLatticeWide(_mm_add_epi32(X0, OneWide), PeriodWide);
+        const __m128i CellY0 = WrapLatticeWide(Y0, PeriodWide);
+        const __m128i CellY1 = WrapLatticeWide(_mm_add_epi32(Y0, OneWide), PeriodWide);
+
+        const __m128 U = FadeWide(FX);
+        const __m128 V = FadeWide(FY);
+        const __m128 Bottom = LerpNoiseWide(
+            GradientDotWide(HashLatticeWide(CellX0, CellY0, SeedTerm), FX, FY),
+            GradientDotWide(HashLatticeWide(CellX1, CellY0, SeedTerm), FX1, FY), U);
+        const __m128 Top = LerpNoiseWide(
+            GradientDotWide(HashLatticeWide(CellX0, CellY1, SeedTerm), FX, FY1),
+            GradientDotWide(HashLatticeWide(CellX1, CellY1, SeedTerm), FX1, FY1), U);
+        return _mm_mul_ps(LerpNoiseWide(Bottom, Top, V), _mm_set1_ps(NoiseScale));
+    }
+}
+#elif TEXTUREGENERATOR_PIXEL_KERNELS_NEON
+namespace PixelKernels
+{
+    FORCEINLINE uint32x4_t HashLatticeWide(uint32x4_t X, uint32x4_t Y, uint32x4_t SeedTerm)
+    {
+        uint32x4_t Value = veorq_u32(vmulq_n_u32(X, 0x8da6b343u), vmulq_n_u32(Y, 0xd8163841u));
+        Value = veorq_u32(Value, SeedTerm);
+        Value = veorq_u32(Value, vshrq_n_u32(Value, 16));
+        Value = vmulq_n_u32(Value, 0x7feb352du);
+        Value = veorq_u32(Value, vshrq_n_u32(Value, 15));
+        Value = vmulq_n_u32(Value, 0x846ca68bu);
+        return veorq_u32(Value, vshrq_n_u32(Value, 16));
+    }
+
+    FORCEINLINE int32x4_t FloorWide(float32x4_t Value)
+    {
+        // Truncation rounds negative fractions up, step those down by one
+        const int32x4_t Truncated = vcvtq_s32_f32(Value);
+        return vaddq_s32(Truncated, vreinterpretq_s32_u32(vcgtq_f32(vcvtq_f32_s32(Truncated), Value)));
+    }
+
+    // Lattice coordinates of the row are in [0, 2 * Period), a single subtraction wraps them
+    FORCEINLINE uint32x4_t WrapLatticeWide(int32x4_t Value, int32x4_t Period)
+    {
+        return vreinterpretq_u32_s32(vsubq_s32(Value, vandq_s32(vreinterpretq_s32_u32(vcgeq_s32(Value, Period)), Period)));
+    }
+
+    // Selects the gradient of NoiseGradients from the bits of the hash instead of a table lookup
+    FORCEINLINE float32x4_t GradientDotWide(uint32x4_t Hash, float32x4_t DX, float32x4_t DY)
+    {
+        const uint32x4_t Bit0 = vtstq_u32(Hash, vdupq_n_u32(1));
+        const uint32x4_t Bit1 = vtstq_u32(Hash, vdupq_n_u32(2));
+        const uint32x4_t Diagonals = vtstq_u32(Hash, vdupq_n_u32(4));
+        const uint32x4_t SignBit = vdupq_n_u32(0x80000000u);
+        const uint32x4_t One = vreinterpretq_u32_f32(vdupq_n_f32(1.0f));
+        const uint32x4_t Diagonal = vreinterpretq_u32_f32(vdupq_n_f32(GradientDiagonal));
+
+        const uint32x4_t MagnitudeX = vbslq_u32(Diagonals, Diagonal, One);
+        const uint32x4_t UsesX = vorrq_u32(Diagonals, vmvnq_u32(Bit1));
+        const uint32x4_t GradientX = vandq_u32(UsesX, veorq_u32(MagnitudeX, vandq_u32(Bit0, SignBit)));
+
+        const uint32x4_t AxisY = vandq_u32(Bit1, veorq_u32(One, vandq_u32(Bit0, SignBit)));
+        const uint32x4_t DiagonalY = veorq_u32(Diagonal, vandq_u32(Bit1, SignBit));
+        const uint32x4_t GradientY = vbslq_u32(Diagonals, DiagonalY, AxisY);
+
+        return vaddq_f32(vmulq_f32(vreinterpretq_f32_u32(GradientX), DX), vmulq_f32(vreinterpretq_f32_u32(GradientY), DY));
+    }
+
+    FORCEINLINE float32x4_t FadeWide(float32x4_t T)
+    {
+        float32x4_t Polynomial = vsubq_f32(vmulq_n_f32(T, 6.0f), vdupq_n_f32(15.0f));
+        Polynomial = vaddq_f32(vmulq_f32(Polynomial, T), vdupq_n_f32(10.0f));
+        return vmulq_f32(vmulq_f32(vmulq_f32(T, T), T), Polynomial);
+    }
+
+    FORCEINLINE float32x4_t LerpNoiseWide(float32x4_t A, float32x4_t B, float32x4_t Alpha)
+    {
+        return vaddq_f32(A, vmulq_f32(vsubq_f32(B, A), Alpha));
+    }
+
+    FORCEINLINE float32x4_t PeriodicNoiseWide(float32x4_t X, float32x4_t Y, int32 Period, uint32 Seed)
+    {
+        const int32x4_t PeriodWide = vdupq_n_s32(Period);
+        const int32x4_t OneWide = vdupq_n_s32(1);
+        const float32x4_t One = vdupq_n_f32(1.0f);
+        const uint32x4_t SeedTerm = vdupq_n_u32(Seed * 0xcb1ab31fu);
+
+        const int32x4_t X0 = FloorWide(X);
+        const int32x4_t Y0 = FloorWide(Y);
+        const float32x4_t FX = vsubq_f32(X, vcvtq_f32_s32(X0));
+        const float32x4_t FY = vsubq_f32(Y, vcvtq_f32_s32(Y0));
+        const float32x4_t FX1 = vsubq_f32(FX, One);
+        const float32x4_t FY1 = vsubq_f32(FY, One);
+
+        const uint32x4_t CellX0 = WrapLatticeWide(X0, PeriodWide);
+        const uint32x4_t CellX1 = WrapLatticeWide(vaddq_s32(X0, OneWide), PeriodWide);
+        const uint32x4_t CellY0 = WrapLatticeWide(Y0, PeriodWide);
+        const uint32x4_t CellY1 = WrapLatticeWide(vaddq_s32(Y0, OneWide), PeriodWide);
+
+        const float32x4_t U = FadeWide(FX);
+        const float32x4_t V = FadeWide(FY);
+        const float32x4_t Bottom = LerpNoiseWide(
+            GradientDotWide(HashLatticeWide(CellX0, CellY0, SeedTerm), FX, FY),
+            GradientDotWide(HashLatticeWide(CellX1, CellY0, SeedTerm), FX1, FY), U);
+        const float32x4_t Top = LerpNoiseWide(
+            GradientDotWide(HashLatticeWide(CellX0, CellY1, SeedTerm), FX, FY1),
+            GradientDotWide(HashLatticeWide(CellX1, CellY1, SeedTerm), FX1, FY1), U);
+        return vmulq_n_f32(LerpNoiseWide(Bottom, Top, V), NoiseScale);
+    }
+}
+#endif
+
+void FPixelKernels::FractalNoiseRow(int32 Row, int32 Size, int32 BasePeriod, int32 NumOctaves, uint32 Seed, float* Dst)
+{
+    int32 Index = 0;
+
+#if TEXTUREGENERATOR_PIXEL_KERNELS_SSE2 || TEXTUREGENERATOR_PIXEL_KERNELS_NEON
+    const float InvSize = 1.0f / static_cast<float>(Size);
+    const float V = (static_cast<float>(Row) + 0.5f) * InvSize;
+    const float Norm = PixelKernels::FractalNoiseNorm(NumOctaves);
+#endif
+
+#if TEXTUREGENERATOR_PIXEL_KERNELS_SSE2
+    const __m128 Half = _mm_set1_ps(0.5f);
+    for (; Index + 4 <= Size; Index += 4)
+    {
+        const __m128i Columns = _mm_add_epi32(_mm_set1_epi32(Index), _mm_setr_epi32(0, 1, 2, 3));
+        const __m128 U = _mm_mul_ps(_mm_add_ps(_mm_cvtepi32_ps(Columns), Half), _mm_set1_ps(InvSize));
+
+        __m128 Sum = _mm_setzero_ps();
+        float Amplitude = 1.0f;
+        int32 Period = BasePeriod;
+        for (int32 Octave = 0; Octave < NumOctaves; ++Octave)
+        {
+            const float Scale = static_cast<float>(Period);
+            const __m128 Noise = PixelKernels::PeriodicNoiseWide(_mm_mul_ps(U, _mm_set1_ps(Scale)), _mm_set1_ps(V * Scale), Period, Seed + Octave);
+            Sum = _mm_add_ps(Sum, _mm_mul_ps(_mm_set1_ps(Amplitude), Noise));
+            Amplitude = Amplitude * 0.5f;
+            Period *= 2;
+        }
+
+        // Max returns its second operand for NaN, which maps NaN to 0 like the scalar path
+        __m128 Value = _mm_add_ps(Half, _mm_mul_ps(Half, _mm_div_ps(Sum, _mm_set1_ps(Norm))));
+        Value = _mm_min_ps(_mm_max_ps(Value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        _mm_storeu_ps(Dst + Index, Value);
+    }
+#elif TEXTUREGENERATOR_PIXEL_KERNELS_NEON
+    const float32x4_t Half = vdupq_n_f32(0.5f);
+    const int32 ColumnOffsets[4] = { 0, 1, 2, 3 };
+    const int32x4_t Offsets = vld1q_s32(ColumnOffsets);
+    for (; Index + 4 <= Size; Index += 4)
+    {
+        const int32x4_t Columns = vaddq_s32(vdupq_n_s32(Index), Offsets);
+        const float32x4_t U = vmulq_n_f32(vaddq_f32(vcvtq_f32_s32(Columns), Half), InvSize);
+
+        float32x4_t Sum = vdupq_n_f32(0.0f);
+        float Amplitude = 1.0f;
+        int32 Period = BasePeriod;
+        for (int32 Octave = 0; Octave < NumOctaves; ++Octave)
+        {
+            const float Scale = static_cast<float>(Period);
+            const float32x4_t Noise = PixelKernels::PeriodicNoiseWide(vmulq_n_f32(U, Scale), vdupq_n_f32(V * Scale), Period, Seed + Octave);
+            Sum = vaddq_f32(Sum, vmulq_n_f32(Noise, Amplitude));
+            Amplitude = Amplitude * 0.5f;
+            Period *= 2;
+        }
+
+        // The "number" variant of max ignores NaN, mapping it to 0 like the scalar path
+        float32x4_t Value = vaddq_f32(Half, vmulq_f32(Half, vdivq_f32(Sum, vdupq_n_f32(Norm))));
+        Value = vminq_f32(vmaxnmq_f32(Value, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f));
+        vst1q_f32(Dst + Index, Value);
+    }
+#endif
+
+    PixelKernels::FractalNoiseColumns(Row, Size, Index, BasePeriod, NumOctaves, Seed, Dst);
+}
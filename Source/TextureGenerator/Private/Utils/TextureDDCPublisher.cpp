@@ -0,0 +1,83 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Utils/TextureDDCPublisher.h"
+#include "TextureGeneratorModule.h"
+#include "TextureGeneratorSettings.h"
+
+#include "Engine/Texture.h"
+#include "Interfaces/ITargetPlatform.h"
+#include "Interfaces/ITargetPlatformManagerModule.h"
+
+FTextureDDCPublisher::~FTextureDDCPublisher()
+{
+    for (const FPendingTexture& Entry : Pending)
+    {
+        if (UTexture* Texture = Entry.Texture.Get())
+        {
+            Texture->ClearCachedCookedPlatformData(Entry.Platform);
+        }
+    }
+}
+
+void FTextureDDCPublisher::Publish(UTexture* Texture)
+{
+    if (!IsValid(Texture) || !GetDefault<UTextureGeneratorSettings>()->bPublishToSharedDDC)
+    {
+        return;
+    }
+
+    for (const ITargetPlatform* Platform : GetTargetPlatforms())
+    {
+        // Kicks off an asynchronous build, the derived data cache stores the result in all of its writable layers
+        Texture->BeginCacheForCookedPlatformData(Platform);
+        Pending.Add({ Texture, Platform });
+    }
+}
+
+void FTextureDDCPublisher::Tick()
+{
+    for (int32 Index = Pending.Num() - 1; Index >= 0; --Index)
+    {
+        UTexture* Texture = Pending[Index].Texture.Get();
+        if (!Texture)
+        {
+            Pending.RemoveAtSwap(Index);
+            continue;
+        }
+
+        if (Texture->IsCachedCookedPlatformDataLoaded(Pending[Index].Platform))
+        {
+            // The data is in the cache now, there is no need to keep it in memory until a cook
+            Texture->ClearCachedCookedPlatformData(Pending[Index].Platform);
+            Pending.RemoveAtSwap(Index);
+        }
+    }
+}
+
+TArray<const ITargetPlatform*> FTextureDDCPublisher::GetTargetPlatforms()
+{
+    TArray<const ITargetPlatform*> Platforms;
+
+    ITargetPlatformManagerModule& TargetPlatformManager = GetTargetPlatformManagerRef();
+    const TArray<FString>& PlatformNames = GetDefault<UTextureGeneratorSettings>()->DDCTargetPlatforms;
+
+    if (PlatformNames.IsEmpty())
+    {
+        Platforms.Append(TargetPlatformManager.GetActiveTargetPlatforms());
+        return Platforms;
+    }
+
+    for (const FString& PlatformName : PlatformNames)
+    {
+        if (const ITargetPlatform* Platform = TargetPlatformManager.FindTargetPlatform(PlatformName))
+        {
+            Platforms.AddUnique(Platform);
+        }
+        else
+        {
+            UE_LOG(LogTextureGenerator, Warning, TEXT("Unknown target platform '%s' in DDC Target Platforms."), *PlatformName);
+        }
+    }
+
+    return Platforms;
+}
@@ -0,0 +1,40 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+class ITargetPlatform;
+class UTexture;
+
+/**
+ * Builds the cooked platform data of generated textures right after import, so the compressed results
+ * land in every writable derived data cache layer, including the shared one, and teammates syncing
+ * the assets fetch them instead of compressing again.
+ */
+class FTextureDDCPublisher
+{
+public:
+    ~FTextureDDCPublisher();
+
+    /** Starts caching the texture for the configured target platforms. */
+    void Publish(UTexture* Texture);
+
+    /** Releases the platform data of textures which finished caching. */
+    void Tick();
+
+    int32 GetNumPending() const { return Pending.Num(); }
+
+    /** Target platforms generated textures are cached for. */
+    static TArray<const ITargetPlatform*> GetTargetPlatforms();
+
+private:
+    struct FPendingTexture
+    {
+        TWeakObjectPtr<UTexture> Texture;
+        const ITargetPlatform* Platform = nullptr;
+    };
+
+    TArray<FPendingTexture> Pending;
+};
@@ -0,0 +1,252 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Utils/TextureMemoryReport.h"
+#include "TextureGeneratorModule.h"
+#include "TextureGeneratorSettings.h"
+
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Texture.h"
+#include "Engine/TextureDefines.h"
+#include "HAL/FileManager.h"
+#include "Misc/PackageName.h"
+#include "PixelFormat.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "TextureCompiler.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace TextureMemoryReport
+{
+    // Textures loaded and measured at once, a whole library of 4K textures would not fit in memory together
+    static constexpr int32 BatchSize = 64;
+
+    static const TCHAR* FlagNames[] = { TEXT("NeverStream"), TEXT("NoMips"), TEXT("Oversized"), TEXT("Uncompressed"), TEXT("Unreferenced") };
+
+    // Bytes of one mip in the given format, computed from the block layout so it works for regular and virtual textures alike
+    static int64 GetMipBytes(EPixelFormat Format, int32 Width, int32 Height, int32 NumSlices, int32 MipIndex)
+    {
+        const FPixelFormatInfo& Info = GPixelFormats[Format];
+        const int64 MipWidth = FMath::Max(Width >> MipIndex, 1);
+        const int64 MipHeight = FMath::Max(Height >> MipIndex, 1);
+        const int64 NumBlocks = FMath::DivideAndRoundUp<int64>(MipWidth, Info.BlockSizeX) * FMath::DivideAndRoundUp<int64>(MipHeight, Info.BlockSizeY);
+        return NumBlocks * Info.BlockBytes * NumSlices;
+    }
+
+    static bool MakeEntry(UTexture* Texture, int32 OversizeThreshold, FTextureMemoryReportEntry& OutEntry)
+    {
+        FTexturePlatformData** RunningPlatformData = Texture->GetRunningPlatformData();
+        const FTexturePlatformData* PlatformData = RunningPlatformData ? *RunningPlatformData : nullptr;
+        if (!PlatformData || PlatformData->PixelFormat == PF_Unknown)
+        {
+            UE_LOG(LogTextureGenerator, Warning, TEXT("%s has no platform data, skipping it in the memory report."), *Texture->GetPathName());
+            return false;
+        }
+
+        FTextureMemoryReportEntry& Entry = OutEntry;
+        Entry.PackageName = Texture->GetPackage()->GetName();
+        Entry.AssetClass = Texture->GetClass()->GetName();
+        Entry.Width = PlatformData->SizeX;
+        Entry.Height = PlatformData->SizeY;
+        Entry.NumSlices = FMath::Max(1, PlatformData->GetNumSlices());
+        Entry.Format = GetPixelFormatString(PlatformData->PixelFormat);
+        Entry.NumMips = PlatformData->GetNumMips();
+        Entry.bVirtual = Texture->VirtualTextureStreaming;
+        Entry.bStreaming = !Entry.bVirtual && !Texture->NeverStream && Entry.NumMips > 1;
+
+        int64 UncompressedBytes = 0;
+        for (int32 MipIndex = 0; MipIndex < Entry.NumMips; ++MipIndex)
+        {
+            Entry.FullBytes += GetMipBytes(PlatformData->PixelFormat, Entry.Width, Entry.Height, Entry.NumSlices, MipIndex);
+            UncompressedBytes += GetMipBytes(PF_B8G8R8A8, Entry.Width, Entry.Height, Entry.NumSlices, MipIndex);
+        }
+        Entry.CompressionRatio = Entry.FullBytes > 0 ? static_cast<float>(static_cast<double>(UncompressedBytes) / Entry.FullBytes) : 1.0f;
+
+        // Virtual textures only keep the pages on screen, streamed ones at least their mip tail
+        if (Entry.bStreaming)
+        {
+            const int32 NumResidentMips = FMath::Clamp(PlatformData->GetNumNonStreamingMips(true), 1, Entry.NumMips);
+            for (int32 MipIndex = Entry.NumMips - NumResidentMips; MipIndex < Entry.NumMips; ++MipIndex)
+            {
+                Entry.ResidentBytes += GetMipBytes(PlatformData->PixelFormat, Entry.Width, Entry.Height, Entry.NumSlices, MipIndex);
+            }
+        }
+        else if (!Entry.bVirtual)
+        {
+            Entry.ResidentBytes = Entry.FullBytes;
+        }
+
+        const FString Filename = FPackageName::LongPackageNameToFilename(Entry.PackageName, FPackageName::GetAssetPackageExtension());
+        Entry.DiskBytes = FMath::Max<int64>(0, IFileManager::Get().FileSize(*Filename));
+
+        const int32 MaxSize = FMath::Max(Entry.Width, Entry.Height);
+        if (Texture->NeverStream && !Entry.bVirtual)
+        {
+            Entry.Flags |= ETextureMemoryFlags::NeverStream;
+        }
+        if (Entry.NumMips <= 1 && MaxSize > 1)
+        {
+            Entry.Flags |= ETextureMemoryFlags::NoMips;
+        }
+        if (MaxSize > OversizeThreshold && !Entry.bVirtual)
+        {
+            Entry.Flags |= ETextureMemoryFlags::Oversized;
+        }
+        if (GPixelFormats[PlatformData->PixelFormat].BlockSizeX == 1 && Entry.CompressionRatio <= 1.0f)
+        {
+            Entry.Flags |= ETextureMemoryFlags::Uncompressed;
+        }
+
+        TArray<FName> Referencers;
+        IAssetRegistry::GetChecked().GetReferencers(Texture->GetPackage()->GetFName(), Referencers);
+        if (Referencers.Num() == 0)
+        {
+            Entry.Flags |= ETextureMemoryFlags::Unreferenced;
+        }
+
+        return true;
+    }
+}
+
+TArray<FTextureMemoryReportEntry> FTextureMemoryReport::Collect(int32 OversizeThreshold)
+{
+    FString PackagePath = GetDefault<UTextureGeneratorSettings>()->DefaultAssetPath;
+    PackagePath.RemoveFromEnd(TEXT("/"));
+
+    FARFilter Filter;
+    Filter.PackagePaths.Add(FName(*PackagePath));
+    Filter.ClassPaths.Add(UTexture::StaticClass()->GetClassPathName());
+    Filter.bRecursivePaths = true;
+    Filter.bRecursiveClasses = true;
+
+    TArray<FAssetData> Assets;
+    IAssetRegistry::GetChecked().GetAssets(Filter, Assets);
+
+    TArray<FTextureMemoryReportEntry> Entries;
+    Entries.Reserve(Assets.Num());
+
+    TArray<UTexture*> Textures;
+    for (int32 BatchStart = 0; BatchStart < Assets.Num(); BatchStart += TextureMemoryReport::BatchSize)
+    {
+        const int32 BatchEnd = FMath::Min(BatchStart + TextureMemoryReport::BatchSize, Assets.Num());
+
+        bool bLoadedAny = false;
+        for (int32 Index = BatchStart; Index < BatchEnd; ++Index)
+        {
+            bLoadedAny |= !Assets[Index].IsAssetLoaded();
+            if (UTexture* Texture = Cast<UTexture>(Assets[Index].GetAsset()))
+            {
+                Textures.Add(Texture);
+            }
+        }
+
+        // Platform data of textures which were just loaded or imported may still be compiling
+        FTextureCompilingManager::Get().FinishCompilation(Textures);
+
+        for (UTexture* Texture : Textures)
+        {
+            FTextureMemoryReportEntry Entry;
+            if (TextureMemoryReport::MakeEntry(Texture, OversizeThreshold, Entry))
+            {
+                Entries.Add(MoveTemp(Entry));
+            }
+        }
+
+        // Only the numbers are kept, textures loaded for the report are released before the next batch
+        Textures.Reset();
+        if (bLoadedAny)
+        {
+            CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+        }
+    }
+
+    Entries.Sort([](const FTextureMemoryReportEntry& A, const FTextureMemoryReportEntry& B)
+    {
+        return A.FullBytes > B.FullBytes;
+    });
+    return Entries;
+}
+
+FString FTextureMemoryReport::GetFlagNames(ETextureMemoryFlags Flags)
+{
+    FString Names;
+    for (int32 Bit = 0; Bit < UE_ARRAY_COUNT(TextureMemoryReport::FlagNames); ++Bit)
+    {
+        if (EnumHasAnyFlags(Flags, static_cast<ETextureMemoryFlags>(1 << Bit)))
+        {
+            Names += Names.IsEmpty() ? TEXT("") : TEXT("|");
+            Names += TextureMemoryReport::FlagNames[Bit];
+        }
+    }
+    return Names;
+}
+
+FString FTextureMemoryReport::ToCsv(const TArray<FTextureMemoryReportEntry>& Entries)
+{
+    FString Csv = TEXT("Package,Class,Width,Height,Slices,Format,Mips,Streaming,Virtual,FullBytes,ResidentBytes,DiskBytes,CompressionRatio,Flags\n");
+    for (const FTextureMemoryReportEntry& Entry : Entries)
+    {
+        Csv += FString::Printf(TEXT("%s,%s,%d,%d,%d,%s,%d,%d,%d,%lld,%lld,%lld,%.2f,%s\n"),
+            *Entry.PackageName, *Entry.AssetClass, Entry.Width, Entry.Height, Entry.NumSlices, *Entry.Format, Entry.NumMips,
+            Entry.bStreaming ? 1 : 0, Entry.bVirtual ? 1 : 0, Entry.FullBytes, Entry.ResidentBytes, Entry.DiskBytes,
+            Entry.CompressionRatio, *GetFlagNames(Entry.Flags));
+    }
+    return Csv;
+}
+
+FString FTextureMemoryReport::ToJson(const TArray<FTextureMemoryReportEntry>& Entries)
+{
+    int64 TotalFullBytes = 0;
+    int64 TotalResidentBytes = 0;
+    int64 TotalDiskBytes = 0;
+    int32 NumFlagged = 0;
+
+    TArray<TSharedPtr<FJsonValue>> Textures;
+    for (const FTextureMemoryReportEntry& Entry : Entries)
+    {
+        TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+        Object->SetStringField(TEXT("package"), Entry.PackageName);
+        Object->SetStringField(TEXT("class"), Entry.AssetClass);
+        Object->SetNumberField(TEXT("width"), Entry.Width);
+        Object->SetNumberField(TEXT("height"), Entry.Height);
+        Object->SetNumberField(TEXT("slices"), Entry.NumSlices);
+        Object->SetStringField(TEXT("format"), Entry.Format);
+        Object->SetNumberField(TEXT("mips"), Entry.NumMips);
+        Object->SetBoolField(TEXT("streaming"), Entry.bStreaming);
+        Object->SetBoolField(TEXT("virtual"), Entry.bVirtual);
+        Object->SetNumberField(TEXT("fullBytes"), static_cast<double>(Entry.FullBytes));
+        Object->SetNumberField(TEXT("residentBytes"), static_cast<double>(Entry.ResidentBytes));
+        Object->SetNumberField(TEXT("diskBytes"), static_cast<double>(Entry.DiskBytes));
+        Object->SetNumberField(TEXT("compressionRatio"), Entry.CompressionRatio);
+
+        TArray<FString> FlagNames;
+        GetFlagNames(Entry.Flags).ParseIntoArray(FlagNames, TEXT("|"));
+        TArray<TSharedPtr<FJsonValue>> Flags;
+        for (const FString& FlagName : FlagNames)
+        {
+            Flags.Add(MakeShared<FJsonValueString>(FlagName));
+        }
+        Object->SetArrayField(TEXT("flags"), Flags);
+
+        Textures.Add(MakeShared<FJsonValueObject>(Object));
+
+        TotalFullBytes += Entry.FullBytes;
+        TotalResidentBytes += Entry.ResidentBytes;
+        TotalDiskBytes += Entry.DiskBytes;
+        NumFlagged += Entry.Flags != ETextureMemoryFlags::None ? 1 : 0;
+    }
+
+    TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+    Report->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+    Report->SetStringField(TEXT("path"), GetDefault<UTextureGeneratorSettings>()->DefaultAssetPath);
+    Report->SetNumberField(TEXT("totalFullBytes"), static_cast<double>(TotalFullBytes));
+    Report->SetNumberField(TEXT("totalResidentBytes"), static_cast<double>(TotalResidentBytes));
+    Report->SetNumberField(TEXT("totalDiskBytes"), static_cast<double>(TotalDiskBytes));
+    Report->SetNumberField(TEXT("numFlagged"), NumFlagged);
+    Report->SetArrayField(TEXT("textures"), Textures);
+
+    FString Json;
+    TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+    FJsonSerializer::Serialize(Report, Writer);
+    return Json;
+}
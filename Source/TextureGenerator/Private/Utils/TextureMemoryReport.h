@@ -0,0 +1,81 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Import settings of a texture which are likely to waste memory */
+enum class ETextureMemoryFlags : uint8
+{
+    None = 0,
+    /** Never streamed, every mip stays resident */
+    NeverStream = 1 << 0,
+    /** Imported without mips, it is sampled at full resolution at any distance */
+    NoMips = 1 << 1,
+    /** Larger than the oversize threshold without being a virtual texture */
+    Oversized = 1 << 2,
+    /** Stored uncompressed on the GPU */
+    Uncompressed = 1 << 3,
+    /** No other asset references it */
+    Unreferenced = 1 << 4
+};
+ENUM_CLASS_FLAGS(ETextureMemoryFlags);
+
+/** Runtime cost of one generated texture */
+struct FTextureMemoryReportEntry
+{
+    FString PackageName;
+    FString AssetClass;
+
+    /** Size of the top mip on the running platform, slices are counted separately */
+    int32 Width = 0;
+    int32 Height = 0;
+    int32 NumSlices = 1;
+
+    /** Pixel format on the running platform, e.g. PF_DXT1 */
+    FString Format;
+    int32 NumMips = 0;
+    bool bStreaming = false;
+    bool bVirtual = false;
+
+    /** GPU memory of all mips */
+    int64 FullBytes = 0;
+
+    /** GPU memory resident regardless of the view: everything for unstreamed textures, the mip tail for streamed ones */
+    int64 ResidentBytes = 0;
+
+    /** Size of the package file */
+    int64 DiskBytes = 0;
+
+    /** Size of the same mips as uncompressed 8 bit RGBA, divided by the GPU memory */
+    float CompressionRatio = 1.0f;
+
+    ETextureMemoryFlags Flags = ETextureMemoryFlags::None;
+};
+
+/**
+ * Lists the memory costs of the textures and texture arrays under the default asset path,
+ * flagging the import settings which make them expensive.
+ */
+class FTextureMemoryReport
+{
+public:
+    /** Textures larger than this along either side are flagged as oversized, unless they are virtual */
+    static constexpr int32 DefaultOversizeThreshold = 2048;
+
+    /**
+     * Loads the textures under the default asset path in batches and waits for their compilation.
+     * Textures which were not loaded before are released and garbage collected after each batch.
+     * @return One entry per texture, most expensive first
+     */
+    static TArray<FTextureMemoryReportEntry> Collect(int32 OversizeThreshold = DefaultOversizeThreshold);
+
+    /** Names of the set flags separated by '|', empty without flags. */
+    static FString GetFlagNames(ETextureMemoryFlags Flags);
+
+    /** One row per entry, with a header row. */
+    static FString ToCsv(const TArray<FTextureMemoryReportEntry>& Entries);
+
+    /** An object with the totals and an array of entries. */
+    static FString ToJson(const TArray<FTextureMemoryReportEntry>& Entries);
+};
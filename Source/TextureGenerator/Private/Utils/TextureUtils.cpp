@@ -1,27 +1,197 @@
 // Copyright Mateusz Wojt. All Rights Reserved.
 
 #include "Utils/TextureUtils.h"
+#include "Utils/PixelKernels.h"
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "AssetToolsModule.h"
 #include "TextureGeneratorModule.h"
 #include "TextureGeneratorSettings.h"
 #include "Engine/Texture2D.h"
 #include "Factories/MaterialFactoryNew.h"
+#include "Factories/MaterialInstanceConstantFactoryNew.h"
 #include "ImageCore.h"
+#include "ImageCoreUtils.h"
 #include "ImageUtils.h"
 #include "IImageWrapper.h"
 #include "IImageWrapperModule.h"
+#include "Materials/MaterialExpressionAppendVector.h"
+#include "Materials/MaterialExpressionPerInstanceCustomData.h"
+#include "Materials/MaterialExpressionScalarParameter.h"
+#include "Materials/MaterialExpressionTextureCoordinate.h"
 #include "Materials/MaterialExpressionTextureSampleParameter2D.h"
+#include "Materials/MaterialExpressionTextureSampleParameter2DArray.h"
+#include "Materials/MaterialInstanceConstant.h"
+#include "Materials/MaterialExpressionTextureBase.h"
+#include "HAL/IConsoleManager.h"
 #include "Misc/FileHelper.h"
 #include "Misc/PackageName.h"
+#include "UObject/MetaData.h"
+#include "UObject/UObjectIterator.h"
 
+namespace TextureUtils
+{
+    // Every generator metadata key, all of them are exposed to the asset registry
+    static TArray<FName> GetMetaDataTags()
+    {
+        using namespace TextureGeneratorMetaData;
+        return { Fingerprint, Manifest, Prompt, NegativePrompt, Model, Seed, Style, Strength, Created, Metallic };
+    }
+
+    // Fully resident textures are fine for regular results, upscaled and tiled ones would take hundreds of megabytes.
+    // Applied on every source change, replacing a texture in place may cross the threshold either way
+    static void ApplySizeSettings(UTexture2D* Texture, const FImage& Image)
+    {
+        const UTextureGeneratorSettings* Settings = GetDefault<UTextureGeneratorSettings>();
+        const bool bLarge = FMath::Max(Image.SizeX, Image.SizeY) >= Settings->VirtualTextureSizeThreshold;
+        const bool bVirtual = bLarge && Settings->bImportLargeResultsAsVirtualTextures && FTextureUtils::IsVirtualTexturingEnabled();
+
+        Texture->NeverStream = !bLarge;
+        Texture->MipGenSettings = bLarge ? TMGS_FromTextureGroup : TMGS_NoMipmaps;
+
+        // Only the tiles visible on screen are resident. Virtual textures need power of two dimensions, stretching
+        // keeps the image covering the whole UV range where padding would leave a border the materials sample
+        Texture->VirtualTextureStreaming = bVirtual;
+        Texture->PowerOfTwoMode = bVirtual ? ETexturePowerOfTwoSetting::StretchToPowerOfTwo : ETexturePowerOfTwoSetting::None;
+    }
+
+    // Parameters of the shared packed material
+    static const FName BaseColorParameter(TEXT("BaseColor"));
+    static const FName MaskMapParameter(TEXT("OcclusionRoughnessMetallic"));
+
+    static UTexture2D* CreateTexture(const FImage& Image, const FString& TextureName, bool bMaskMap, FString& OutPackageName)
+    {
+        if (Image.Format != ERawImageFormat::BGRA8 || Image.SizeX <= 0 || Image.SizeY <= 0)
+        {
+            UE_LOG(LogTextureGenerator, Error, TEXT("Expected a non-empty BGRA8 image."));
+            return nullptr;
+        }
+
+        // Create a unique package name
+        FString PackagePath = GetMutableDefault<UTextureGeneratorSettings>()->DefaultAssetPath;
+        OutPackageName = PackagePath + TextureName;
+
+        // Create the package
+        UPackage* Package = CreatePackage(*OutPackageName);
+        if (!Package)
+        {
+            UE_LOG(LogTextureGenerator, Error, TEXT("Failed to create package: %s"), *OutPackageName);
+            return nullptr;
+        }
+
+        // Create a new texture in the package
+        UTexture2D* NewTexture = NewObject<UTexture2D>(
+            Package,
+            FName(*TextureName),
+            RF_Public | RF_Standalone
+        );
+
+        if (!NewTexture)
+        {
+            UE_LOG(LogTextureGenerator, Error, TEXT("Failed to create texture object"));
+            return nullptr;
+        }
+
+        // Set the texture properties, mask maps hold linear data in their channels
+        NewTexture->CompressionSettings = bMaskMap ? TC_Masks : TC_Default;
+        NewTexture->SRGB = !bMaskMap;
+        NewTexture->AddressX = TA_Clamp;
+        NewTexture->AddressY = TA_Clamp;
+
+        // Initialize the texture source with the decoded data, this applies the settings depending on its size
+        FTextureUtils::UpdateTextureFromImage(NewTexture, Image);
+
+        // Notify the asset registry
+        FAssetRegistryModule::AssetCreated(NewTexture);
+
+        return NewTexture;
+    }
+
+    static UMaterialExpressionTextureSampleParameter2D* AddTextureParameter(UMaterial* Material, FName Name, UTexture2D* Texture, bool bMaskMap, int32 EditorY)
+    {
+        UMaterialExpressionTextureSampleParameter2D* TextureSample = NewObject<UMaterialExpressionTextureSampleParameter2D>(Material);
+        TextureSample->ParameterName = Name;
+        TextureSample->Texture = Texture;
+        if (bMaskMap)
+        {
+            TextureSample->SamplerType = Texture->VirtualTextureStreaming ? SAMPLERTYPE_VirtualMasks : SAMPLERTYPE_Masks;
+        }
+        else
+        {
+            TextureSample->SamplerType = Texture->VirtualTextureStreaming ? SAMPLERTYPE_VirtualColor : SAMPLERTYPE_Color;
+        }
+        TextureSample->MaterialExpressionEditorX = -400;
+        TextureSample->MaterialExpressionEditorY = EditorY;
+
+        Material->GetEditorOnlyData()->ExpressionCollection.Expressions.Add(TextureSample);
+        return TextureSample;
+    }
+
+    // The shared parent of packed material instances, the first textures become the parameter defaults
+    static UMaterial* FindOrCreatePackedMaterial(UTexture2D* BaseColor, UTexture2D* MaskMap, bool& bOutCreated)
+    {
+        bOutCreated = false;
+        const FString MaterialName = BaseColor->VirtualTextureStreaming ? TEXT("M_TextureGenerator_ORM_VT") : TEXT("M_TextureGenerator_ORM");
+        if (UMaterial* Existing = Cast<UMaterial>(FTextureUtils::FindGeneratedAsset(MaterialName)))
+        {
+            return Existing;
+        }
+
+        IAssetTools& AssetTools = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools").Get();
+        UMaterial* NewMaterial = Cast<UMaterial>(AssetTools.CreateAsset(
+            MaterialName,
+            GetMutableDefault<UTextureGeneratorSettings>()->DefaultAssetPath,
+            UMaterial::StaticClass(),
+            NewObject<UMaterialFactoryNew>()
+        ));
+
+        if (!NewMaterial)
+        {
+            return nullptr;
+        }
+
+        NewMaterial->Modify();
+
+        UMaterialEditorOnlyData* EditorOnlyData = NewMaterial->GetEditorOnlyData();
+        UMaterialExpressionTextureSampleParameter2D* BaseColorSample = AddTextureParameter(NewMaterial, BaseColorParameter, BaseColor, false, 0);
+        UMaterialExpressionTextureSampleParameter2D* MaskSample = AddTextureParameter(NewMaterial, MaskMapParameter, MaskMap, true, 300);
+
+        // Outputs of a texture sample are RGB, R, G, B, A and RGBA
+        EditorOnlyData->BaseColor.Connect(0, BaseColorSample);
+        EditorOnlyData->AmbientOcclusion.Connect(1, MaskSample);
+        EditorOnlyData->Roughness.Connect(2, MaskSample);
+        EditorOnlyData->Metallic.Connect(3, MaskSample);
+
+        NewMaterial->SetShadingModel(MSM_DefaultLit);
+        NewMaterial->BlendMode = BLEND_Opaque;
+
+        NewMaterial->PreEditChange(nullptr);
+        NewMaterial->ForceRecompileForRendering();
+        NewMaterial->PostEditChange();
+        NewMaterial->MarkPackageDirty();
+
+        // Created by the asset tools, which already notified the asset registry
+        bOutCreated = true;
+        return NewMaterial;
+    }
+}
 
 UTexture2D* FTextureUtils::CreateTextureFromImageData(const TArray<uint8>& ImageData, const FString& BaseName, FString& OutPackageName)
+{
+    FImage Image;
+    if (!DecodeImageData(ImageData, Image))
+    {
+        return nullptr;
+    }
+
+    return CreateTextureFromImage(Image, BaseName, OutPackageName);
+}
+
+bool FTextureUtils::DecodeImageData(const TArray<uint8>& ImageData, FImage& OutImage)
 {
     if (ImageData.Num() == 0)
     {
         UE_LOG(LogTextureGenerator, Error, TEXT("Image data is empty."));
-        return nullptr;
+        return false;
     }
 
     IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
@@ -31,7 +201,7 @@ UTexture2D* FTextureUtils::CreateTextureFromImageData(const TArray<uint8>& Image
     if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(ImageData.GetData(), ImageData.Num()))
     {
         UE_LOG(LogTemp, Error, TEXT("Cannot set the compressed image data."));
-        return nullptr;
+        return false;
     }
 
     int32 Width = ImageWrapper->GetWidth();
@@ -40,74 +210,167 @@ UTexture2D* FTextureUtils::CreateTextureFromImageData(const TArray<uint8>& Image
     if (Width <= 0 || Height <= 0)
     {
         UE_LOG(LogTextureGenerator, Error, TEXT("Invalid image dimensions: %dx%d"), Width, Height);
-        return nullptr;
+        return false;
     }
 
-    // Get the raw image data
-    TArray<uint8> RawData;
-    if (!ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, RawData))
+    // Get the raw image data in the decoder's native channel order and swizzle it in place,
+    // the vector kernel is much faster than the image wrapper's per pixel conversion
+    OutImage.Init(Width, Height, ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+    if (!ImageWrapper->GetRaw(ERGBFormat::RGBA, 8, OutImage.RawData))
     {
         UE_LOG(LogTemp, Error, TEXT("Failed to get raw image data"));
-        return nullptr;
+        return false;
     }
 
-    // Create a unique package name
-    FString PackagePath = GetMutableDefault<UTextureGeneratorSettings>()->DefaultAssetPath;
-    FString TextureName = FString::Printf(TEXT("T_%s"), *BaseName);
-    OutPackageName = PackagePath + TextureName;
+    FPixelKernels::SwizzleRedBlue(OutImage.RawData.GetData(), OutImage.RawData.GetData(), OutImage.GetNumPixels());
 
-    // Create the package
-    UPackage* Package = CreatePackage(*OutPackageName);
-    if (!Package)
+    return true;
+}
+
+UTexture2D* FTextureUtils::CreateTextureFromImage(const FImage& Image, const FString& BaseName, FString& OutPackageName)
+{
+    return TextureUtils::CreateTexture(Image, FString::Printf(TEXT("T_%s"), *BaseName), false, OutPackageName);
+}
+
+UTexture2D* FTextureUtils::CreateMaskTextureFromImage(const FImage& Image, const FString& BaseName, FString& OutPackageName)
+{
+    return TextureUtils::CreateTexture(Image, FString::Printf(TEXT("T_%s_ORM"), *BaseName), true, OutPackageName);
+}
+
+bool FTextureUtils::UpdateTextureFromImage(UTexture2D* Texture, const FImage& Image, bool bApplySizeSettings)
+{
+    const ETextureSourceFormat SourceFormat = FImageCoreUtils::ConvertToTextureSourceFormat(Image.Format);
+    if (!Texture || SourceFormat == TSF_Invalid || Image.SizeX <= 0 || Image.SizeY <= 0)
     {
-        UE_LOG(LogTextureGenerator, Error, TEXT("Failed to create package: %s"), *OutPackageName);
-        return nullptr;
+        UE_LOG(LogTextureGenerator, Error, TEXT("Expected a valid texture and a non-empty image."));
+        return false;
     }
 
-    // Create a new texture in the package
-    UTexture2D* NewTexture = NewObject<UTexture2D>(
-        Package,
-        FName(*TextureName),
-        RF_Public | RF_Standalone
-    );
+    Texture->PreEditChange(nullptr);
 
-    if (!NewTexture)
+    const bool bWasVirtual = Texture->VirtualTextureStreaming;
+    if (bApplySizeSettings)
     {
-        UE_LOG(LogTextureGenerator, Error, TEXT("Failed to create texture object"));
-        return nullptr;
+        TextureUtils::ApplySizeSettings(Texture, Image);
     }
 
-    // Set the texture properties
-    NewTexture->NeverStream = true;
-    NewTexture->CompressionSettings = TC_Default;
-    NewTexture->SRGB = true;
-    NewTexture->MipGenSettings = TMGS_NoMipmaps;
-    NewTexture->AddressX = TA_Clamp;
-    NewTexture->AddressY = TA_Clamp;
-
-    // Initialize the texture source with the decoded data
-    FTextureSource& TextureSource = NewTexture->Source;
-    
-    // Use BGRA8 format since we decoded to BGRA
+    // Decoded results are BGRA8, edited references keep their own format
+    FTextureSource& TextureSource = Texture->Source;
     TextureSource.Init(
-        Width,
-        Height,
+        Image.SizeX,
+        Image.SizeY,
         1, // NumSlices
         1, // NumMips
-        TSF_BGRA8,
-        RawData.GetData()
+        SourceFormat,
+        Image.RawData.GetData()
     );
 
-    // Update the texture resource
-    NewTexture->UpdateResource();
+    // Derive the source id from the pixels instead of a random guid, so identical images built with
+    // identical settings get identical derived data cache keys on every machine
+    TextureSource.UseHashAsGuid();
+
+    // Goes through the texture compiling manager, so the compression runs in the background
+    // and the texture renders with a placeholder until it is done
+    Texture->PostEditChange();
 
     // Mark the package dirty so it will be saved
-    Package->MarkPackageDirty();
+    Texture->MarkPackageDirty();
 
-    // Notify the asset registry
-    FAssetRegistryModule::AssetCreated(NewTexture);
+    // Samplers have to match the texture, a material sampling it with the other type no longer compiles
+    if (Texture->VirtualTextureStreaming != bWasVirtual)
+    {
+        for (TObjectIterator<UMaterial> It; It; ++It)
+        {
+            bool bChanged = false;
+            for (UMaterialExpression* Expression : It->GetExpressions())
+            {
+                UMaterialExpressionTextureBase* TextureExpression = Cast<UMaterialExpressionTextureBase>(Expression);
+                if (TextureExpression && TextureExpression->Texture == Texture)
+                {
+                    if (!bChanged)
+                    {
+                        It->PreEditChange(nullptr);
+                        bChanged = true;
+                    }
+                    TextureExpression->AutoSetSampleType();
+                }
+            }
 
-    return NewTexture;
+            if (bChanged)
+            {
+                It->PostEditChange();
+                It->MarkPackageDirty();
+            }
+        }
+    }
+
+    return true;
+}
+
+bool FTextureUtils::IsVirtualTexturingEnabled()
+{
+    static const IConsoleVariable* VirtualTexturesCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("r.VirtualTextures"));
+    return VirtualTexturesCVar && VirtualTexturesCVar->GetInt() != 0;
+}
+
+bool FTextureUtils::DoesGeneratedAssetExist(const FString& AssetName)
+{
+    const FString PackageName = GetDefault<UTextureGeneratorSettings>()->DefaultAssetPath + AssetName;
+    return FindPackage(nullptr, *PackageName) || FPackageName::DoesPackageExist(PackageName);
+}
+
+UObject* FTextureUtils::FindGeneratedAsset(const FString& AssetName)
+{
+    // Avoid load warnings for assets which were never generated
+    if (!DoesGeneratedAssetExist(AssetName))
+    {
+        return nullptr;
+    }
+
+    const FString PackageName = GetDefault<UTextureGeneratorSettings>()->DefaultAssetPath + AssetName;
+    return StaticLoadObject(UObject::StaticClass(), nullptr, *(PackageName + TEXT(".") + AssetName), nullptr, LOAD_NoWarn | LOAD_Quiet);
+}
+
+void FTextureUtils::SetGeneratorMetaData(UObject* Object, const TCHAR* Key, const FString& Value)
+{
+    if (Object)
+    {
+        Object->GetPackage()->GetMetaData()->SetValue(Object, Key, *Value);
+    }
+}
+
+FString FTextureUtils::GetGeneratorMetaData(const UObject* Object, const TCHAR* Key)
+{
+    if (!Object)
+    {
+        return FString();
+    }
+
+    UMetaData* MetaData = Object->GetPackage()->GetMetaData();
+    return MetaData->HasValue(Object, Key) ? MetaData->GetValue(Object, Key) : FString();
+}
+
+bool FTextureUtils::GetGeneratorTag(const FAssetData& Asset, const TCHAR* Key, FString& OutValue)
+{
+    return Asset.GetTagValue(FName(Key), OutValue);
+}
+
+void FTextureUtils::RegisterMetaDataTags()
+{
+    TSet<FName>& Tags = UObject::GetMetaDataTagsForAssetRegistry();
+    for (const FName& Tag : TextureUtils::GetMetaDataTags())
+    {
+        Tags.Add(Tag);
+    }
+}
+
+void FTextureUtils::UnregisterMetaDataTags()
+{
+    TSet<FName>& Tags = UObject::GetMetaDataTagsForAssetRegistry();
+    for (const FName& Tag : TextureUtils::GetMetaDataTags())
+    {
+        Tags.Remove(Tag);
+    }
 }
 
 UMaterial* FTextureUtils::CreateMaterialForTexture(UTexture2D* Texture, const FString& BaseName, FString& OutPackageName)
@@ -147,7 +410,7 @@ UMaterial* FTextureUtils::CreateMaterialForTexture(UTexture2D* Texture, const FS
     UMaterialExpressionTextureSampleParameter2D* TextureSample = NewObject<UMaterialExpressionTextureSampleParameter2D>(NewMaterial);
     TextureSample->ParameterName = FName(*FString::Printf(TEXT("BaseColor_%s"), *FGuid::NewGuid().ToString().Left(8)));
     TextureSample->Texture = Texture;
-    TextureSample->SamplerType = SAMPLERTYPE_Color;
+    TextureSample->SamplerType = Texture->VirtualTextureStreaming ? SAMPLERTYPE_VirtualColor : SAMPLERTYPE_Color;
     // Offset the position of the node in the material graph
     TextureSample->MaterialExpressionEditorX = -400;
     TextureSample->MaterialExpressionEditorY = 0;
@@ -177,12 +440,256 @@ UMaterial* FTextureUtils::CreateMaterialForTexture(UTexture2D* Texture, const FS
     NewMaterial->PostEditChange();
     NewMaterial->MarkPackageDirty();
     
-    // Notify the asset registry
-    FAssetRegistryModule::AssetCreated(NewMaterial);
-    
+    // Created by the asset tools, which already notified the asset registry
     return NewMaterial;
 }
 
+UTexture2DArray* FTextureUtils::CreateTextureArrayFromImages(const TArray<FImage>& Images, const FString& BaseName, FString& OutPackageName)
+{
+    if (Images.Num() == 0)
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Cannot create a texture array without images."));
+        return nullptr;
+    }
+
+    const int32 Width = Images[0].SizeX;
+    const int32 Height = Images[0].SizeY;
+    for (const FImage& Image : Images)
+    {
+        if (Image.Format != ERawImageFormat::BGRA8 || Image.SizeX != Width || Image.SizeY != Height || Width <= 0 || Height <= 0)
+        {
+            UE_LOG(LogTextureGenerator, Error, TEXT("Texture array slices must be non-empty BGRA8 images of the same size."));
+            return nullptr;
+        }
+    }
+
+    // Create a unique package name
+    FString PackagePath = GetMutableDefault<UTextureGeneratorSettings>()->DefaultAssetPath;
+    FString TextureName = FString::Printf(TEXT("T_%s_Array"), *BaseName);
+    OutPackageName = PackagePath + TextureName;
+
+    UPackage* Package = CreatePackage(*OutPackageName);
+    if (!Package)
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Failed to create package: %s"), *OutPackageName);
+        return nullptr;
+    }
+
+    UTexture2DArray* NewTexture = NewObject<UTexture2DArray>(
+        Package,
+        FName(*TextureName),
+        RF_Public | RF_Standalone
+    );
+
+    if (!NewTexture)
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Failed to create texture array object"));
+        return nullptr;
+    }
+
+    // Same settings as single generated textures
+    NewTexture->NeverStream = true;
+    NewTexture->CompressionSettings = TC_Default;
+    NewTexture->SRGB = true;
+    NewTexture->MipGenSettings = TMGS_NoMipmaps;
+    NewTexture->AddressX = TA_Clamp;
+    NewTexture->AddressY = TA_Clamp;
+
+    // Slices are stored back to back in the source
+    const int64 SliceSize = Images[0].RawData.Num();
+    TArray64<uint8> SourceData;
+    SourceData.SetNumUninitialized(SliceSize * Images.Num());
+    for (int32 SliceIndex = 0; SliceIndex < Images.Num(); ++SliceIndex)
+    {
+        FMemory::Memcpy(SourceData.GetData() + SliceIndex * SliceSize, Images[SliceIndex].RawData.GetData(), SliceSize);
+    }
+
+    NewTexture->Source.Init(
+        Width,
+        Height,
+        Images.Num(), // NumSlices
+        1, // NumMips
+        TSF_BGRA8,
+        SourceData.GetData()
+    );
+    NewTexture->Source.UseHashAsGuid();
+
+    // Compiles in the background like single textures
+    NewTexture->PostEditChange();
+    Package->MarkPackageDirty();
+
+    FAssetRegistryModule::AssetCreated(NewTexture);
+
+    return NewTexture;
+}
+
+UMaterial* FTextureUtils::CreateMaterialForTextureArray(UTexture2DArray* TextureArray, const FString& BaseName, FString& OutPackageName)
+{
+    if (!TextureArray)
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Invalid texture array passed. Cannot create material."));
+        return nullptr;
+    }
+
+    IAssetTools& AssetTools = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools").Get();
+
+    FString MaterialName = FString::Printf(TEXT("M_%s_Array"), *BaseName);
+    FString PackagePath = GetMutableDefault<UTextureGeneratorSettings>()->DefaultAssetPath;
+    OutPackageName = PackagePath + MaterialName;
+
+    UMaterialFactoryNew* MaterialFactory = NewObject<UMaterialFactoryNew>();
+    UMaterial* NewMaterial = (UMaterial*)AssetTools.CreateAsset(
+        MaterialName,
+        PackagePath,
+        UMaterial::StaticClass(),
+        MaterialFactory
+    );
+
+    if (!NewMaterial)
+    {
+        return nullptr;
+    }
+
+    NewMaterial->Modify();
+    UMaterialEditorOnlyData* EditorOnlyData = NewMaterial->GetEditorOnlyData();
+
+    // Slice picked by the material instance, used whenever the mesh does not provide per-instance data
+    UMaterialExpressionScalarParameter* VariantIndex = NewObject<UMaterialExpressionScalarParameter>(NewMaterial);
+    VariantIndex->ParameterName = TEXT("VariantIndex");
+    VariantIndex->DefaultValue = 0.0f;
+    VariantIndex->MaterialExpressionEditorX = -1000;
+    VariantIndex->MaterialExpressionEditorY = 200;
+    EditorOnlyData->ExpressionCollection.Expressions.Add(VariantIndex);
+
+    // Instanced meshes pick their variant through the first custom data float
+    UMaterialExpressionPerInstanceCustomData* InstanceVariant = NewObject<UMaterialExpressionPerInstanceCustomData>(NewMaterial);
+    InstanceVariant->DataIndex = 0;
+    InstanceVariant->DefaultValue.Expression = VariantIndex;
+    InstanceVariant->MaterialExpressionEditorX = -800;
+    InstanceVariant->MaterialExpressionEditorY = 200;
+    EditorOnlyData->ExpressionCollection.Expressions.Add(InstanceVariant);
+
+    UMaterialExpressionTextureCoordinate* TexCoord = NewObject<UMaterialExpressionTextureCoordinate>(NewMaterial);
+    TexCoord->MaterialExpressionEditorX = -800;
+    TexCoord->MaterialExpressionEditorY = 0;
+    EditorOnlyData->ExpressionCollection.Expressions.Add(TexCoord);
+
+    // Texture arrays are sampled with the slice index as the third coordinate
+    UMaterialExpressionAppendVector* Coordinates = NewObject<UMaterialExpressionAppendVector>(NewMaterial);
+    Coordinates->A.Expression = TexCoord;
+    Coordinates->B.Expression = InstanceVariant;
+    Coordinates->MaterialExpressionEditorX = -600;
+    Coordinates->MaterialExpressionEditorY = 0;
+    EditorOnlyData->ExpressionCollection.Expressions.Add(Coordinates);
+
+    UMaterialExpressionTextureSampleParameter2DArray* TextureSample = NewObject<UMaterialExpressionTextureSampleParameter2DArray>(NewMaterial);
+    TextureSample->ParameterName = TEXT("Variants");
+    TextureSample->Texture = TextureArray;
+    TextureSample->SamplerType = SAMPLERTYPE_Color;
+    TextureSample->Coordinates.Expression = Coordinates;
+    TextureSample->MaterialExpressionEditorX = -400;
+    TextureSample->MaterialExpressionEditorY = 0;
+    EditorOnlyData->ExpressionCollection.Expressions.Add(TextureSample);
+
+    FExpressionInput& BaseColorInput = EditorOnlyData->BaseColor;
+    BaseColorInput.Expression = TextureSample;
+    BaseColorInput.OutputIndex = 0;
+    BaseColorInput.Mask = 0;
+    BaseColorInput.MaskR = 1;
+    BaseColorInput.MaskG = 1;
+    BaseColorInput.MaskB = 1;
+    BaseColorInput.MaskA = 0;
+
+    NewMaterial->SetShadingModel(MSM_DefaultLit);
+    NewMaterial->TwoSided = false;
+    NewMaterial->BlendMode = BLEND_Opaque;
+    NewMaterial->bUsedWithInstancedStaticMeshes = true;
+
+    // Compile the material
+    NewMaterial->PreEditChange(nullptr);
+    NewMaterial->ForceRecompileForRendering();
+    NewMaterial->PostEditChange();
+    NewMaterial->MarkPackageDirty();
+
+    return NewMaterial;
+}
+
+UMaterialInstanceConstant* FTextureUtils::CreateMaterialInstance(UMaterial* Parent, const FString& BaseName, FString& OutPackageName)
+{
+    if (!Parent)
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Invalid parent material passed. Cannot create material instance."));
+        return nullptr;
+    }
+
+    IAssetTools& AssetTools = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools").Get();
+
+    FString InstanceName = TEXT("MI_") + BaseName;
+    FString PackagePath = GetMutableDefault<UTextureGeneratorSettings>()->DefaultAssetPath;
+    OutPackageName = PackagePath + InstanceName;
+
+    UMaterialInstanceConstantFactoryNew* InstanceFactory = NewObject<UMaterialInstanceConstantFactoryNew>();
+    InstanceFactory->InitialParent = Parent;
+
+    return Cast<UMaterialInstanceConstant>(AssetTools.CreateAsset(
+        InstanceName,
+        PackagePath,
+        UMaterialInstanceConstant::StaticClass(),
+        InstanceFactory
+    ));
+}
+
+UMaterialInstanceConstant* FTextureUtils::CreatePackedMaterialInstance(UTexture2D* BaseColor, UTexture2D* MaskMap, const FString& BaseName, FString& OutPackageName, bool& bOutCreatedParent)
+{
+    bOutCreatedParent = false;
+
+    if (!BaseColor || !MaskMap)
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Invalid texture objects passed. Cannot create packed material instance."));
+        return nullptr;
+    }
+
+    // Virtual and regular textures need different samplers, the shared material has one variant for each
+    if (BaseColor->VirtualTextureStreaming != MaskMap->VirtualTextureStreaming)
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("%s and %s differ in virtual texture streaming. Cannot create packed material instance."), *BaseColor->GetName(), *MaskMap->GetName());
+        return nullptr;
+    }
+
+    UMaterial* Parent = TextureUtils::FindOrCreatePackedMaterial(BaseColor, MaskMap, bOutCreatedParent);
+    if (!Parent)
+    {
+        UE_LOG(LogTextureGenerator, Error, TEXT("Failed to create the shared packed material."));
+        return nullptr;
+    }
+
+    // Regenerated textures keep their instance, references to it stay valid
+    UMaterialInstanceConstant* Instance = Cast<UMaterialInstanceConstant>(FindGeneratedAsset(TEXT("MI_") + BaseName));
+    if (Instance)
+    {
+        OutPackageName = Instance->GetPackage()->GetName();
+        if (Instance->Parent != Parent)
+        {
+            Instance->SetParentEditorOnly(Parent);
+        }
+    }
+    else
+    {
+        Instance = CreateMaterialInstance(Parent, BaseName, OutPackageName);
+        if (!Instance)
+        {
+            return nullptr;
+        }
+    }
+
+    Instance->SetTextureParameterValueEditorOnly(FMaterialParameterInfo(TextureUtils::BaseColorParameter), BaseColor);
+    Instance->SetTextureParameterValueEditorOnly(FMaterialParameterInfo(TextureUtils::MaskMapParameter), MaskMap);
+    Instance->PostEditChange();
+    Instance->MarkPackageDirty();
+
+    return Instance;
+}
+
 TArray64<uint8> FTextureUtils::GetTextureImageData(UTexture2D* Texture)
 {
     TArray64<uint8> OutData;
@@ -0,0 +1,204 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Utils/TiledCompositor.h"
+
+#include "Async/ParallelFor.h"
+#include "ImageUtils.h"
+
+namespace TiledCompositor
+{
+    // Tile starts along one axis, spread evenly so the last tile ends at the canvas border
+    static TArray<int32> SplitAxis(int32 CanvasSize, int32 TileSize, int32 Overlap)
+    {
+        TArray<int32> Starts;
+        if (CanvasSize <= TileSize)
+        {
+            Starts.Add(0);
+            return Starts;
+        }
+
+        const int32 Stride = TileSize - Overlap;
+        const int32 NumTiles = FMath::DivideAndRoundUp(CanvasSize - Overlap, Stride);
+        for (int32 Index = 0; Index < NumTiles; ++Index)
+        {
+            Starts.Add(static_cast<int32>(static_cast<int64>(Index) * (CanvasSize - TileSize) / (NumTiles - 1)));
+        }
+        return Starts;
+    }
+
+    // Widths of the overlaps with neighbouring tiles at the left, top, right and bottom edge of a tile
+    struct FFades
+    {
+        FIntPoint Min = FIntPoint::ZeroValue;
+        FIntPoint Max = FIntPoint::ZeroValue;
+    };
+
+    static FFades FindFades(const TArray<FIntRect>& Tiles, int32 TileIndex)
+    {
+        const FIntRect& Tile = Tiles[TileIndex];
+
+        FFades Fades;
+        for (int32 OtherIndex = 0; OtherIndex < Tiles.Num(); ++OtherIndex)
+        {
+            const FIntRect& Other = Tiles[OtherIndex];
+            if (OtherIndex == TileIndex || !Tile.Intersect(Other))
+            {
+                continue;
+            }
+
+            for (int32 Axis = 0; Axis < 2; ++Axis)
+            {
+                if (Other.Min[Axis] < Tile.Min[Axis])
+                {
+                    Fades.Min[Axis] = FMath::Max(Fades.Min[Axis], Other.Max[Axis] - Tile.Min[Axis]);
+                }
+                if (Other.Max[Axis] > Tile.Max[Axis])
+                {
+                    Fades.Max[Axis] = FMath::Max(Fades.Max[Axis], Tile.Max[Axis] - Other.Min[Axis]);
+                }
+            }
+        }
+        return Fades;
+    }
+
+    // Linear ramp up over the start fade and down over the end fade, never reaching zero inside the tile
+    FORCEINLINE float GetRamp(int32 Position, int32 Size, int32 FadeStart, int32 FadeEnd)
+    {
+        float Weight = 1.0f;
+        if (FadeStart > 0)
+        {
+            Weight = FMath::Min(Weight, (Position + 0.5f) / FadeStart);
+        }
+        if (FadeEnd > 0)
+        {
+            Weight = FMath::Min(Weight, (Size - Position - 0.5f) / FadeEnd);
+        }
+        return Weight;
+    }
+}
+
+TArray<FIntRect> FTiledCompositor::SplitIntoTiles(FIntPoint CanvasSize, int32 TileSize, int32 Overlap)
+{
+    TileSize = FMath::Max(1, TileSize);
+    Overlap = FMath::Clamp(Overlap, 0, TileSize / 2);
+
+    const TArray<int32> StartsX = TiledCompositor::SplitAxis(CanvasSize.X, TileSize, Overlap);
+    const TArray<int32> StartsY = TiledCompositor::SplitAxis(CanvasSize.Y, TileSize, Overlap);
+
+    TArray<FIntRect> Tiles;
+    Tiles.Reserve(StartsX.Num() * StartsY.Num());
+    for (int32 StartY : StartsY)
+    {
+        for (int32 StartX : StartsX)
+        {
+            Tiles.Emplace(StartX, StartY, FMath::Min(StartX + TileSize, CanvasSize.X), FMath::Min(StartY + TileSize, CanvasSize.Y));
+        }
+    }
+    return Tiles;
+}
+
+bool FTiledCompositor::EncodeTile(const FImage& Canvas, const FIntRect& Tile, TArray<uint8>& OutImageData)
+{
+    const int32 Width = Tile.Width();
+    const int32 Height = Tile.Height();
+    if (Width <= 0 || Height <= 0 || Canvas.Format != ERawImageFormat::BGRA8)
+    {
+        return false;
+    }
+
+    FImage TileImage(Width, Height, ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+    const FColor* CanvasPixels = reinterpret_cast<const FColor*>(Canvas.RawData.GetData());
+    FColor* TilePixels = reinterpret_cast<FColor*>(TileImage.RawData.GetData());
+    for (int32 Y = 0; Y < Height; ++Y)
+    {
+        FMemory::Memcpy(
+            TilePixels + static_cast<int64>(Y) * Width,
+            CanvasPixels + static_cast<int64>(Tile.Min.Y + Y) * Canvas.SizeX + Tile.Min.X,
+            Width * sizeof(FColor));
+    }
+
+    TArray64<uint8> ImageData;
+    if (!FImageUtils::CompressImage(ImageData, TEXT("png"), TileImage))
+    {
+        return false;
+    }
+
+    OutImageData = TArray<uint8>(ImageData);
+    return true;
+}
+
+void FTiledCompositor::Blend(FImage& Canvas, const TArray<FIntRect>& Tiles, TArray<FImage>& TileImages)
+{
+    using namespace TiledCompositor;
+
+    check(Canvas.Format == ERawImageFormat::BGRA8 && Tiles.Num() == TileImages.Num());
+
+    // Results may come back at a different resolution than requested
+    ParallelFor(Tiles.Num(), [&Tiles, &TileImages](int32 TileIndex)
+    {
+        FImage& TileImage = TileImages[TileIndex];
+        const FIntRect& Tile = Tiles[TileIndex];
+        if (TileImage.RawData.Num() > 0
+            && (TileImage.SizeX != Tile.Width() || TileImage.SizeY != Tile.Height() || TileImage.Format != ERawImageFormat::BGRA8))
+        {
+            FImage Resized;
+            TileImage.ResizeTo(Resized, Tile.Width(), Tile.Height(), ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+            TileImage = MoveTemp(Resized);
+        }
+    });
+
+    TArray<FFades> Fades;
+    Fades.Reserve(Tiles.Num());
+    for (int32 TileIndex = 0; TileIndex < Tiles.Num(); ++TileIndex)
+    {
+        Fades.Add(FindFades(Tiles, TileIndex));
+    }
+
+    // Every row is blended independently, accumulating the weighted colors of the tiles covering it
+    FColor* CanvasPixels = reinterpret_cast<FColor*>(Canvas.RawData.GetData());
+    const int32 Width = Canvas.SizeX;
+    ParallelFor(Canvas.SizeY, [&](int32 Y)
+    {
+        TArray<FVector4f> Accumulated;
+        Accumulated.SetNumZeroed(Width);
+
+        for (int32 TileIndex = 0; TileIndex < Tiles.Num(); ++TileIndex)
+        {
+            const FIntRect& Tile = Tiles[TileIndex];
+            const FImage& TileImage = TileImages[TileIndex];
+            if (TileImage.RawData.Num() == 0 || Y < Tile.Min.Y || Y >= Tile.Max.Y)
+            {
+                continue;
+            }
+
+            const FFades& TileFades = Fades[TileIndex];
+            const int32 TileY = Y - Tile.Min.Y;
+            const float WeightY = GetRamp(TileY, Tile.Height(), TileFades.Min.Y, TileFades.Max.Y);
+            const FColor* TileRow = reinterpret_cast<const FColor*>(TileImage.RawData.GetData()) + static_cast<int64>(TileY) * Tile.Width();
+
+            for (int32 TileX = 0; TileX < Tile.Width(); ++TileX)
+            {
+                const float Weight = WeightY * GetRamp(TileX, Tile.Width(), TileFades.Min.X, TileFades.Max.X);
+                const FColor& Color = TileRow[TileX];
+                Accumulated[Tile.Min.X + TileX] += FVector4f(Color.R * Weight, Color.G * Weight, Color.B * Weight, Weight);
+            }
+        }
+
+        FColor* CanvasRow = CanvasPixels + static_cast<int64>(Y) * Width;
+        for (int32 X = 0; X < Width; ++X)
+        {
+            const FVector4f& Sum = Accumulated[X];
+            if (Sum.W <= 0.0f)
+            {
+                continue;
+            }
+
+            const float InvWeight = 1.0f / Sum.W;
+            CanvasRow[X] = FColor(
+                static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Sum.X * InvWeight), 0, 255)),
+                static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Sum.Y * InvWeight), 0, 255)),
+                static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Sum.Z * InvWeight), 0, 255)),
+                CanvasRow[X].A);
+        }
+    });
+}
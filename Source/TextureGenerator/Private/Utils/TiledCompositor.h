@@ -0,0 +1,29 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageCore.h"
+
+/**
+ * Tiled synthesis of textures larger than a single generation. The canvas is split into overlapping tiles,
+ * which are refined independently and blended back with linear ramps across their overlaps.
+ */
+class FTiledCompositor
+{
+public:
+    /**
+     * Splits the canvas into a grid of tiles of at most TileSize, spread evenly so that neighbours overlap by at least Overlap.
+     * Tiles are ordered row by row.
+     */
+    static TArray<FIntRect> SplitIntoTiles(FIntPoint CanvasSize, int32 TileSize, int32 Overlap);
+
+    /** Encodes the tile region of the canvas as PNG. */
+    static bool EncodeTile(const FImage& Canvas, const FIntRect& Tile, TArray<uint8>& OutImageData);
+
+    /**
+     * Blends the tile images into the canvas, in parallel. Tile images are resized to their tile when they differ.
+     * Empty tile images are skipped, leaving the canvas visible where no other tile covers it.
+     */
+    static void Blend(FImage& Canvas, const TArray<FIntRect>& Tiles, TArray<FImage>& TileImages);
+};
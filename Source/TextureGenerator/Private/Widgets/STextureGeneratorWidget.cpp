@@ -4,7 +4,7 @@
 #include "TextureGeneratorStyle.h"
 #include "TextureGeneratorSettings.h"
 #include "TextureGeneratorModule.h"
-#include "Utils/TextureUtils.h"
+#include "Subsystems/TextureGeneratorSubsystem.h"
 
 #include "Async/Async.h"
 #include "Framework/Application/SlateApplication.h"
@@ -20,6 +20,7 @@
 #include "AssetThumbnail.h"
 #include "Editor.h"
 #include "Engine/Texture2D.h"
+#include "TextureCompiler.h"
 #include "FileHelpers.h"
 #include "Misc/Paths.h"
 #include "Misc/MessageDialog.h"
@@ -28,28 +29,30 @@
 
 #define LOCTEXT_NAMESPACE "TextureGenerator"
 
+STextureGeneratorWidget::~STextureGeneratorWidget()
+{
+    FinishCompileNotification();
+}
+
 void STextureGeneratorWidget::Construct(const FArguments& InArgs)
 {
     // Initialize thumbnail pool for the texture picker
     AssetThumbnailPool = MakeShareable(new FAssetThumbnailPool(24));
     
-    // Initialize the Stability AI API client
-    Client = MakeUnique<FStabilityAPIClient>();
     const FString APIKey = GetMutableDefault<UTextureGeneratorSettings>()->APIKey;
     if (APIKey.IsEmpty())
     {
         FMessageDialog::Open(EAppMsgType::Ok, FText::FromString("Stability API Key not set. Go to Project Settings -> Stability AI Image Generator -> and fill in the API key parameter."));
     }
-    Client->SetAPIKey(APIKey);
     
-    // Bind API callbacks
-    Client->OnImageGenerated.BindRaw(this, &STextureGeneratorWidget::OnImageGenerated);
-    Client->OnError.BindRaw(this, &STextureGeneratorWidget::OnGenerationError);
+    // Generation runs through the editor subsystem, listen for our jobs finishing
+    GEditor->GetEditorSubsystem<UTextureGeneratorSubsystem>()->OnJobFinishedNative().AddSP(this, &STextureGeneratorWidget::OnJobFinished);
 
     // Initialize model selection options
     ModelOptions.Add(MakeShareable(new EImageGenerationModel(EImageGenerationModel::StableImageUltra)));
     ModelOptions.Add(MakeShareable(new EImageGenerationModel(EImageGenerationModel::StableImageCore)));
     ModelOptions.Add(MakeShareable(new EImageGenerationModel(EImageGenerationModel::StableDiffusion)));
+    ModelOptions.Add(MakeShareable(new EImageGenerationModel(EImageGenerationModel::Placeholder)));
     SelectedModelOption = ModelOptions[0];
 
     // Initialize style selection options
@@ -243,6 +246,57 @@ TSharedRef<SWidget> STextureGeneratorWidget::CreateImageSettingsSection()
         + SVerticalBox::Slot()
         .AutoHeight()
         .Padding(0.0f, 12.0f, 0.0f, 0.0f)
+        [
+            // Mask selector - only visible when reference texture is selected
+            SNew(SBox)
+            .Visibility_Lambda([this]() -> EVisibility
+            {
+                return SelectedReferenceTexture.IsValid() ? EVisibility::Visible : EVisibility::Collapsed;
+            })
+            [
+                SNew(SVerticalBox)
+                + SVerticalBox::Slot()
+                .AutoHeight()
+                [
+                    SNew(STextBlock)
+                    .Text(LOCTEXT("MaskLabel", "Mask"))
+                    .Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
+                ]
+                + SVerticalBox::Slot()
+                .AutoHeight()
+                .Padding(0.0f, 4.0f, 0.0f, 0.0f)
+                [
+                    SNew(SObjectPropertyEntryBox)
+                    .AllowedClass(UTexture2D::StaticClass())
+                    .ObjectPath_Lambda([this]() -> FString
+                    {
+                        return SelectedMaskTexture.IsValid() ?
+                            SelectedMaskTexture->GetPathName() :
+                            FString();
+                    })
+                    .OnObjectChanged(this, &STextureGeneratorWidget::OnMaskTextureChanged)
+                    .AllowClear(true)
+                    .DisplayUseSelected(true)
+                    .DisplayBrowse(true)
+                    .DisplayThumbnail(true)
+                    .ThumbnailPool(AssetThumbnailPool)
+                    .NewAssetFactories(TArray<UFactory*>())
+                ]
+                + SVerticalBox::Slot()
+                .AutoHeight()
+                .Padding(0.0f, 4.0f, 0.0f, 0.0f)
+                [
+                    SNew(STextBlock)
+                    .Text(LOCTEXT("MaskHint", "Optional. White pixels mark the region of the reference to regenerate, the rest of the reference texture stays untouched"))
+                    .Font(FCoreStyle::GetDefaultFontStyle("Regular", 8))
+                    .ColorAndOpacity(FSlateColor::UseSubduedForeground())
+                    .AutoWrapText(true)
+                ]
+            ]
+        ]
+        + SVerticalBox::Slot()
+        .AutoHeight()
+        .Padding(0.0f, 12.0f, 0.0f, 0.0f)
         [
             // Strength slider container - only visible when reference texture is selected
             SAssignNew(StrengthContainer, SBox)
@@ -488,6 +542,34 @@ TSharedRef<SWidget> STextureGeneratorWidget::CreateActionButtons()
                 + SHorizontalBox::Slot()
                 .AutoWidth()
                 .Padding(8.0f, 0.0f, 0.0f, 0.0f)
+                [
+                    SNew(SButton)
+                    .Text(LOCTEXT("DraftButton", "Draft"))
+                    .ToolTipText(LOCTEXT("DraftTooltip", "Generate a quick preview with the fastest model, then refine it with the model selected now"))
+                    .OnClicked(this, &STextureGeneratorWidget::OnDraftClicked)
+                    .IsEnabled_Lambda([this]()
+                    {
+                        // Masked edits cannot be drafted
+                        const bool bMasked = SelectedReferenceTexture.IsValid() && SelectedMaskTexture.IsValid();
+                        return !PromptTextBox->GetText().ToString().IsEmpty() && !bInProgress && !bMasked;
+                    })
+                ]
+                + SHorizontalBox::Slot()
+                .AutoWidth()
+                .Padding(8.0f, 0.0f, 0.0f, 0.0f)
+                [
+                    SNew(SButton)
+                    .Text(LOCTEXT("RefineButton", "Refine"))
+                    .ToolTipText(LOCTEXT("RefineTooltip", "Generate the last draft again with the model selected when it was drafted and the same seed, using the draft as reference"))
+                    .OnClicked(this, &STextureGeneratorWidget::OnRefineClicked)
+                    .IsEnabled_Lambda([this]()
+                    {
+                        return DraftJobId.IsValid() && !bInProgress;
+                    })
+                ]
+                + SHorizontalBox::Slot()
+                .AutoWidth()
+                .Padding(8.0f, 0.0f, 0.0f, 0.0f)
                 [
                     SAssignNew(CancelButton, SButton)
                     .Text(LOCTEXT("CancelButton", "Cancel"))
@@ -545,6 +627,8 @@ FText STextureGeneratorWidget::GetModelDisplayName(EImageGenerationModel Model)
         return LOCTEXT("StableImageCoreName", "Stable Image Core");
     case EImageGenerationModel::StableDiffusion:
         return LOCTEXT("StableDiffusionName", "Stable Diffusion");
+    case EImageGenerationModel::Placeholder:
+        return LOCTEXT("PlaceholderName", "Local Placeholder");
     default:
         return LOCTEXT("UnknownModel", "Unknown Model");
     }
@@ -560,6 +644,8 @@ FText STextureGeneratorWidget::GetModelDescription(EImageGenerationModel Model)
         return LOCTEXT("StableImageCoreDesc", "Best quality to speed ratio");
     case EImageGenerationModel::StableDiffusion:
         return LOCTEXT("StableDiffusion3Desc", "Base model");
+    case EImageGenerationModel::Placeholder:
+        return LOCTEXT("PlaceholderDesc", "Instant procedural texture for blockouts, no credits used");
     default:
         return LOCTEXT("UnknownModelDesc", "Unknown model type");
     }
@@ -640,51 +726,6 @@ FText STextureGeneratorWidget::GetStyleDisplayName(EStylePreset Style) const
     }
 }
 
-FString STextureGeneratorWidget::GetStyleAPIString(EStylePreset Style) const
-{
-    switch (Style)
-    {
-    case EStylePreset::None:
-        return FString();
-    case EStylePreset::Model3D:
-        return TEXT("3d-model");
-    case EStylePreset::AnalogFilm:
-        return TEXT("analog-film");
-    case EStylePreset::Anime:
-        return TEXT("anime");
-    case EStylePreset::Cinematic:
-        return TEXT("cinematic");
-    case EStylePreset::ComicBook:
-        return TEXT("comic-book");
-    case EStylePreset::DigitalArt:
-        return TEXT("digital-art");
-    case EStylePreset::Enhance:
-        return TEXT("enhance");
-    case EStylePreset::FantasyArt:
-        return TEXT("fantasy-art");
-    case EStylePreset::Isometric:
-        return TEXT("isometric");
-    case EStylePreset::LineArt:
-        return TEXT("line-art");
-    case EStylePreset::LowPoly:
-        return TEXT("low-poly");
-    case EStylePreset::ModelingCompound:
-        return TEXT("modeling-compound");
-    case EStylePreset::NeonPunk:
-        return TEXT("neon-punk");
-    case EStylePreset::Origami:
-        return TEXT("origami");
-    case EStylePreset::Photographic:
-        return TEXT("photographic");
-    case EStylePreset::PixelArt:
-        return TEXT("pixel-art");
-    case EStylePreset::TileTexture:
-        return TEXT("tile-texture");
-    default:
-        return FString();
-    }
-}
-
 void STextureGeneratorWidget::OnStyleSelectionChanged(TSharedPtr<EStylePreset> NewSelection,
     ESelectInfo::Type SelectInfo)
 {
@@ -706,7 +747,19 @@ void STextureGeneratorWidget::OnReferenceTextureChanged(const FAssetData& AssetD
     }
 }
 
-FReply STextureGeneratorWidget::OnGenerateClicked()
+void STextureGeneratorWidget::OnMaskTextureChanged(const FAssetData& AssetData)
+{
+    if (AssetData.IsValid())
+    {
+        SelectedMaskTexture = Cast<UTexture2D>(AssetData.GetAsset());
+    }
+    else
+    {
+        SelectedMaskTexture.Reset();
+    }
+}
+
+bool STextureGeneratorWidget::MakeRequest(FTextureGenerationRequest& OutRequest)
 {
     FString PromptText = PromptTextBox->GetText().ToString();
     FString NegativePromptText = NegativePromptTextBox->GetText().ToString();
@@ -714,40 +767,80 @@ FReply STextureGeneratorWidget::OnGenerateClicked()
     if (PromptText.IsEmpty())
     {
         OnGenerationError(TEXT("Prompt text is empty. Please enter some text first to generate the texture."));
-        return FReply::Handled();
+        return false;
     }
 
-    // Get the style preset string for the API
-    FString StylePreset;
-    if (SelectedStyleOption.IsValid() && *SelectedStyleOption != EStylePreset::None)
+    // Runs text-to-image by default.
+    // If valid texture was passed, it attempts to run image-to-image workflow.
+    OutRequest.Prompt = PromptText;
+    OutRequest.NegativePrompt = NegativePromptText;
+    OutRequest.Model = *SelectedModelOption;
+    OutRequest.Seed = GenerationSeed;
+    OutRequest.StylePreset = SelectedStyleOption.IsValid() ? *SelectedStyleOption : EStylePreset::None;
+    OutRequest.ReferenceTexture = SelectedReferenceTexture.Get();
+    OutRequest.Strength = Strength;
+
+    // With a mask, only the masked region of the reference is regenerated
+    OutRequest.MaskTexture = SelectedReferenceTexture.IsValid() ? SelectedMaskTexture.Get() : nullptr;
+    return true;
+}
+
+void STextureGeneratorWidget::TrackJob(const FGuid& JobId, bool bIsDraft)
+{
+    if (!JobId.IsValid())
     {
-        StylePreset = GetStyleAPIString(*SelectedStyleOption);
+        OnGenerationError(TEXT("The generation could not be started, see the output log for details."));
+        return;
     }
 
-    int32 SeedValue = GenerationSeed;
-
     // Start progress tracking
     bInProgress = true;
     GenerationProgress = 0.0f;
     StartProgressSimulation();
 
-    // Send request to the API - runs text-to-image by default.
-    // If valid texture was passed, it attempts to run image-to-image workflow.
-    Client->GenerateImage(
-        PromptText,
-        NegativePromptText,
-        SelectedReferenceTexture.Get(),
-        Strength,
-        *SelectedModelOption,
-        SeedValue,
-        StylePreset);
+    ActiveJobId = JobId;
+    bActiveJobIsDraft = bIsDraft;
+}
+
+FReply STextureGeneratorWidget::OnGenerateClicked()
+{
+    FTextureGenerationRequest Request;
+    if (MakeRequest(Request))
+    {
+        // Send request to the API
+        TrackJob(GEditor->GetEditorSubsystem<UTextureGeneratorSubsystem>()->GenerateTexture(Request), false);
+    }
     
     return FReply::Handled();
 }
 
+FReply STextureGeneratorWidget::OnDraftClicked()
+{
+    FTextureGenerationRequest Request;
+    if (MakeRequest(Request))
+    {
+        TrackJob(GEditor->GetEditorSubsystem<UTextureGeneratorSubsystem>()->GenerateDraft(Request), true);
+    }
+
+    return FReply::Handled();
+}
+
+FReply STextureGeneratorWidget::OnRefineClicked()
+{
+    // The draft is consumed, refining it again would produce the same result
+    const FGuid JobId = DraftJobId;
+    DraftJobId.Invalidate();
+    TrackJob(GEditor->GetEditorSubsystem<UTextureGeneratorSubsystem>()->RefineDraft(JobId), false);
+
+    return FReply::Handled();
+}
+
 FReply STextureGeneratorWidget::OnCancelClicked()
 {
-    Client->CancelRequest();
+    // Stop tracking the job first, so its cancellation is not reported as an error
+    const FGuid JobId = ActiveJobId;
+    ActiveJobId.Invalidate();
+    GEditor->GetEditorSubsystem<UTextureGeneratorSubsystem>()->CancelJob(JobId);
 
     // Reset progress state
     bInProgress = false;
@@ -764,55 +857,101 @@ FReply STextureGeneratorWidget::OnCancelClicked()
     return FReply::Handled();
 }
 
-void STextureGeneratorWidget::OnImageGenerated(const TArray<uint8>& ImageData)
+void STextureGeneratorWidget::OnJobFinished(const FTextureGenerationJobInfo& JobInfo)
 {
-    // Complete progress
-    GenerationProgress = 1.0f;
-    StopProgressSimulation();
-    
-    // Save the generated image as texture asset
-    FString PackageName;
-    FString BaseName = FGuid::NewGuid().ToString().Left(8);
-    UTexture2D* NewTexture = FTextureUtils::CreateTextureFromImageData(ImageData, BaseName, PackageName);
-    if (!NewTexture)
+    if (!ActiveJobId.IsValid() || JobInfo.JobId != ActiveJobId)
     {
-        OnGenerationError(TEXT("Creating texture from image data failed."));
         return;
     }
+    ActiveJobId.Invalidate();
 
-    // Create a basic material utilizing the generated texture
-    UMaterial* NewMaterial = FTextureUtils::CreateMaterialForTexture(NewTexture, BaseName, PackageName);
-    if (!NewMaterial)
+    if (JobInfo.State != ETextureGenerationJobState::Completed)
     {
-        OnGenerationError(TEXT("Creating material from texture failed."));
+        OnGenerationError(JobInfo.ErrorMessage);
         return;
     }
 
-    // Save packages
-    TArray<UPackage*> PackagesToSave;
-    PackagesToSave.Add(NewTexture->GetPackage());
-    PackagesToSave.Add(NewMaterial->GetPackage());
-    UEditorLoadingAndSavingUtils::SavePackages(PackagesToSave, true);
+    // A finished draft can be refined until the next draft replaces it
+    if (bActiveJobIsDraft)
+    {
+        DraftJobId = JobInfo.JobId;
+    }
 
-    // Show the newly created objects in the Content Browser
-    TArray<UObject*> Objects;
-    Objects.Add(NewTexture);
-    Objects.Add(NewMaterial);
-    GEditor->SyncBrowserToObjects(Objects);
+    // Complete progress
+    GenerationProgress = 1.0f;
+    StopProgressSimulation();
 
     // Reset progress state
     bInProgress = false;
     GenerationProgress = 0.0f;
 
+    // The texture is usable right away, but keep the notification pending while it compresses in the background
+    FinishCompileNotification();
+    CompilingTexture = JobInfo.Texture;
+    if (CompilingTexture.IsValid() && CompilingTexture->IsCompiling())
+    {
+        FNotificationInfo Info(GetCompileNotificationText());
+        Info.bFireAndForget = false;
+        Info.bUseThrobber = true;
+        CompileNotification = FSlateNotificationManager::Get().AddNotification(Info);
+        if (CompileNotification.IsValid())
+        {
+            CompileNotification->SetCompletionState(SNotificationItem::CS_Pending);
+        }
+
+        CompileTickHandle = FTSTicker::GetCoreTicker().AddTicker(
+            FTickerDelegate::CreateSP(this, &STextureGeneratorWidget::TickCompileNotification), 0.2f);
+        return;
+    }
+
     // Show notification
-    Async(EAsyncExecution::TaskGraphMainThread, []()
+    FNotificationInfo Info(FText::FromString("Texture generation finished!"));
+    Info.ExpireDuration = 5.0f;
+    Info.bUseSuccessFailIcons = true;
+    Info.Image = FAppStyle::GetBrush("Icons.Success");
+    FSlateNotificationManager::Get().AddNotification(Info);
+}
+
+bool STextureGeneratorWidget::TickCompileNotification(float DeltaTime)
+{
+    if (CompilingTexture.IsValid() && CompilingTexture->IsCompiling())
     {
-        FNotificationInfo Info(FText::FromString("Texture generation finished!"));
-        Info.ExpireDuration = 5.0f;
-        Info.bUseSuccessFailIcons = true;
-        Info.Image = FAppStyle::GetBrush("Icons.Success");
-        FSlateNotificationManager::Get().AddNotification(Info);
-    });
+        if (CompileNotification.IsValid())
+        {
+            CompileNotification->SetText(GetCompileNotificationText());
+        }
+        return true;
+    }
+
+    CompileTickHandle.Reset();
+    FinishCompileNotification();
+    return false;
+}
+
+void STextureGeneratorWidget::FinishCompileNotification()
+{
+    if (CompileTickHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(CompileTickHandle);
+        CompileTickHandle.Reset();
+    }
+
+    if (CompileNotification.IsValid())
+    {
+        CompileNotification->SetText(FText::FromString("Texture generation finished!"));
+        CompileNotification->SetCompletionState(SNotificationItem::CS_Success);
+        CompileNotification->ExpireAndFadeout();
+        CompileNotification.Reset();
+    }
+    CompilingTexture.Reset();
+}
+
+FText STextureGeneratorWidget::GetCompileNotificationText() const
+{
+    // The compiling manager works through all textures of the editor, so report its whole queue
+    const int32 NumRemaining = FMath::Max(1, FTextureCompilingManager::Get().GetNumRemainingTextures());
+    return FText::Format(LOCTEXT("CompressingTexture", "Texture generated, compressing... ({0} {0}|plural(one=texture,other=textures) remaining)"),
+        FText::AsNumber(NumRemaining));
 }
 
 void STextureGeneratorWidget::OnGenerationError(const FString& ErrorMessage)
@@ -0,0 +1,338 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Widgets/STextureMemoryReport.h"
+#include "TextureGeneratorModule.h"
+
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Editor.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Styling/AppStyle.h"
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/Notifications/SNotificationList.h"
+#include "Widgets/Text/STextBlock.h"
+
+#define LOCTEXT_NAMESPACE "STextureMemoryReport"
+
+namespace TextureMemoryReportColumns
+{
+    static const FName Asset(TEXT("Asset"));
+    static const FName Size(TEXT("Size"));
+    static const FName Format(TEXT("Format"));
+    static const FName Mips(TEXT("Mips"));
+    static const FName Streaming(TEXT("Streaming"));
+    static const FName Full(TEXT("Full"));
+    static const FName Resident(TEXT("Resident"));
+    static const FName Disk(TEXT("Disk"));
+    static const FName Ratio(TEXT("Ratio"));
+    static const FName Flags(TEXT("Flags"));
+}
+
+namespace TextureMemoryReportWidget
+{
+    static FText FormatBytes(int64 Bytes)
+    {
+        return FText::AsMemory(Bytes);
+    }
+
+    static FText GetStreamingText(const FTextureMemoryReportEntry& Entry)
+    {
+        if (Entry.bVirtual)
+        {
+            return LOCTEXT("StreamingVirtual", "Virtual");
+        }
+        return Entry.bStreaming ? LOCTEXT("StreamingYes", "Streamed") : LOCTEXT("StreamingNo", "Resident");
+    }
+
+    class STextureMemoryReportRow : public SMultiColumnTableRow<STextureMemoryReport::FEntryPtr>
+    {
+    public:
+        SLATE_BEGIN_ARGS(STextureMemoryReportRow) {}
+        SLATE_END_ARGS()
+
+        void Construct(const FArguments& InArgs, const TSharedRef<STableViewBase>& OwnerTable, STextureMemoryReport::FEntryPtr InEntry)
+        {
+            Entry = InEntry;
+            SMultiColumnTableRow<STextureMemoryReport::FEntryPtr>::Construct(FSuperRowType::FArguments(), OwnerTable);
+        }
+
+        virtual TSharedRef<SWidget> GenerateWidgetForColumn(const FName& ColumnName) override
+        {
+            using namespace TextureMemoryReportColumns;
+
+            FText Text;
+            if (ColumnName == Asset)
+            {
+                Text = FText::FromString(FPaths::GetBaseFilename(Entry->PackageName));
+            }
+            else if (ColumnName == Size)
+            {
+                Text = Entry->NumSlices > 1
+                    ? FText::Format(LOCTEXT("SizeSlices", "{0}x{1}x{2}"), Entry->Width, Entry->Height, Entry->NumSlices)
+                    : FText::Format(LOCTEXT("Size", "{0}x{1}"), Entry->Width, Entry->Height);
+            }
+            else if (ColumnName == Format)
+            {
+                Text = FText::FromString(Entry->Format);
+            }
+            else if (ColumnName == Mips)
+            {
+                Text = FText::AsNumber(Entry->NumMips);
+            }
+            else if (ColumnName == Streaming)
+            {
+                Text = GetStreamingText(*Entry);
+            }
+            else if (ColumnName == Full)
+            {
+                Text = FormatBytes(Entry->FullBytes);
+            }
+            else if (ColumnName == Resident)
+            {
+                Text = FormatBytes(Entry->ResidentBytes);
+            }
+            else if (ColumnName == Disk)
+            {
+                Text = FormatBytes(Entry->DiskBytes);
+            }
+            else if (ColumnName == Ratio)
+            {
+                FNumberFormattingOptions Options;
+                Options.SetMaximumFractionalDigits(1);
+                Text = FText::Format(LOCTEXT("Ratio", "{0}:1"), FText::AsNumber(Entry->CompressionRatio, &Options));
+            }
+            else if (ColumnName == Flags)
+            {
+                return SNew(STextBlock)
+                    .Text(FText::FromString(FTextureMemoryReport::GetFlagNames(Entry->Flags).Replace(TEXT("|"), TEXT(", "))))
+                    .ColorAndOpacity(FAppStyle::Get().GetSlateColor("Colors.Warning"));
+            }
+
+            return SNew(STextBlock).Text(Text);
+        }
+
+    private:
+        STextureMemoryReport::FEntryPtr Entry;
+    };
+}
+
+void STextureMemoryReport::Construct(const FArguments& InArgs)
+{
+    using namespace TextureMemoryReportColumns;
+
+    SortColumn = Full;
+
+    auto MakeColumn = [this](FName Id, FText Label, float FillWidth)
+    {
+        return SHeaderRow::Column(Id)
+            .DefaultLabel(Label)
+            .FillWidth(FillWidth)
+            .SortMode(this, &STextureMemoryReport::GetSortMode, Id)
+            .OnSort(this, &STextureMemoryReport::OnSortModeChanged);
+    };
+
+    ChildSlot
+    [
+        SNew(SVerticalBox)
+        + SVerticalBox::Slot()
+        .AutoHeight()
+        .Padding(4.0f)
+        [
+            SNew(SHorizontalBox)
+            + SHorizontalBox::Slot()
+            .AutoWidth()
+            .Padding(0.0f, 0.0f, 4.0f, 0.0f)
+            [
+                SNew(SButton)
+                .Text(LOCTEXT("RefreshButton", "Refresh"))
+                .ToolTipText(LOCTEXT("RefreshTooltip", "Load the generated textures and measure them again"))
+                .OnClicked(this, &STextureMemoryReport::OnRefreshClicked)
+            ]
+            + SHorizontalBox::Slot()
+            .AutoWidth()
+            .Padding(0.0f, 0.0f, 4.0f, 0.0f)
+            [
+                SNew(SButton)
+                .Text(LOCTEXT("ExportCsvButton", "Export CSV"))
+                .OnClicked(this, &STextureMemoryReport::OnExportClicked, false)
+            ]
+            + SHorizontalBox::Slot()
+            .AutoWidth()
+            .Padding(0.0f, 0.0f, 8.0f, 0.0f)
+            [
+                SNew(SButton)
+                .Text(LOCTEXT("ExportJsonButton", "Export JSON"))
+                .OnClicked(this, &STextureMemoryReport::OnExportClicked, true)
+            ]
+            + SHorizontalBox::Slot()
+            .FillWidth(1.0f)
+            .VAlign(VAlign_Center)
+            [
+                SNew(STextBlock)
+                .Text(this, &STextureMemoryReport::GetSummaryText)
+            ]
+        ]
+        + SVerticalBox::Slot()
+        .FillHeight(1.0f)
+        [
+            SAssignNew(ListView, SListView<FEntryPtr>)
+            .ListItemsSource(&Entries)
+            .OnGenerateRow(this, &STextureMemoryReport::OnGenerateRow)
+            .OnMouseButtonDoubleClick(this, &STextureMemoryReport::OnRowDoubleClicked)
+            .HeaderRow
+            (
+                SNew(SHeaderRow)
+                + MakeColumn(Asset, LOCTEXT("AssetColumn", "Asset"), 3.0f)
+                + MakeColumn(Size, LOCTEXT("SizeColumn", "Size"), 1.2f)
+                + MakeColumn(Format, LOCTEXT("FormatColumn", "Format"), 1.2f)
+                + MakeColumn(Mips, LOCTEXT("MipsColumn", "Mips"), 0.6f)
+                + MakeColumn(Streaming, LOCTEXT("StreamingColumn", "Streaming"), 1.0f)
+                + MakeColumn(Full, LOCTEXT("FullColumn", "All Mips"), 1.0f)
+                + MakeColumn(Resident, LOCTEXT("ResidentColumn", "Resident"), 1.0f)
+                + MakeColumn(Disk, LOCTEXT("DiskColumn", "On Disk"), 1.0f)
+                + MakeColumn(Ratio, LOCTEXT("RatioColumn", "Compression"), 0.9f)
+                + MakeColumn(Flags, LOCTEXT("FlagsColumn", "Flags"), 2.5f)
+            )
+        ]
+    ];
+}
+
+TSharedRef<ITableRow> STextureMemoryReport::OnGenerateRow(FEntryPtr Entry, const TSharedRef<STableViewBase>& OwnerTable)
+{
+    return SNew(TextureMemoryReportWidget::STextureMemoryReportRow, OwnerTable, Entry);
+}
+
+void STextureMemoryReport::OnRowDoubleClicked(FEntryPtr Entry)
+{
+    TArray<FAssetData> Assets;
+    IAssetRegistry::GetChecked().GetAssetsByPackageName(FName(*Entry->PackageName), Assets);
+    if (GEditor && Assets.Num() > 0)
+    {
+        GEditor->SyncBrowserToObjects(Assets);
+    }
+}
+
+void STextureMemoryReport::OnSortModeChanged(EColumnSortPriority::Type Priority, const FName& Column, EColumnSortMode::Type Mode)
+{
+    SortColumn = Column;
+    SortMode = Mode;
+    SortEntries();
+    ListView->RequestListRefresh();
+}
+
+EColumnSortMode::Type STextureMemoryReport::GetSortMode(FName Column) const
+{
+    return Column == SortColumn ? SortMode : EColumnSortMode::None;
+}
+
+void STextureMemoryReport::SortEntries()
+{
+    using namespace TextureMemoryReportColumns;
+
+    // Compares two entries by the sort column, ascending
+    TFunction<bool(const FTextureMemoryReportEntry&, const FTextureMemoryReportEntry&)> Less;
+    if (SortColumn == Asset)
+    {
+        Less = [](const FTextureMemoryReportEntry& A, const FTextureMemoryReportEntry& B) { return A.PackageName < B.PackageName; };
+    }
+    else if (SortColumn == Size)
+    {
+        Less = [](const FTextureMemoryReportEntry& A, const FTextureMemoryReportEntry& B) { return int64(A.Width) * A.Height * A.NumSlices < int64(B.Width) * B.Height * B.NumSlices; };
+    }
+    else if (SortColumn == Format)
+    {
+        Less = [](const FTextureMemoryReportEntry& A, const FTextureMemoryReportEntry& B) { return A.Format < B.Format; };
+    }
+    else if (SortColumn == Mips)
+    {
+        Less = [](const FTextureMemoryReportEntry& A, const FTextureMemoryReportEntry& B) { return A.NumMips < B.NumMips; };
+    }
+    else if (SortColumn == Streaming)
+    {
+        Less = [](const FTextureMemoryReportEntry& A, const FTextureMemoryReportEntry& B) { return A.bStreaming + 2 * A.bVirtual < B.bStreaming + 2 * B.bVirtual; };
+    }
+    else if (SortColumn == Resident)
+    {
+        Less = [](const FTextureMemoryReportEntry& A, const FTextureMemoryReportEntry& B) { return A.ResidentBytes < B.ResidentBytes; };
+    }
+    else if (SortColumn == Disk)
+    {
+        Less = [](const FTextureMemoryReportEntry& A, const FTextureMemoryReportEntry& B) { return A.DiskBytes < B.DiskBytes; };
+    }
+    else if (SortColumn == Ratio)
+    {
+        Less = [](const FTextureMemoryReportEntry& A, const FTextureMemoryReportEntry& B) { return A.CompressionRatio < B.CompressionRatio; };
+    }
+    else if (SortColumn == Flags)
+    {
+        Less = [](const FTextureMemoryReportEntry& A, const FTextureMemoryReportEntry& B) { return static_cast<uint8>(A.Flags) < static_cast<uint8>(B.Flags); };
+    }
+    else
+    {
+        Less = [](const FTextureMemoryReportEntry& A, const FTextureMemoryReportEntry& B) { return A.FullBytes < B.FullBytes; };
+    }
+
+    const bool bDescending = SortMode == EColumnSortMode::Descending;
+    Entries.StableSort([&Less, bDescending](const FEntryPtr& A, const FEntryPtr& B)
+    {
+        return bDescending ? Less(*B, *A) : Less(*A, *B);
+    });
+}
+
+FReply STextureMemoryReport::OnRefreshClicked()
+{
+    Entries.Reset();
+    for (FTextureMemoryReportEntry& Entry : FTextureMemoryReport::Collect())
+    {
+        Entries.Add(MakeShared<FTextureMemoryReportEntry>(MoveTemp(Entry)));
+    }
+
+    SortEntries();
+    ListView->RequestListRefresh();
+    return FReply::Handled();
+}
+
+FReply STextureMemoryReport::OnExportClicked(bool bJson)
+{
+    TArray<FTextureMemoryReportEntry> Report;
+    for (const FEntryPtr& Entry : Entries)
+    {
+        Report.Add(*Entry);
+    }
+
+    const FString Filename = FPaths::ProjectSavedDir() / TEXT("TextureGenerator") / (bJson ? TEXT("MemoryReport.json") : TEXT("MemoryReport.csv"));
+    const bool bSaved = FFileHelper::SaveStringToFile(bJson ? FTextureMemoryReport::ToJson(Report) : FTextureMemoryReport::ToCsv(Report), *Filename);
+
+    FNotificationInfo Info(bSaved
+        ? FText::Format(LOCTEXT("ExportSucceeded", "Memory report written to {0}"), FText::FromString(FPaths::ConvertRelativePathToFull(Filename)))
+        : FText::Format(LOCTEXT("ExportFailed", "Failed to write the memory report to {0}"), FText::FromString(Filename)));
+    Info.ExpireDuration = 5.0f;
+    FSlateNotificationManager::Get().AddNotification(Info);
+
+    return FReply::Handled();
+}
+
+FText STextureMemoryReport::GetSummaryText() const
+{
+    if (Entries.Num() == 0)
+    {
+        return LOCTEXT("EmptySummary", "Press Refresh to measure the generated textures.");
+    }
+
+    int64 FullBytes = 0;
+    int64 ResidentBytes = 0;
+    int32 NumFlagged = 0;
+    for (const FEntryPtr& Entry : Entries)
+    {
+        FullBytes += Entry->FullBytes;
+        ResidentBytes += Entry->ResidentBytes;
+        NumFlagged += Entry->Flags != ETextureMemoryFlags::None ? 1 : 0;
+    }
+
+    return FText::Format(LOCTEXT("Summary", "{0} textures, {1} with all mips, {2} always resident, {3} flagged"),
+        Entries.Num(), TextureMemoryReportWidget::FormatBytes(FullBytes), TextureMemoryReportWidget::FormatBytes(ResidentBytes), NumFlagged);
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,41 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Utils/TextureMemoryReport.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Views/SHeaderRow.h"
+#include "Widgets/Views/SListView.h"
+
+/**
+ * Editor panel listing the memory costs of the generated textures, sortable by every column.
+ * Double-clicking a row shows the texture in the Content Browser.
+ */
+class STextureMemoryReport : public SCompoundWidget
+{
+public:
+    SLATE_BEGIN_ARGS(STextureMemoryReport) {}
+    SLATE_END_ARGS()
+
+    void Construct(const FArguments& InArgs);
+
+    using FEntryPtr = TSharedPtr<FTextureMemoryReportEntry>;
+
+private:
+    TSharedRef<ITableRow> OnGenerateRow(FEntryPtr Entry, const TSharedRef<STableViewBase>& OwnerTable);
+    void OnRowDoubleClicked(FEntryPtr Entry);
+    void OnSortModeChanged(EColumnSortPriority::Type Priority, const FName& Column, EColumnSortMode::Type Mode);
+    EColumnSortMode::Type GetSortMode(FName Column) const;
+    void SortEntries();
+
+    FReply OnRefreshClicked();
+    FReply OnExportClicked(bool bJson);
+    FText GetSummaryText() const;
+
+    TArray<FEntryPtr> Entries;
+    TSharedPtr<SListView<FEntryPtr>> ListView;
+
+    FName SortColumn;
+    EColumnSortMode::Type SortMode = EColumnSortMode::Descending;
+};
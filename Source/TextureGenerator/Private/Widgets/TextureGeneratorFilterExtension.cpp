@@ -0,0 +1,50 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#include "Widgets/TextureGeneratorFilterExtension.h"
+#include "Utils/TextureUtils.h"
+
+#include "ContentBrowserItem.h"
+#include "FrontendFilterBase.h"
+
+#define LOCTEXT_NAMESPACE "TextureGeneratorFilterExtension"
+
+namespace TextureGeneratorFilterExtension
+{
+    // Passes assets with a prompt tag, which every generated asset has
+    class FFrontendFilter_GeneratedAssets : public FFrontendFilter
+    {
+    public:
+        explicit FFrontendFilter_GeneratedAssets(TSharedPtr<FFrontendFilterCategory> InCategory)
+            : FFrontendFilter(InCategory)
+        {
+        }
+
+        virtual FString GetName() const override
+        {
+            return TEXT("TextureGeneratorGeneratedAssets");
+        }
+
+        virtual FText GetDisplayText() const override
+        {
+            return LOCTEXT("GeneratedAssetsFilter", "Generated Textures");
+        }
+
+        virtual FText GetToolTipText() const override
+        {
+            return LOCTEXT("GeneratedAssetsFilterTooltip", "Show only textures created by the Stability AI Texture Generator.");
+        }
+
+        virtual bool PassesFilter(FAssetFilterType InItem) const override
+        {
+            FAssetData AssetData;
+            return InItem.Legacy_TryGetAssetData(AssetData) && AssetData.FindTag(FName(TextureGeneratorMetaData::Prompt));
+        }
+    };
+}
+
+void UTextureGeneratorFilterExtension::AddFrontEndFilterExtensions(TSharedPtr<FFrontendFilterCategory> DefaultCategory, TArray<TSharedRef<FFrontendFilter>>& InOutFilterList) const
+{
+    InOutFilterList.Add(MakeShared<TextureGeneratorFilterExtension::FFrontendFilter_GeneratedAssets>(DefaultCategory));
+}
+
+#undef LOCTEXT_NAMESPACE
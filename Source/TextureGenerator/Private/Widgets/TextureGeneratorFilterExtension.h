@@ -0,0 +1,21 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ContentBrowserFrontEndFilterExtension.h"
+#include "TextureGeneratorFilterExtension.generated.h"
+
+/**
+ * Adds a Content Browser filter showing only generated assets.
+ * The filter reads the provenance tags from the asset registry, no package gets loaded.
+ */
+UCLASS()
+class UTextureGeneratorFilterExtension : public UContentBrowserFrontEndFilterExtension
+{
+    GENERATED_BODY()
+
+public:
+    // UContentBrowserFrontEndFilterExtension interface
+    virtual void AddFrontEndFilterExtensions(TSharedPtr<FFrontendFilterCategory> DefaultCategory, TArray<TSharedRef<FFrontendFilter>>& InOutFilterList) const override;
+};
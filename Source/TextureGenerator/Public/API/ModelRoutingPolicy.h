@@ -0,0 +1,86 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "API/StabilityAPIClient.h"
+#include "ModelRoutingPolicy.generated.h"
+
+/**
+ * Snapshot of the observed latency and reliability of a model endpoint
+ */
+USTRUCT(BlueprintType)
+struct TEXTUREGENERATOR_API FModelEndpointStats
+{
+    GENERATED_BODY()
+
+    /* Number of latency samples currently taken into account. */
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generator")
+    int32 NumSamples = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generator")
+    float AverageLatencySeconds = 0.0f;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generator")
+    float P90LatencySeconds = 0.0f;
+
+    /* Share of recent requests which failed, between 0 and 1. */
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generator")
+    float ErrorRate = 0.0f;
+};
+
+/**
+ * Keeps live latency and error statistics per model endpoint and picks the model for jobs
+ * which allow routing, downgrading to faster models when the preferred one cannot meet the target.
+ */
+class TEXTUREGENERATOR_API FModelRoutingPolicy
+{
+public:
+    /** Records a successful request and how long it took. */
+    void RecordSuccess(EImageGenerationModel Model, double LatencySeconds);
+
+    /** Records a failed request. */
+    void RecordFailure(EImageGenerationModel Model);
+
+    /** Records a latency sample without counting the request as succeeded or failed, e.g. a lower bound of a cancelled request. */
+    void RecordLatency(EImageGenerationModel Model, double LatencySeconds);
+
+    /**
+     * Picks the model for a job.
+     * @param PreferredModel Model requested by the job, used whenever it meets the targets
+     * @param LatencyBudgetSeconds Latency each request should stay under, 0 or less disables latency routing
+     * @param MaxErrorRate Share of failing requests above which a model is avoided
+     * @return The preferred model, or the first model along its downgrade chain expected to meet the targets
+     */
+    EImageGenerationModel SelectModel(EImageGenerationModel PreferredModel, double LatencyBudgetSeconds, double MaxErrorRate) const;
+
+    /** Returns the latency below which the given share of recent requests finished, 0 without samples. */
+    double GetLatencyPercentile(EImageGenerationModel Model, double Percentile) const;
+
+    FModelEndpointStats GetStats(EImageGenerationModel Model) const;
+
+    /** Returns the next faster model, or the same model when there is nothing faster. */
+    static EImageGenerationModel GetFasterModel(EImageGenerationModel Model);
+
+    /** Returns the fastest model along the downgrade chain of the given one. */
+    static EImageGenerationModel GetFastestModel(EImageGenerationModel Model);
+
+private:
+    struct FEndpointHistory
+    {
+        // Ring buffer of the most recent latencies
+        TArray<double> Latencies;
+        int32 NextLatencyIndex = 0;
+
+        // Exponentially weighted share of failed requests
+        double ErrorRate = 0.0;
+
+        // Time of the last recorded request, old statistics are not trusted for routing
+        double LastSampleTime = 0.0;
+    };
+
+    bool IsExpectedToMeetTargets(EImageGenerationModel Model, double LatencyBudgetSeconds, double MaxErrorRate) const;
+    const FEndpointHistory* FindFreshHistory(EImageGenerationModel Model) const;
+
+    TMap<EImageGenerationModel, FEndpointHistory> Histories;
+};
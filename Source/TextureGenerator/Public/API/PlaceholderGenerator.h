@@ -0,0 +1,40 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageCore.h"
+
+/**
+ * Local backend synthesizing placeholder textures for blockouts, without network requests or credits.
+ * The pattern (fractal noise, Worley cells, bricks or tiles) and the colors are picked from keywords of the prompt,
+ * e.g. "mossy brick wall" gives bricks with a green accent. Every pattern tiles seamlessly,
+ * and the same prompt and seed always give the same image.
+ */
+class TEXTUREGENERATOR_API FPlaceholderGenerator
+{
+public:
+    /** Size of the generated images, matching the usual output of the API */
+    static constexpr int32 DefaultSize = 1024;
+
+    /**
+     * Synthesizes a placeholder as a BGRA8 sRGB image, rows are generated in parallel.
+     * @param Prompt Prompt to pick the pattern and colors from
+     * @param Seed Varies the pattern, 0 derives it from the prompt
+     * @param Size Width and height of the image
+     * @param OutImage The generated image
+     */
+    static void Generate(const FString& Prompt, int32 Seed, int32 Size, FImage& OutImage);
+
+    /** Synthesizes a placeholder of the default size and encodes it as PNG, like a result of the API. Safe to call from any thread. */
+    static bool GenerateImageData(const FString& Prompt, int32 Seed, TArray<uint8>& OutImageData);
+
+    /**
+     * Image-to-image counterpart: synthesizes a placeholder the size of the reference and blends it over the reference.
+     * Tiles of a tiled texture thereby keep the layout of their crop of the global pass. Safe to call from any thread.
+     * @param ReferenceImageData Encoded reference image
+     * @param Strength How far the result moves away from the reference, 0 keeps the reference and 1 ignores it
+     * @return False if the reference could not be decoded or the result not encoded
+     */
+    static bool GenerateImageData(const FString& Prompt, int32 Seed, const TArray<uint8>& ReferenceImageData, float Strength, TArray<uint8>& OutImageData);
+};
@@ -0,0 +1,52 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Image file on disk used as a generation reference without importing it. The file is memory mapped,
+ * its format is checked from the header and its bytes are sent as they are, so no decode or encode takes place.
+ * The mapping stays open while any request holds the file.
+ */
+class TEXTUREGENERATOR_API FReferenceImageFile
+{
+public:
+    ~FReferenceImageFile();
+
+    /**
+     * Maps an image file accepted by the API as it is: PNG, JPEG or WebP.
+     * @param Filename Absolute path, or relative to the project directory
+     * @param OutError Reason the file cannot be used
+     * @return The mapped file, or nullptr when it is missing, unreadable or in another format
+     */
+    static TSharedPtr<const FReferenceImageFile> Open(const FString& Filename, FString& OutError);
+
+    /**
+     * Detects an accepted image format from the first bytes of a file.
+     * @return MIME type of the format, or nullptr when it is not accepted
+     */
+    static const TCHAR* DetectMimeType(TArrayView<const uint8> Header);
+
+    /** Resolves a path relative to the project directory. */
+    static FString GetFullPath(const FString& Filename);
+
+    /** The mapped bytes of the file. */
+    TArrayView<const uint8> GetData() const;
+
+    /** MIME type detected from the header, e.g. image/jpeg */
+    const TCHAR* GetMimeType() const { return MimeType; }
+
+    /** File name extension matching the MIME type, without the dot */
+    const TCHAR* GetExtension() const;
+
+private:
+    FReferenceImageFile() = default;
+
+    TUniquePtr<IMappedFileHandle> Handle;
+    TUniquePtr<IMappedFileRegion> Region;
+    const TCHAR* MimeType = nullptr;
+};
@@ -9,16 +9,21 @@
 #include "Interfaces/IHttpResponse.h"
 #include "Dom/JsonObject.h"
 #include "Serialization/JsonSerializer.h"
+#include "StabilityAPIClient.generated.h"
+
+class FReferenceImageFile;
 
 UENUM(BlueprintType)
 enum class EImageGenerationModel : uint8
 {
     StableImageUltra UMETA(DisplayName = "Stable Image Ultra"),
     StableImageCore UMETA(DisplayName = "Stable Image Core"),
-    StableDiffusion UMETA(DisplayName = "Stable Diffusion 3.5")
+    StableDiffusion UMETA(DisplayName = "Stable Diffusion 3.5"),
+    /* Synthesized locally in milliseconds, for blockouts. No request is sent to the API. */
+    Placeholder UMETA(DisplayName = "Local Placeholder")
 };
 
-UENUM()
+UENUM(BlueprintType)
 enum class EStylePreset : uint8
 {
     None,
@@ -45,6 +50,41 @@ DECLARE_DELEGATE_OneParam(FOnImageGenerated, const TArray<uint8>&);
 DECLARE_DELEGATE_OneParam(FOnError, const FString&);
 DECLARE_DELEGATE_OneParam(FOnProgress, float);
 
+// Parameters of a single generation request
+struct TEXTUREGENERATOR_API FStabilityGenerationParams
+{
+    EImageGenerationModel Model = EImageGenerationModel::StableImageCore;
+    FString Prompt;
+    FString NegativePrompt;
+    FString StylePreset;            // if empty, no style will be applied
+    TArray<uint8> ReferenceImage;   // PNG encoded, empty for text-to-image
+    TSharedPtr<const FReferenceImageFile> ReferenceImageFile;   // mapped image file sent as it is, instead of ReferenceImage
+    int32 Seed = -1;                // -1 for random, >0 for specific seed
+    float Strength = 0.0f;          // 0-1, for img2img influence
+    TArray<uint8> MaskImage;        // PNG encoded, white marks the region of the reference image to regenerate, empty unless inpainting
+
+    // Whether the request may share a single HTTP request with identical requests already in flight
+    bool bAllowCoalescing = true;
+
+    // Returns the key identifying byte-identical requests, empty when the request must not be coalesced
+    FString GetCoalescingKey() const;
+
+    // Bytes of the reference image, from the mapped file when set, empty for text-to-image
+    TArrayView<const uint8> GetReferenceImage() const;
+};
+
+// FPlatformTime::Seconds() of the phases of an HTTP request and its sizes.
+// Phases are only as precise as the progress reports of the HTTP module, which arrive once per tick.
+struct TEXTUREGENERATOR_API FStabilityRequestTimings
+{
+    double SendTime = 0.0;          // handed to the HTTP module
+    double UploadedTime = 0.0;      // last byte of the body sent
+    double FirstByteTime = 0.0;     // first byte of the response received
+    double CompletedTime = 0.0;
+    int64 BytesSent = 0;
+    int64 BytesReceived = 0;
+};
+
 class TEXTUREGENERATOR_API FStabilityAPIClient
 {
 public:
@@ -65,37 +105,77 @@ public:
         const FString& InStylePreset
     );
 
+    // Generate an image using the Stability AI API.
+    // Identical requests already in flight with an explicit seed are joined instead of being sent again.
+    void GenerateImage(const FStabilityGenerationParams& Params);
+
     // Cancel the current generation request
     void CancelRequest();
 
+    // Number of HTTP requests currently sent by all clients, joined requests are counted once
+    static int32 GetNumActiveHttpRequests();
+
+    // Returns the style preset identifier expected by the API, empty for no style
+    static FString GetStylePresetString(EStylePreset Style);
+
+    // Builds the multipart/form-data body of a generation request
+    static TArray<uint8> BuildMultipartFormData(const FStabilityGenerationParams& Params, const FString& Boundary);
+
+    // Timings of the last finished request, joined requests report the timings of the request they joined
+    const FStabilityRequestTimings& GetRequestTimings() const { return RequestTimings; }
+
+    // Identifies the HTTP request behind the last response, shared by every client which joined it
+    const FGuid& GetResponseId() const { return ResponseId; }
+
+    // Seed the service reported for the last response, 0 when it sent none
+    int64 GetResponseSeed() const { return ResponseSeed; }
+
     // Delegates
     FOnImageGenerated OnImageGenerated;
     FOnError OnError;
     FOnProgress OnProgress;
 
 private:
+    // HTTP request shared by every client waiting for the same result
+    struct FSharedRequest
+    {
+        FHttpRequestPtr HttpRequest;
+        FGuid RequestId;
+        FString CoalescingKey;
+        TArray<FStabilityAPIClient*> Subscribers;
+        FStabilityRequestTimings Timings;
+        bool bCompleted = false;
+    };
+
+    // Timestamps the end of the upload and the start of the download of a shared request
+    static void OnSharedRequestProgress(TWeakPtr<FSharedRequest> WeakSharedRequest, uint64 BytesSent, uint64 BytesReceived);
+
+    // Delivers the response of a shared request to all of its subscribers
+    static void OnSharedRequestComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, TWeakPtr<FSharedRequest> WeakSharedRequest);
+
     // Handle the HTTP response
-    void OnResponseReceived(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
+    void OnResponseReceived(FHttpResponsePtr Response, bool bWasSuccessful);
 
     // Process Stability AI response
     void ProcessStabilityResponse(const FHttpResponsePtr& Response);
 
-    FString GetModelEndpoint(EImageGenerationModel Model) const;
-    TArray<uint8> BuildMultipartFormData(const FString& Boundary) const;
+    static FString GetModelEndpoint(EImageGenerationModel Model);
+    static FString GetInpaintEndpoint();
 
-    // Current HTTP request
-    TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> CurrentRequest;
+    // Current HTTP request, possibly shared with other clients
+    TSharedPtr<FSharedRequest> CurrentRequest;
 
     // API configuration
     FString APIKey;
-    EImageGenerationModel CurrentModel;
-    UTexture2D* ReferenceTexture;
     
     // Generation parameters
-    FString CurrentPrompt;
-    FString CurrentNegativePrompt;
-    TArray<uint8> CurrentReferenceImage;
-    int32 CurrentSeed;      // -1 for random, >0 for specific seed
-    float CurrentStrength;  // 0-1, for img2img influence
-    FString CurrentStylePreset;  // if empty, no style will be applied
+    FStabilityGenerationParams CurrentParams;
+
+    FStabilityRequestTimings RequestTimings;
+    FGuid ResponseId;
+    int64 ResponseSeed = 0;
+
+    // Requests in flight which identical requests can join, by coalescing key
+    static TMap<FString, TSharedPtr<FSharedRequest>> CoalescableRequests;
+    static int32 NumActiveHttpRequests;
 };
@@ -0,0 +1,27 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TextureGeneratorBenchmarkCommandlet.generated.h"
+
+/**
+ * Measures the CPU-side hot paths of the plugin in isolation and writes the results as JSON,
+ * so runs can be compared between commits. Nothing is sent to the API.
+ *
+ * UnrealEditor-Cmd.exe Project.uproject -run=TextureGeneratorBenchmark
+ *     [-Output=Saved/TextureGenerator/Benchmark.json] [-Sizes=512,1024,2048,4096,8192]
+ *     [-Iterations=5] [-Warmup=1] [-Kernels=MultipartFormData,PngEncode,...] [-Label=<commit>]
+ */
+UCLASS()
+class UTextureGeneratorBenchmarkCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UTextureGeneratorBenchmarkCommandlet();
+
+    // UCommandlet interface
+    virtual int32 Main(const FString& Params) override;
+};
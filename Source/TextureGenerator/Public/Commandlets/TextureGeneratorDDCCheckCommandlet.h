@@ -0,0 +1,29 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TextureGeneratorDDCCheckCommandlet.generated.h"
+
+/**
+ * Verifies that the platform data of generated textures is shared through the derived data cache.
+ * Every generated texture is cached for the DDC Target Platforms, and the cache layers answering each query are reported:
+ * a hit in a shared layer, a hit in a local layer only, or a miss which built the data and wrote it to every writable layer.
+ * Run it once on the machine which generated the textures, then with a cold local cache, e.g. on a second machine,
+ * against the same shared cache. With -RequireSharedHits the commandlet fails unless every query hit a shared layer.
+ *
+ * UnrealEditor-Cmd.exe Project.uproject -run=TextureGeneratorDDCCheck
+ *     [-Path=/Game/StabilityAI] [-RequireSharedHits] [-SharedDataCachePath=D:/SharedDDC]
+ */
+UCLASS()
+class UTextureGeneratorDDCCheckCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UTextureGeneratorDDCCheckCommandlet();
+
+    // UCommandlet interface
+    virtual int32 Main(const FString& Params) override;
+};
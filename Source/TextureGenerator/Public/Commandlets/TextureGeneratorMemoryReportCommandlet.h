@@ -0,0 +1,26 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TextureGeneratorMemoryReportCommandlet.generated.h"
+
+/**
+ * Writes the memory report of the textures under the default asset path as CSV or JSON, picked by the extension
+ * of the output file. With -FailOnFlags the commandlet fails when any texture is flagged, for use as a build check.
+ *
+ * UnrealEditor-Cmd.exe Project.uproject -run=TextureGeneratorMemoryReport
+ *     [-Output=Saved/TextureGenerator/MemoryReport.csv] [-OversizeThreshold=2048] [-FailOnFlags]
+ */
+UCLASS()
+class UTextureGeneratorMemoryReportCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UTextureGeneratorMemoryReportCommandlet();
+
+    // UCommandlet interface
+    virtual int32 Main(const FString& Params) override;
+};
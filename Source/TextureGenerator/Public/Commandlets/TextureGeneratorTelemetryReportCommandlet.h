@@ -0,0 +1,26 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TextureGeneratorTelemetryReportCommandlet.generated.h"
+
+/**
+ * Prints throughput and p50/p95/p99 latency per model from the recorded generation telemetry,
+ * and per model and day with -PerDay. With -Output the aggregates and the mean duration of every step are written as CSV.
+ *
+ * UnrealEditor-Cmd.exe Project.uproject -run=TextureGeneratorTelemetryReport
+ *     [-Days=30] [-PerDay] [-Output=Saved/TextureGenerator/TelemetryReport.csv]
+ */
+UCLASS()
+class UTextureGeneratorTelemetryReportCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UTextureGeneratorTelemetryReportCommandlet();
+
+    // UCommandlet interface
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,75 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "Subsystems/TextureGenerationTypes.h"
+#include "AsyncGenerateTexture.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTextureGenerationBatchFinished, const TArray<FTextureGenerationJobInfo>&, JobInfos);
+
+/**
+ * Latent Blueprint node generating a single texture through the texture generator subsystem
+ */
+UCLASS()
+class TEXTUREGENERATOR_API UAsyncGenerateTexture : public UBlueprintAsyncActionBase
+{
+    GENERATED_BODY()
+
+public:
+    /** Fires when the texture has been generated and imported. */
+    UPROPERTY(BlueprintAssignable)
+    FOnTextureGenerationJobFinished OnCompleted;
+
+    /** Fires when the job failed or got cancelled. */
+    UPROPERTY(BlueprintAssignable)
+    FOnTextureGenerationJobFinished OnFailed;
+
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator", Meta = (BlueprintInternalUseOnly = "true"))
+    static UAsyncGenerateTexture* GenerateTextureAsync(const FTextureGenerationRequest& Request);
+
+    // UBlueprintAsyncActionBase interface
+    virtual void Activate() override;
+
+private:
+    void HandleJobFinished(const FTextureGenerationJobInfo& JobInfo);
+
+    FTextureGenerationRequest Request;
+    FGuid JobId;
+    FDelegateHandle JobFinishedHandle;
+};
+
+/**
+ * Latent Blueprint node generating a batch of textures, with a notification per finished job
+ */
+UCLASS()
+class TEXTUREGENERATOR_API UAsyncGenerateTextureBatch : public UBlueprintAsyncActionBase
+{
+    GENERATED_BODY()
+
+public:
+    /** Fires once for every job of the batch, whatever its outcome. */
+    UPROPERTY(BlueprintAssignable)
+    FOnTextureGenerationJobFinished OnJobFinished;
+
+    /** Fires when every job of the batch has finished. */
+    UPROPERTY(BlueprintAssignable)
+    FOnTextureGenerationBatchFinished OnCompleted;
+
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator", Meta = (BlueprintInternalUseOnly = "true"))
+    static UAsyncGenerateTextureBatch* GenerateTextureBatchAsync(const TArray<FTextureGenerationRequest>& Requests);
+
+    // UBlueprintAsyncActionBase interface
+    virtual void Activate() override;
+
+private:
+    void HandleJobFinished(const FTextureGenerationJobInfo& JobInfo);
+    void Finish();
+
+    TArray<FTextureGenerationRequest> Requests;
+    TMap<FGuid, int32> JobIndices;
+    TArray<FTextureGenerationJobInfo> Results;
+    int32 NumFinishedJobs = 0;
+    FDelegateHandle JobFinishedHandle;
+};
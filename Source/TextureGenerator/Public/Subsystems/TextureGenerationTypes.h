@@ -0,0 +1,316 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "API/StabilityAPIClient.h"
+#include "TextureGenerationTypes.generated.h"
+
+class UTexture2D;
+class UTexture2DArray;
+class UMaterial;
+class UMaterialInstanceConstant;
+
+UENUM(BlueprintType)
+enum class ETextureGenerationJobState : uint8
+{
+    Queued,
+    InFlight,
+    Importing,
+    Completed,
+    Failed,
+    Cancelled
+};
+
+/**
+ * Input parameters of a single texture generation job
+ */
+USTRUCT(BlueprintType)
+struct TEXTUREGENERATOR_API FTextureGenerationRequest
+{
+    GENERATED_BODY()
+
+    /* Description of the texture to generate. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    FString Prompt;
+
+    /* What to avoid in the generated image. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    FString NegativePrompt;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    EImageGenerationModel Model = EImageGenerationModel::StableImageCore;
+
+    /* Seed controlling the randomness of the generation. 0 picks a random seed. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation", Meta = (ClampMin = 0))
+    int32 Seed = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    EStylePreset StylePreset = EStylePreset::None;
+
+    /* Optional reference texture, turns the job into an image-to-image generation. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    TObjectPtr<UTexture2D> ReferenceTexture = nullptr;
+
+    /*
+     * Optional image file used as the reference when no reference texture is set, absolute or relative to the project directory.
+     * PNG, JPEG and WebP files are uploaded as they are without importing them, other formats are converted to PNG first.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    FString ReferenceImageFile;
+
+    /* How much the reference texture influences the output. Only used with a reference texture. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation", Meta = (ClampMin = 0, ClampMax = 1))
+    float Strength = 0.5f;
+
+    /*
+     * Optional mask over the reference texture, white marking the region to regenerate. Turns the job into an inpainting edit:
+     * only the masked region with some context around it is sent, and the result is blended back into the reference.
+     * Without an asset name, the reference texture itself is updated.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    TObjectPtr<UTexture2D> MaskTexture = nullptr;
+
+    /* Pixels of context around the masked region sent along with it. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation", AdvancedDisplay, Meta = (ClampMin = 0))
+    int32 MaskMargin = 32;
+
+    /* Width in pixels of the soft edge blending the regenerated region into the reference. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation", AdvancedDisplay, Meta = (ClampMin = 0, ClampMax = 256))
+    int32 MaskFeather = 8;
+
+    /* Base name of the created assets. A random name is used when empty. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    FString AssetName;
+
+    /* Whether to create a simple material using the generated texture. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    bool bCreateMaterial = true;
+
+    /* Derive an occlusion/roughness/metallic mask map from the generated texture, packed into one texture. With a material, a material instance of a shared packed material is created instead. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    bool bCreateMaskMap = false;
+
+    /* Metallic value written to the blue channel of the mask map. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation", Meta = (ClampMin = 0, ClampMax = 1, EditCondition = "bCreateMaskMap"))
+    float Metallic = 0.0f;
+
+    /* Allow switching to a faster model when the requested one cannot meet the routing targets set in the plugin settings. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    bool bAllowModelRouting = false;
+
+    /* Manifest the request was built from. Stored with the generated assets, so manifest builds can remove entries which were dropped. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation", AdvancedDisplay)
+    FString ManifestName;
+
+    /**
+     * Returns a hash of every input affecting the generated image: prompts, model, seed, style, strength,
+     * the source id of the reference texture and the mask settings of edits. Asset naming and import options are not part of it.
+     */
+    FString GetInputFingerprint() const;
+
+    /** Whether the request edits the masked region of its reference texture. */
+    bool IsInpainting() const { return ReferenceTexture != nullptr && MaskTexture != nullptr; }
+
+    /** Whether the request is an image-to-image generation, from a reference texture or file. */
+    bool HasReference() const { return ReferenceTexture != nullptr || !ReferenceImageFile.IsEmpty(); }
+};
+
+/**
+ * Durations in seconds and sizes of the steps of a job, recorded as generation telemetry once the job is done.
+ * Steps the job did not go through are negative.
+ */
+struct FTextureGenerationJobTimings
+{
+    double QueueSeconds = -1.0;
+    double EncodeSeconds = -1.0;
+    double UploadSeconds = -1.0;
+    double ServerSeconds = -1.0;
+    double DownloadSeconds = -1.0;
+    double DecodeSeconds = -1.0;
+    double ImportSeconds = -1.0;
+    double SaveSeconds = -1.0;
+
+    int64 BytesSent = 0;
+    int64 BytesReceived = 0;
+
+    // Size of the received image, 0 until it was decoded
+    int32 Width = 0;
+    int32 Height = 0;
+
+    // Whether a duplicate request was sent for the job
+    bool bHedged = false;
+
+    // FPlatformTime::Seconds() when the job was submitted and when it left the queue
+    double SubmitTime = 0.0;
+    double StartTime = 0.0;
+};
+
+/**
+ * Current state and results of a texture generation job
+ */
+USTRUCT(BlueprintType)
+struct TEXTUREGENERATOR_API FTextureGenerationJobInfo
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generation")
+    FGuid JobId;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generation")
+    FTextureGenerationRequest Request;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generation")
+    ETextureGenerationJobState State = ETextureGenerationJobState::Queued;
+
+    /* Model the job was sent to, which differs from the requested one when routing downgraded it. */
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generation")
+    EImageGenerationModel Model = EImageGenerationModel::StableImageCore;
+
+    /* Error description, only set for failed jobs. */
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generation")
+    FString ErrorMessage;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generation")
+    TObjectPtr<UTexture2D> Texture = nullptr;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generation")
+    TObjectPtr<UMaterial> Material = nullptr;
+
+    /* Occlusion/roughness/metallic mask map derived from the result, only set when the request creates one. */
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generation")
+    TObjectPtr<UTexture2D> MaskMap = nullptr;
+
+    /* Texture array the result was packed into, only set for jobs of a variant set. */
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generation")
+    TObjectPtr<UTexture2DArray> TextureArray = nullptr;
+
+    /* Slice of the texture array holding the result, INDEX_NONE outside of variant sets. */
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generation")
+    int32 VariantIndex = INDEX_NONE;
+
+    /* Instance of the variant set material selecting the slice with its VariantIndex parameter, or of the packed material for mask maps. */
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generation")
+    TObjectPtr<UMaterialInstanceConstant> MaterialInstance = nullptr;
+
+    // FPlatformTime::Seconds() when the request was sent
+    double DispatchTime = 0.0;
+
+    // Durations of the steps the job went through so far
+    FTextureGenerationJobTimings Timings;
+
+    // Encoded reference image sent instead of the request's reference texture, set for tiles of a tiled texture
+    TArray<uint8> ReferenceImageData;
+
+    // Response the result came from, shared by jobs coalesced into one request. Invalid for locally synthesized results.
+    FGuid ResultId;
+
+    // Seed the service reported for the result, 0 when unknown
+    int64 ResultSeed = 0;
+
+    // Whether the job is in the journal, internal steps of tiled textures are not resumed after a restart
+    bool bJournaled = true;
+
+    bool IsFinished() const
+    {
+        return State == ETextureGenerationJobState::Completed
+            || State == ETextureGenerationJobState::Failed
+            || State == ETextureGenerationJobState::Cancelled;
+    }
+};
+
+/**
+ * Version controlled list of textures to generate, built incrementally by UTextureGeneratorSubsystem::BuildManifest
+ */
+USTRUCT(BlueprintType)
+struct TEXTUREGENERATOR_API FTextureGenerationManifest
+{
+    GENERATED_BODY()
+
+    /* Textures to generate, each entry needs a unique asset name. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    TArray<FTextureGenerationRequest> Entries;
+};
+
+UENUM(BlueprintType)
+enum class ETextureManifestAction : uint8
+{
+    /* The asset was generated from the current inputs. */
+    UpToDate,
+    /* The asset does not exist yet. */
+    Generate,
+    /* The inputs changed since the asset was generated. */
+    Regenerate,
+    /* The texture is up to date, but assets created from it are missing. */
+    Reimport,
+    /* The asset was generated from an entry which is no longer in the manifest. */
+    Delete
+};
+
+/**
+ * Outcome of a manifest build for a single asset
+ */
+USTRUCT(BlueprintType)
+struct TEXTUREGENERATOR_API FTextureManifestEntryStatus
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generation")
+    FString AssetName;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generation")
+    ETextureManifestAction Action = ETextureManifestAction::UpToDate;
+
+    /* Job submitted for the entry, only valid for generated and regenerated entries. */
+    UPROPERTY(BlueprintReadOnly, Category = "Texture Generation")
+    FGuid JobId;
+};
+
+/**
+ * Search over the provenance tags of generated assets, answered from the asset registry without loading packages.
+ * Empty fields match every asset.
+ */
+USTRUCT(BlueprintType)
+struct TEXTUREGENERATOR_API FGeneratedAssetQuery
+{
+    GENERATED_BODY()
+
+    /* Words which all have to appear in the prompt, case insensitive. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    FString PromptContains;
+
+    /* Only match assets generated by the model below. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    bool bFilterByModel = false;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation", meta = (EditCondition = "bFilterByModel"))
+    EImageGenerationModel Model = EImageGenerationModel::StableImageCore;
+
+    /* Seed the texture was generated with, 0 matches any seed. Seeds picked by the service may exceed the range of request seeds. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    int64 Seed = 0;
+
+    /* Input fingerprint of the request. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    FString Fingerprint;
+
+    /* Only match assets generated at or after this UTC time. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    FDateTime GeneratedAfter;
+
+    /* Only match assets generated before this UTC time, unset matches up to now. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Texture Generation")
+    FDateTime GeneratedBefore;
+};
+
+UENUM(BlueprintType)
+enum class EPromptMatrixSampling : uint8
+{
+    /* Uniformly random combinations, none of them twice. */
+    Random,
+    /* Combinations spreading the options of every axis evenly over the samples. */
+    LatinHypercube
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTextureGenerationJobFinished, const FTextureGenerationJobInfo&, JobInfo);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnTextureGenerationJobFinishedNative, const FTextureGenerationJobInfo&);
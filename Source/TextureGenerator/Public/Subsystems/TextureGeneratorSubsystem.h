@@ -0,0 +1,422 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EditorSubsystem.h"
+#include "AssetRegistry/AssetData.h"
+#include "Containers/Queue.h"
+#include "Containers/Ticker.h"
+#include "API/ModelRoutingPolicy.h"
+#include "ImageCore.h"
+#include "Subsystems/TextureGenerationTypes.h"
+#include "TextureGeneratorSubsystem.generated.h"
+
+class FStabilityAPIClient;
+class FTextureGenerationJournal;
+class FGenerationResultPipeline;
+class FTextureDDCPublisher;
+class FFolderIngestion;
+class FGenerationTelemetry;
+class FPromptMatrix;
+
+/**
+ * Editor-wide entry point for texture generation.
+ * Owns the job queue, keeps up to MaxConcurrentRequests jobs in flight and imports finished results as assets.
+ * Jobs are journaled on disk, so a batch interrupted by closing or crashing the editor resumes on the next start.
+ * Received images wait for import in a memory-bounded pipeline, which holds back new requests once it is full.
+ * All functions are available from Blueprints and Python (unreal.get_editor_subsystem(unreal.TextureGeneratorSubsystem)).
+ */
+UCLASS()
+class TEXTUREGENERATOR_API UTextureGeneratorSubsystem : public UEditorSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // UEditorSubsystem interface
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+    /** Queues a single generation job and returns its identifier. */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    FGuid GenerateTexture(const FTextureGenerationRequest& Request);
+
+    /** Queues a generation job for every request, returned identifiers keep the order of the requests. */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    TArray<FGuid> GenerateTextureBatch(const TArray<FTextureGenerationRequest>& Requests);
+
+    /**
+     * Generates variants of one request with consecutive seeds and packs them into a single texture array,
+     * with a material instance picking the slice by parameter or per-instance custom data.
+     * Every variant runs as its own job, all of them finish once the texture array was created.
+     * @param Request Request shared by the variants, a seed of 0 picks a random first seed
+     * @param NumVariants Number of variants, which becomes the number of slices
+     * @return Job identifiers of the variants in slice order
+     */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    TArray<FGuid> GenerateVariantSet(const FTextureGenerationRequest& Request, int32 NumVariants = 4);
+
+    /**
+     * Generates a texture with more detail than a single generation provides. A global pass at the model's resolution
+     * is scaled up to the output size and split into overlapping tiles, which are refined concurrently with image-to-image
+     * generation conditioned on the global pass and blended back together across their overlaps.
+     * Tiled textures are not resumed after an editor restart.
+     * @param Request Request of the global pass, its prompts are reused for every tile. Masks are ignored.
+     * @param OutputSize Size of the longer side of the result
+     * @param TileSize Size of the tiles sent to the API
+     * @param Overlap Minimum overlap between neighbouring tiles, at most half the tile size
+     * @param TileStrength Image-to-image strength of the tiles, lower values stay closer to the global pass
+     * @return Identifier of the job, which finishes once the tiled texture was created
+     */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    FGuid GenerateTiledTexture(const FTextureGenerationRequest& Request, int32 OutputSize = 4096, int32 TileSize = 1024, int32 Overlap = 128, float TileStrength = 0.35f);
+
+    /**
+     * Generates a quick draft of a request with the fastest model along its downgrade chain, e.g. Core instead of Ultra.
+     * Drafts are named <AssetName>_Draft, come without material and always have a fixed seed, so RefineDraft can reproduce them.
+     * @param Request Request to draft, its model is the one RefineDraft uses. Masked edits cannot be drafted.
+     * @return Identifier of the draft job, invalid if the request cannot be drafted
+     */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    FGuid GenerateDraft(const FTextureGenerationRequest& Request);
+
+    /**
+     * Generates the final version of a draft with the model, prompts and seed of the drafted request. Model routing is disabled for it.
+     * @param DraftJobId Job returned by GenerateDraft, it has to be known to the subsystem
+     * @param bUseDraftAsReference Condition the result on the draft with image-to-image, unless the request already has a reference
+     * @param ReferenceStrength Image-to-image strength when using the draft, lower values stay closer to it
+     * @return Identifier of the refinement job, invalid if the draft is unknown or did not complete
+     */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    FGuid RefineDraft(const FGuid& DraftJobId, bool bUseDraftAsReference = true, float ReferenceStrength = 0.3f);
+
+    /**
+     * Builds a texture manifest incrementally: only entries whose inputs changed since their texture was generated
+     * are sent to the API, missing materials are recreated and assets of removed entries are deleted.
+     * @param ManifestFilename JSON file holding a FTextureGenerationManifest
+     * @param bDryRun Only report what would be done
+     * @return The action taken for every entry, followed by the deleted assets. Empty if the manifest could not be loaded.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    TArray<FTextureManifestEntryStatus> BuildManifest(const FString& ManifestFilename, bool bDryRun = false);
+
+    /**
+     * Finds generated textures and texture arrays by their provenance, using only the tags in the asset registry.
+     * Assets generated before provenance was recorded are not found.
+     * @return Matching assets, sorted from newest to oldest
+     */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    TArray<FAssetData> FindGeneratedAssets(const FGeneratedAssetQuery& Query) const;
+
+    /**
+     * Packs existing grayscale maps into the channels of one mask map T_<AssetName>_ORM, replacing its source when it exists.
+     * Missing maps get a neutral value: no occlusion, full roughness and no metal. Maps are resized to the first given one.
+     * @return The packed texture, or nullptr if no map was given or a map could not be read
+     */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    UTexture2D* PackMaskMaps(UTexture2D* Occlusion, UTexture2D* Roughness, UTexture2D* Metallic, const FString& AssetName);
+
+    /**
+     * Imports every image in a folder as texture T_<FileName>, e.g. results of earlier runs or of other tools.
+     * Files are decoded on worker threads while the previous batch is imported within the import budget of each tick,
+     * with the same import settings as generated results. Files named like an existing asset, e.g. a generated T_<Name>,
+     * are skipped with a warning rather than overwriting it, so ingesting a folder again only imports the new files.
+     * Packages are written asynchronously once their texture finished compiling.
+     * @return Number of image files found, 0 if there are none or another ingestion is still running
+     */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    int32 IngestFolder(const FString& Directory, bool bRecursive = true, bool bCreateMaterials = false);
+
+    /** Whether a folder ingestion is still running. */
+    UFUNCTION(BlueprintPure, Category = "Texture Generator")
+    bool IsIngestingFolder() const;
+
+    /**
+     * Generates every combination of the axes of a prompt template, e.g. "{brick|stone|wood} wall, {clean|mossy|burnt}",
+     * times the given style presets. Combinations are expanded one at a time and queued as request slots free up,
+     * so a huge matrix does not create its jobs up front. Assets are named after the options, e.g. <AssetName>_Brick_Mossy.
+     * Queued jobs are journaled, combinations which were not queued yet are not resumed after an editor restart.
+     * @param Request Request shared by every combination, its prompt is the template
+     * @param StylePresets Presets forming one more axis, empty to keep the preset of the request
+     * @param NumSamples Generates only this many combinations, 0 for all of them
+     * @param Sampling How the sample is drawn, the seed of the request makes it reproducible
+     * @return Identifier of the matrix, invalid if the template is malformed
+     */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    FGuid GeneratePromptMatrix(const FTextureGenerationRequest& Request, const TArray<EStylePreset>& StylePresets, int32 NumSamples = 0, EPromptMatrixSampling Sampling = EPromptMatrixSampling::Random);
+
+    /** Whether a prompt matrix still has combinations waiting to be queued. */
+    UFUNCTION(BlueprintPure, Category = "Texture Generator")
+    bool IsPromptMatrixRunning(const FGuid& MatrixId) const;
+
+    /** Stops queuing the combinations of a prompt matrix, jobs already queued from it keep running. Returns false if the matrix is not running. */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    bool CancelPromptMatrix(const FGuid& MatrixId);
+
+    /** Cancels a queued or in-flight job. Returns false if the job is unknown or already finished. */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    bool CancelJob(const FGuid& JobId);
+
+    /** Cancels every queued and in-flight job, and stops every prompt matrix. */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    void CancelAllJobs();
+
+    /** Retrieves the current state of a job. Returns false if the job is unknown. */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    bool GetJobInfo(const FGuid& JobId, FTextureGenerationJobInfo& OutJobInfo) const;
+
+    /** Returns the state of a job, unknown jobs are reported as failed. */
+    UFUNCTION(BlueprintPure, Category = "Texture Generator")
+    ETextureGenerationJobState GetJobState(const FGuid& JobId) const;
+
+    UFUNCTION(BlueprintPure, Category = "Texture Generator")
+    int32 GetNumQueuedJobs() const;
+
+    UFUNCTION(BlueprintPure, Category = "Texture Generator")
+    int32 GetNumInFlightJobs() const;
+
+    /** Returns the latency and error statistics observed for a model endpoint. */
+    UFUNCTION(BlueprintPure, Category = "Texture Generator")
+    FModelEndpointStats GetModelStats(EImageGenerationModel Model) const;
+
+    /**
+     * Summarizes the recorded generation telemetry as a text table of throughput and p50/p95/p99 latency per model.
+     * @param Days How many days back to include
+     * @param bPerDay Whether to break every model down by day as well
+     */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    FString GetTelemetryReport(int32 Days = 30, bool bPerDay = false) const;
+
+    /** Forgets every finished job, so it can no longer be queried. */
+    UFUNCTION(BlueprintCallable, Category = "Texture Generator")
+    void ClearFinishedJobs();
+
+    /** Broadcast once per job when it completes, fails or gets cancelled. */
+    UPROPERTY(BlueprintAssignable, Category = "Texture Generator")
+    FOnTextureGenerationJobFinished OnJobFinished;
+
+    /** Native counterpart of OnJobFinished. */
+    FOnTextureGenerationJobFinishedNative& OnJobFinishedNative() { return JobFinishedNative; }
+
+private:
+    bool Tick(float DeltaTime);
+
+    // Queues a job, only journaled jobs are resumed after a restart
+    FGuid EnqueueJob(const FTextureGenerationRequest& Request, bool bJournal);
+
+    // Starts as many queued jobs as the concurrency limit allows
+    void DispatchPendingJobs();
+    void StartJob(const FGuid& JobId);
+
+    // Builds the request parameters of a job except for the model, for its request and for a duplicate of it
+    bool BuildGenerationParams(FTextureGenerationJobInfo& Job, FStabilityGenerationParams& OutParams, FString& OutError);
+
+    // Synthesizes the result of a job with the local placeholder backend
+    void StartPlaceholderJob(const FGuid& JobId);
+
+    // Picks the model a job is sent to, according to the routing targets
+    EImageGenerationModel RouteJob(const FTextureGenerationRequest& Request) const;
+    void FinishJob(const FGuid& JobId, ETextureGenerationJobState State, const FString& ErrorMessage = FString());
+
+    // API client callbacks
+    void HandleImageGenerated(const TArray<uint8>& ImageData, FGuid JobId);
+    void HandleGenerationError(const FString& ErrorMessage, FGuid JobId);
+
+    // Sends a duplicate of requests slower than the hedge percentile of their model, within the extra request budget
+    void HedgeSlowRequests();
+    void HandleHedgeGenerated(const TArray<uint8>& ImageData, FGuid JobId);
+    void HandleHedgeError(const FString& ErrorMessage, FGuid JobId);
+
+    // Forgets whether a job may be hedged, cancelling its duplicate when one is in flight
+    void ReleaseHedge(const FGuid& JobId);
+
+    // Imports a received image and finishes the job accordingly
+    void CompleteJob(const FGuid& JobId, const TArray<uint8>& ImageData);
+
+    // Re-queues unfinished jobs recorded in the journal by a previous editor session
+    void RecoverJournaledJobs();
+
+    // Imports the results waiting in the result pipeline, within the import budget of the tick
+    void ImportPendingResults();
+
+    // Memory of results held outside the result pipeline: the decoded result, variant sets and tiled textures being assembled
+    int64 GetHeldResultBytes() const;
+
+    // Selects the assets imported since the last sync in the Content Browser, once no more results are waiting
+    void SyncBrowserToImportedAssets();
+
+    // Imports the decoded files of the running folder ingestion, within the import budget of the tick
+    void ImportIngestedFiles();
+    bool ImportIngestedImage(const FString& BaseName, const FImage& Image, bool bCreateMaterial);
+
+    // Reference and mask of an inpainting job as they were when it was sent, its result is blended into this state
+    struct FInpaintSnapshot
+    {
+        FImage Source;
+        FImage Mask;
+        FIntRect Region;
+
+        // Source in its own format when it is not BGRA8 sRGB, edits written back into it keep its precision outside the region
+        FImage OriginalSource;
+    };
+
+    // Loads the reference and mask of an inpainting request and finds the region to regenerate
+    static bool PrepareInpainting(const FTextureGenerationRequest& Request, FInpaintSnapshot& OutSnapshot, FString& OutError);
+
+    // Records what a generated asset was made from as package metadata, which the asset registry indexes as tags.
+    // ResultSeed is the seed the service reported, stored when the request left the seed to it
+    static void StoreProvenance(UObject* Asset, const FTextureGenerationRequest& Request, EImageGenerationModel Model, int64 ResultSeed);
+
+    // Creates the texture and material assets for a finished job
+    bool ImportJobResult(FTextureGenerationJobInfo& Job, const TArray<uint8>& ImageData, FString& OutError);
+    bool ImportJobImage(FTextureGenerationJobInfo& Job, const FImage& Image, FString& OutError);
+
+    // Derives the mask map of a generated texture and, when the request creates materials, its packed material instance.
+    // bOutCreatedParent tells whether the shared parent material was created, it is only saved then
+    static bool ImportMaskMap(const FTextureGenerationRequest& Request, const FString& BaseName, UTexture2D* Texture, const FImage& Image,
+        UTexture2D*& OutMaskMap, UMaterialInstanceConstant*& OutMaterialInstance, bool& bOutCreatedParent, FString& OutError);
+
+    // Stores the result of a variant set job and builds the set once all of its jobs are done
+    void AddVariantResult(const FGuid& JobId, const TArray<uint8>& ImageData);
+    void ReleaseVariant(const FGuid& JobId);
+    void BuildVariantSet(const FGuid& SetId);
+
+    // Splits the global pass of a tiled texture into tile jobs, and blends the tiles once all of them are done
+    void AddTiledResult(const FGuid& JobId, const TArray<uint8>& ImageData);
+    void StartTiles(const FGuid& SetId, const FImage& GlobalImage);
+    void ReleaseTiledJob(const FGuid& JobId);
+    void BuildTiledTexture(const FGuid& SetId);
+
+    // Queues combinations of running prompt matrices while the queue runs short
+    void FeedPromptMatrices();
+
+    // Saves imported assets whose textures finished compiling, or all of them when forced
+    void SaveCompiledResults(bool bForce);
+
+    // Appends a finished job to the telemetry history
+    void RecordTelemetry(const FGuid& JobId);
+
+    UPROPERTY()
+    TMap<FGuid, FTextureGenerationJobInfo> Jobs;
+
+    // Jobs waiting for a free request slot, in submission order
+    TQueue<FGuid> PendingJobs;
+    int32 NumQueuedJobs = 0;
+
+    // One API client per in-flight job
+    TMap<FGuid, TSharedPtr<FStabilityAPIClient>> ActiveClients;
+
+    // Placeholders being synthesized, they take a request slot like the jobs waiting for the API
+    int32 NumActivePlaceholderJobs = 0;
+
+    // Clients of finished jobs, released on the next tick since they may still be on the callstack
+    TArray<TSharedPtr<FStabilityAPIClient>> RetiredClients;
+
+    // In-flight requests which may still be hedged, the duplicate is built from the job when it is sent
+    TSet<FGuid> HedgeableRequests;
+
+    // Duplicates in flight, by the job they were sent for
+    struct FHedgedRequest
+    {
+        TSharedPtr<FStabilityAPIClient> Client;
+        EImageGenerationModel Model = EImageGenerationModel::StableImageCore;
+        double DispatchTime = 0.0;
+    };
+    TMap<FGuid, FHedgedRequest> HedgedRequests;
+
+    // Requests which could have been hedged and duplicates sent, the ratio is held under the extra request budget
+    int32 NumHedgeableRequests = 0;
+    int32 NumHedgeRequests = 0;
+
+    // Received images waiting to be imported
+    TSharedPtr<FGenerationResultPipeline> ResultPipeline;
+
+    // Imported assets waiting for their texture to finish compiling before they are saved
+    struct FPendingSave
+    {
+        TArray<FGuid> JobIds;
+        TWeakObjectPtr<UTexture> Texture;
+        TArray<TWeakObjectPtr<UPackage>> Packages;
+
+        // Written in the background instead of through the editor's save, for bulk ingestion
+        bool bWriteAsync = false;
+    };
+    TArray<FPendingSave> PendingSaves;
+
+    // Imported assets waiting for the rest of their batch before they are shown in the Content Browser
+    TArray<TWeakObjectPtr<UObject>> BrowserSyncObjects;
+
+    // Variants waiting for the rest of their set before they are packed into a texture array
+    struct FVariantSet
+    {
+        FTextureGenerationRequest Request;
+        TArray<FGuid> JobIds;
+
+        // Compressed results by variant index, empty for failed variants, decoded once the set is built
+        TArray<TArray<uint8>> Results;
+        int32 NumPending = 0;
+    };
+    TMap<FGuid, FVariantSet> VariantSets;
+    TMap<FGuid, FGuid> VariantSetJobs;
+
+    // Tiled textures waiting for their global pass or tiles
+    struct FTiledSet
+    {
+        FTextureGenerationRequest Request;
+        FGuid GlobalJobId;
+        int32 OutputSize = 0;
+        int32 TileSize = 0;
+        int32 Overlap = 0;
+        float TileStrength = 0.0f;
+
+        // Global pass scaled to the output size, shows through where tiles failed
+        FImage Canvas;
+        TArray<FIntRect> Tiles;
+        TArray<FGuid> TileJobIds;
+
+        // Decoded tiles by tile index, empty for failed tiles
+        TArray<FImage> TileImages;
+        int32 NumPending = 0;
+    };
+    TMap<FGuid, FTiledSet> TiledSets;
+    TMap<FGuid, FGuid> TiledSetJobs;
+
+    // Inpainting state captured when a job is started, until its result is imported
+    TMap<FGuid, FInpaintSnapshot> InpaintSnapshots;
+
+    // Requests of draft jobs as they are refined, with the model and seed of the final version
+    TMap<FGuid, FTextureGenerationRequest> DraftRequests;
+
+    // Folder being ingested, null when none is running
+    TSharedPtr<FFolderIngestion> FolderIngestion;
+
+    // Prompt matrices with combinations left to queue, fed in the order they were started
+    struct FRunningPromptMatrix
+    {
+        FGuid MatrixId;
+        TSharedPtr<FPromptMatrix> Matrix;
+    };
+    TArray<FRunningPromptMatrix> PromptMatrices;
+
+    // Pushes the platform data of imported textures to the shared derived data cache
+    TSharedPtr<FTextureDDCPublisher> DDCPublisher;
+
+    // Persistent job record, null when resuming interrupted jobs is disabled
+    TSharedPtr<FTextureGenerationJournal> Journal;
+
+    // History of finished jobs, null when recording telemetry is disabled
+    TSharedPtr<FGenerationTelemetry> Telemetry;
+
+    // Set while shutting down, jobs cancelled by the shutdown are resumed on the next start
+    bool bIsShuttingDown = false;
+
+    // Live latency and error statistics per model
+    FModelRoutingPolicy RoutingPolicy;
+
+    // Last decoded result and the response it came from, coalesced jobs receive the same response and only decode it once
+    FImage DecodedResult;
+    FGuid DecodedResultId;
+
+    FOnTextureGenerationJobFinishedNative JobFinishedNative;
+    FTSTicker::FDelegateHandle TickHandle;
+};
@@ -23,4 +23,5 @@ public:
 
 public:
     TSharedPtr<FUICommandInfo> OpenPluginWindow;
+    TSharedPtr<FUICommandInfo> OpenMemoryReport;
 };
@@ -19,10 +19,14 @@ public:
     
     /** This function will be bound to the Command. */
     void PluginButtonClicked();
+
+    /** Opens the memory report of the generated textures. */
+    void MemoryReportClicked();
     
 private:
     void RegisterMenus();
     TSharedRef<class SDockTab> OnSpawnPluginTab(const class FSpawnTabArgs& SpawnTabArgs);
+    TSharedRef<class SDockTab> OnSpawnMemoryReportTab(const class FSpawnTabArgs& SpawnTabArgs);
     
 private:
     TSharedPtr<class FUICommandList> PluginCommands;
@@ -16,4 +16,76 @@ public:
 	/* Default path where the generated assets are going to be saved. Use a trailing slash at the end of the path. */
 	UPROPERTY(Config, EditAnywhere, Category = "Paths", Meta = (DisplayName="Default Asset Path"))
 	FString DefaultAssetPath = TEXT("/Game/StabilityAI/");
+
+	/* Maximum number of generation requests sent to the API at the same time. Remaining jobs wait in a queue. */
+	UPROPERTY(Config, EditAnywhere, Category = "Generation", Meta = (DisplayName="Max Concurrent Requests", ClampMin = 1, ClampMax = 64))
+	int32 MaxConcurrentRequests = 4;
+
+	/* Journal generation jobs to disk, so a batch interrupted by closing or crashing the editor resumes on the next start. Results received before the interruption are imported without being generated again. */
+	UPROPERTY(Config, EditAnywhere, Category = "Generation", Meta = (DisplayName="Resume Interrupted Jobs"))
+	bool bResumeInterruptedJobs = true;
+
+	/* Append the timings, sizes and outcome of every finished job to the history under Saved/TextureGenerator/Telemetry, which the TextureGeneratorTelemetryReport commandlet summarizes. */
+	UPROPERTY(Config, EditAnywhere, Category = "Generation", Meta = (DisplayName="Record Telemetry"))
+	bool bRecordTelemetry = true;
+
+	/* Memory received images may use while waiting to be imported. Decoded images and variant or tiled sets being assembled count against it as well. Further results are spilled to disk in their compressed form. Folder ingestion keeps its decoded files within the same amount. */
+	UPROPERTY(Config, EditAnywhere, Category = "Generation", Meta = (DisplayName="Result Memory Budget (MB)", ClampMin = 0))
+	int32 ResultMemoryBudgetMB = 256;
+
+	/* Disk space spilled results may use. Once exceeded, no new requests are sent until the importer catches up. */
+	UPROPERTY(Config, EditAnywhere, Category = "Generation", Meta = (DisplayName="Result Spill Budget (MB)", ClampMin = 0))
+	int32 ResultSpillBudgetMB = 4096;
+
+	/* Import results at least as large as the Virtual Texture Size Threshold as streaming virtual textures, sampled as virtual textures by the generated material. Large results are imported as regular streaming textures with mips when virtual texturing is disabled in the project. */
+	UPROPERTY(Config, EditAnywhere, Category = "Import", Meta = (DisplayName="Import Large Results As Virtual Textures"))
+	bool bImportLargeResultsAsVirtualTextures = true;
+
+	/* Width or height from which a result counts as large. Smaller results stay fully resident without mips. */
+	UPROPERTY(Config, EditAnywhere, Category = "Import", Meta = (DisplayName="Virtual Texture Size Threshold", ClampMin = 512))
+	int32 VirtualTextureSizeThreshold = 4096;
+
+	/* Game thread time spent importing received results per editor tick. At least one result is imported every tick, so large batches keep the editor responsive instead of stalling it until all of them are imported. */
+	UPROPERTY(Config, EditAnywhere, Category = "Import", Meta = (DisplayName="Import Budget Per Tick (ms)", ClampMin = 1, Units = "ms"))
+	float ImportBudgetMilliseconds = 8.0f;
+
+	/* Build the compressed platform data of generated textures right after import, so it gets stored in the shared derived data cache and teammates do not compress the textures again. */
+	UPROPERTY(Config, EditAnywhere, Category = "Derived Data", Meta = (DisplayName="Publish To Shared DDC"))
+	bool bPublishToSharedDDC = true;
+
+	/* Target platforms to build the platform data for, e.g. Windows. The active target platforms are used when empty. */
+	UPROPERTY(Config, EditAnywhere, Category = "Derived Data", Meta = (DisplayName="DDC Target Platforms", EditCondition = "bPublishToSharedDDC"))
+	TArray<FString> DDCTargetPlatforms;
+
+	/* Latency each routed request should stay under. Jobs allowing model routing are sent to a faster model when the requested one is observed to be slower than this. 0 disables the target. */
+	UPROPERTY(Config, EditAnywhere, Category = "Routing", Meta = (DisplayName="Target Latency (s)", ClampMin = 0, Units = "s"))
+	float TargetLatencySeconds = 0.0f;
+
+	/* Number of routed images per minute a batch should reach. Turned into a latency target using Max Concurrent Requests. 0 disables the target. */
+	UPROPERTY(Config, EditAnywhere, Category = "Routing", Meta = (DisplayName="Target Throughput (images/min)", ClampMin = 0))
+	float TargetThroughputPerMinute = 0.0f;
+
+	/* Share of failing requests above which routed jobs avoid a model. */
+	UPROPERTY(Config, EditAnywhere, Category = "Routing", Meta = (DisplayName="Max Model Error Rate", ClampMin = 0, ClampMax = 1))
+	float MaxModelErrorRate = 0.5f;
+
+	/* Sends a duplicate of requests taking longer than most requests to the same model, and keeps whichever response arrives first. Trades a few extra requests for a shorter latency tail. */
+	UPROPERTY(Config, EditAnywhere, Category = "Hedging", Meta = (DisplayName="Hedge Slow Requests"))
+	bool bHedgeSlowRequests = false;
+
+	/* Share of recent requests to a model finishing before a duplicate is sent, e.g. 0.95 hedges requests which are slower than the model's p95 latency. */
+	UPROPERTY(Config, EditAnywhere, Category = "Hedging", Meta = (DisplayName="Hedge Latency Percentile", ClampMin = 0.5, ClampMax = 0.999, EditCondition = "bHedgeSlowRequests"))
+	float HedgeLatencyPercentile = 0.95f;
+
+	/* Duplicates are never sent before this delay, so fast models are not hedged on mere jitter. */
+	UPROPERTY(Config, EditAnywhere, Category = "Hedging", Meta = (DisplayName="Min Hedge Delay (s)", ClampMin = 0, Units = "s", EditCondition = "bHedgeSlowRequests"))
+	float MinHedgeDelaySeconds = 5.0f;
+
+	/* Extra requests allowed as a share of the requests sent, e.g. 0.1 spends at most 10% more on duplicates. */
+	UPROPERTY(Config, EditAnywhere, Category = "Hedging", Meta = (DisplayName="Max Extra Request Share", ClampMin = 0, ClampMax = 1, EditCondition = "bHedgeSlowRequests"))
+	float MaxHedgeRequestShare = 0.1f;
+
+	/* Sends the duplicate of a job allowing model routing to the next faster model instead of the same one. */
+	UPROPERTY(Config, EditAnywhere, Category = "Hedging", Meta = (DisplayName="Hedge With Faster Model", EditCondition = "bHedgeSlowRequests"))
+	bool bHedgeWithFasterModel = false;
 };
\ No newline at end of file
@@ -0,0 +1,59 @@
+// Copyright Mateusz Wojt. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Pixel format conversion kernels for interleaved 4 channel images, alpha being the fourth channel,
+ * and the noise the placeholder textures are synthesized from.
+ * Every kernel has a vector path (AVX2 or SSE2 on x86, NEON on ARM, picked at compile time)
+ * and a scalar reference in FPixelKernels::FScalar, which the vector paths match bit for bit.
+ */
+class TEXTUREGENERATOR_API FPixelKernels
+{
+public:
+    /** Swaps the first and third channel, converting RGBA8 to BGRA8 and back. Source and destination may be the same. */
+    static void SwizzleRedBlue(const uint8* Src, uint8* Dst, int64 NumPixels);
+
+    /** Converts sRGB encoded 8 bit pixels to linear floats, alpha is converted linearly. */
+    static void SRGBToLinear(const uint8* Src, float* Dst, int64 NumPixels);
+
+    /** Converts linear float pixels to sRGB encoded 8 bit pixels, alpha is converted linearly. Values are clamped to [0, 1]. */
+    static void LinearToSRGB(const float* Src, uint8* Dst, int64 NumPixels);
+
+    /** Widens 8 bit values to 16 bit, mapping 255 to 65535. */
+    static void Expand8To16(const uint8* Src, uint16* Dst, int64 NumValues);
+
+    /** Converts 8 bit values to floats in [0, 1]. */
+    static void ConvertToFloat(const uint8* Src, float* Dst, int64 NumValues);
+
+    /** Multiplies the color channels by alpha, rounding to nearest. */
+    static void PremultiplyAlpha(uint8* Pixels, int64 NumPixels);
+
+    /** Divides the color channels by alpha, rounding to nearest. Pixels with zero alpha become black. */
+    static void UnpremultiplyAlpha(uint8* Pixels, int64 NumPixels);
+
+    /**
+     * Periodic fractal gradient noise in [0, 1] at the pixel centers of one row of a square image, used to synthesize placeholders.
+     * The first octave repeats every BasePeriod lattice cells across the image, each further octave doubles the frequency,
+     * so the noise tiles seamlessly. Every pixel of the row is independent, the vector paths shade several at once.
+     */
+    static void FractalNoiseRow(int32 Row, int32 Size, int32 BasePeriod, int32 NumOctaves, uint32 Seed, float* Dst);
+
+    /** Name of the instruction set used by the vector paths, "Scalar" when there is none. */
+    static const TCHAR* GetVectorPathName();
+
+    /** Scalar reference implementations */
+    struct TEXTUREGENERATOR_API FScalar
+    {
+        static void SwizzleRedBlue(const uint8* Src, uint8* Dst, int64 NumPixels);
+        static void SRGBToLinear(const uint8* Src, float* Dst, int64 NumPixels);
+        static void LinearToSRGB(const float* Src, uint8* Dst, int64 NumPixels);
+        static void Expand8To16(const uint8* Src, uint16* Dst, int64 NumValues);
+        static void ConvertToFloat(const uint8* Src, float* Dst, int64 NumValues);
+        static void PremultiplyAlpha(uint8* Pixels, int64 NumPixels);
+        static void UnpremultiplyAlpha(uint8* Pixels, int64 NumPixels);
+        static void FractalNoiseRow(int32 Row, int32 Size, int32 BasePeriod, int32 NumOctaves, uint32 Seed, float* Dst);
+    };
+};
@@ -4,7 +4,48 @@
 
 #include "CoreMinimal.h"
 #include "Engine/Texture2D.h"
+#include "Engine/Texture2DArray.h"
 #include "Materials/Material.h"
+#include "ImageCore.h"
+
+class UMaterialInstanceConstant;
+struct FAssetData;
+
+/**
+ * Package metadata keys written on generated assets
+ */
+namespace TextureGeneratorMetaData
+{
+    /** Input fingerprint of the request the texture was generated from */
+    inline const TCHAR* Fingerprint = TEXT("TextureGenerator.Fingerprint");
+
+    /** Manifest the texture was generated from */
+    inline const TCHAR* Manifest = TEXT("TextureGenerator.Manifest");
+
+    /** Prompt of the request, present on every generated asset */
+    inline const TCHAR* Prompt = TEXT("TextureGenerator.Prompt");
+
+    /** Negative prompt of the request */
+    inline const TCHAR* NegativePrompt = TEXT("TextureGenerator.NegativePrompt");
+
+    /** Model which produced the image */
+    inline const TCHAR* Model = TEXT("TextureGenerator.Model");
+
+    /** Seed of the request, or the seed the service reported back when the request left it to the service, 0 when it reported none */
+    inline const TCHAR* Seed = TEXT("TextureGenerator.Seed");
+
+    /** Style preset of the request */
+    inline const TCHAR* Style = TEXT("TextureGenerator.Style");
+
+    /** Reference strength, only written for image to image requests */
+    inline const TCHAR* Strength = TEXT("TextureGenerator.Strength");
+
+    /** UTC time of the import as ISO 8601 */
+    inline const TCHAR* Created = TEXT("TextureGenerator.Created");
+
+    /** Metallic value a mask map was derived with, only written on mask maps */
+    inline const TCHAR* Metallic = TEXT("TextureGenerator.Metallic");
+}
 
 /**
  * Utility class for texture and material creation
@@ -20,6 +61,77 @@ public:
      * @return The created texture, or nullptr if creation failed
      */
     static UTexture2D* CreateTextureFromImageData(const TArray<uint8>& ImageData, const FString& BaseName, FString& OutPackageName);
+
+    /**
+     * Decodes compressed image data into a BGRA8 image
+     * @param ImageData The compressed image data
+     * @param OutImage The decoded image
+     * @return Whether the image data could be decoded
+     */
+    static bool DecodeImageData(const TArray<uint8>& ImageData, FImage& OutImage);
+
+    /**
+     * Creates a new texture from a decoded BGRA8 image
+     * The texture is compiled asynchronously when the editor allows it, check IsCompiling() before relying on its platform data.
+     * Images reaching the virtual texture size threshold are imported as streaming, possibly virtual, textures with mips.
+     * @param Image The decoded image
+     * @param BaseName Base name for the new texture
+     * @param OutPackageName Output parameter for the created package name
+     * @return The created texture, or nullptr if creation failed
+     */
+    static UTexture2D* CreateTextureFromImage(const FImage& Image, const FString& BaseName, FString& OutPackageName);
+
+    /**
+     * Creates a new mask texture T_<BaseName>_ORM from a packed occlusion/roughness/metallic BGRA8 image.
+     * Mask maps use linear mask compression, otherwise the same import rules as CreateTextureFromImage apply.
+     * @param Image The packed image
+     * @param BaseName Base name for the new texture
+     * @param OutPackageName Output parameter for the created package name
+     * @return The created texture, or nullptr if creation failed
+     */
+    static UTexture2D* CreateMaskTextureFromImage(const FImage& Image, const FString& BaseName, FString& OutPackageName);
+
+    /**
+     * Replaces the source of an existing texture with a decoded image in any texture source format, keeping its references
+     * @param Texture The texture to update
+     * @param Image The decoded image
+     * @param bApplySizeSettings Whether to reapply the streaming, mip and virtual texture settings of generated results for the new size,
+     *        false keeps the settings of the texture, e.g. for user textures edited by inpainting
+     * @return Whether the texture was updated
+     */
+    static bool UpdateTextureFromImage(UTexture2D* Texture, const FImage& Image, bool bApplySizeSettings = true);
+
+    /** Whether the project has virtual texture support enabled (r.VirtualTextures). */
+    static bool IsVirtualTexturingEnabled();
+
+    /**
+     * Loads an asset from the default asset path
+     * @param AssetName Name of the asset, including its prefix
+     * @return The asset, or nullptr if it does not exist
+     */
+    static UObject* FindGeneratedAsset(const FString& AssetName);
+
+    /** Whether an asset exists in the default asset path, without loading it */
+    static bool DoesGeneratedAssetExist(const FString& AssetName);
+
+    /** Stores a value in the package metadata of a generated asset. */
+    static void SetGeneratorMetaData(UObject* Object, const TCHAR* Key, const FString& Value);
+
+    /** Reads a value from the package metadata of a generated asset, empty when not set. */
+    static FString GetGeneratorMetaData(const UObject* Object, const TCHAR* Key);
+
+    /**
+     * Reads a generator metadata value from the asset registry tags of an asset, without loading it.
+     * Assets saved before the keys were exposed to the asset registry have no tags, use GetGeneratorMetaData for those.
+     * @return Whether the tag exists
+     */
+    static bool GetGeneratorTag(const FAssetData& Asset, const TCHAR* Key, FString& OutValue);
+
+    /** Exposes the generator metadata keys as asset registry tags, so they can be searched without loading packages. */
+    static void RegisterMetaDataTags();
+
+    /** Removes the generator metadata keys from the asset registry tags. */
+    static void UnregisterMetaDataTags();
     
     /**
      * Creates a new material with the given texture as the base color
@@ -30,6 +142,47 @@ public:
      */
     static UMaterial* CreateMaterialForTexture(UTexture2D* Texture, const FString& BaseName, FString& OutPackageName);
 
+    /**
+     * Creates a new texture array with one slice per image
+     * @param Images Decoded BGRA8 images, all of the same size
+     * @param BaseName Base name for the new texture array
+     * @param OutPackageName Output parameter for the created package name
+     * @return The created texture array, or nullptr if creation failed
+     */
+    static UTexture2DArray* CreateTextureArrayFromImages(const TArray<FImage>& Images, const FString& BaseName, FString& OutPackageName);
+
+    /**
+     * Creates a new material sampling one slice of a texture array as the base color.
+     * The slice comes from the first per-instance custom data float, falling back to the VariantIndex scalar parameter.
+     * @param TextureArray The texture array to sample
+     * @param BaseName Base name for the new material
+     * @param OutPackageName Output parameter for the created package name
+     * @return The created material, or nullptr if creation failed
+     */
+    static UMaterial* CreateMaterialForTextureArray(UTexture2DArray* TextureArray, const FString& BaseName, FString& OutPackageName);
+
+    /**
+     * Creates a new material instance of the given material
+     * @param Parent The material to instance
+     * @param BaseName Base name for the new material instance
+     * @param OutPackageName Output parameter for the created package name
+     * @return The created material instance, or nullptr if creation failed
+     */
+    static UMaterialInstanceConstant* CreateMaterialInstance(UMaterial* Parent, const FString& BaseName, FString& OutPackageName);
+
+    /**
+     * Creates or updates the material instance MI_<BaseName> of a shared material sampling a base color and a packed mask map,
+     * whose red, green and blue channels drive ambient occlusion, roughness and metallic.
+     * The shared material is created on first use, one variant for regular and one for virtual textures.
+     * @param BaseColor The base color texture
+     * @param MaskMap The packed mask map, streamed the same way as the base color
+     * @param BaseName Base name for the material instance
+     * @param OutPackageName Output parameter for the package name of the material instance
+     * @param bOutCreatedParent Whether the shared material was created by this call and needs saving
+     * @return The material instance, or nullptr if creation failed
+     */
+    static UMaterialInstanceConstant* CreatePackedMaterialInstance(UTexture2D* BaseColor, UTexture2D* MaskMap, const FString& BaseName, FString& OutPackageName, bool& bOutCreatedParent);
+
     /**
     * Extracts UTexture raw image data into PNG compressed binary representation.
     * @param Texture The texture to extract raw image data from.
@@ -14,10 +14,13 @@
 #include "Widgets/Notifications/SProgressBar.h"
 #include "AssetRegistry/AssetData.h"
 #include "API/StabilityAPIClient.h"
+#include "Subsystems/TextureGenerationTypes.h"
+#include "Containers/Ticker.h"
 
 
 class FAssetThumbnailPool;
 class SAssetDropTarget;
+class SNotificationItem;
 
 /**
  * Main widget for the Texture Generator
@@ -28,6 +31,8 @@ public:
     SLATE_BEGIN_ARGS(STextureGeneratorWidget) {}
     SLATE_END_ARGS()
 
+    virtual ~STextureGeneratorWidget() override;
+
     void Construct(const FArguments& InArgs);
 
 private:
@@ -60,6 +65,9 @@ private:
     // Reference texture asset handle
     TWeakObjectPtr<UTexture2D> SelectedReferenceTexture;
 
+    // Mask of the reference region to regenerate
+    TWeakObjectPtr<UTexture2D> SelectedMaskTexture;
+
     // UI Generation
     TSharedRef<SWidget> CreateHeader();
     TSharedRef<SWidget> CreatePromptSection();
@@ -77,22 +85,34 @@ private:
     TSharedRef<SWidget> MakeStyleComboWidget(TSharedPtr<EStylePreset> InOption);
     FText GetStyleComboText() const;
     FText GetStyleDisplayName(EStylePreset Style) const;
-    FString GetStyleAPIString(EStylePreset Style) const;
     void OnStyleSelectionChanged(TSharedPtr<EStylePreset> NewSelection, ESelectInfo::Type SelectInfo);
     
     // Reference image handlers
     void OnReferenceTextureChanged(const FAssetData& AssetData);
+    void OnMaskTextureChanged(const FAssetData& AssetData);
 
 protected:
-    // Stability AI API Client
-    TUniquePtr<FStabilityAPIClient> Client;
+    // Generation job currently tracked by the widget
+    FGuid ActiveJobId;
+    bool bActiveJobIsDraft = false;
+
+    // Last completed draft, which the Refine button generates with the selected model
+    FGuid DraftJobId;
     
     // Event Handlers
     FReply OnGenerateClicked();
+    FReply OnDraftClicked();
+    FReply OnRefineClicked();
     FReply OnCancelClicked();
+
+    // Builds a request from the current inputs, reports an error when they are incomplete
+    bool MakeRequest(FTextureGenerationRequest& OutRequest);
+
+    // Shows the progress of a submitted job until it finishes
+    void TrackJob(const FGuid& JobId, bool bIsDraft);
     
-    // API Callbacks
-    void OnImageGenerated(const TArray<uint8>& ImageData);
+    // Generation callbacks
+    void OnJobFinished(const FTextureGenerationJobInfo& JobInfo);
     void OnGenerationError(const FString& ErrorMessage);
 
     float Strength = 0.5f;
@@ -109,4 +129,13 @@ private:
     void StartProgressSimulation();
     void StopProgressSimulation();
     void UpdateProgressSimulation();
+
+    // Keeps the completion notification up to date while the generated texture compiles
+    bool TickCompileNotification(float DeltaTime);
+    void FinishCompileNotification();
+    FText GetCompileNotificationText() const;
+
+    TSharedPtr<SNotificationItem> CompileNotification;
+    TWeakObjectPtr<UTexture2D> CompilingTexture;
+    FTSTicker::FDelegateHandle CompileTickHandle;
 };
@@ -14,6 +14,7 @@ public class TextureGenerator : ModuleRules
                 "Engine",
                 "InputCore",
                 "UnrealEd",
+                "EditorSubsystem",
                 "LevelEditor",
                 "Slate",
                 "SlateCore",
@@ -46,7 +47,10 @@ public class TextureGenerator : ModuleRules
                 "EditorFramework",
                 "ToolMenus",
                 "ContentBrowser",
-                "MainFrame"
+                "ContentBrowserData",
+                "MainFrame",
+                "TargetPlatform",
+                "DerivedDataCache"
             }
             );
     }